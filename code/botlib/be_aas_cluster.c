@@ -1497,6 +1497,7 @@ void AAS_InitClustering(void)
 	botimport.Print(PRT_MESSAGE, "\r%6d removed portal areas", removedPortalAreas);
 	while(1)
 	{
+		AAS_InitYield();
 		botimport.Print(PRT_MESSAGE, "\r%6d", removedPortalAreas);
 		//initialize the number of portals and clusters
 		aasworld.numportals = 1;		//portal 0 is a dummy
@@ -140,10 +140,22 @@ typedef struct aas_settings_s
 #define CACHETYPE_PORTAL		0
 #define CACHETYPE_AREA			1
 
+//bsp tree node with its plane folded in, 32 bytes so nodes never straddle a cache line
+typedef struct aas_flatnode_s
+{
+	vec3_t normal;								//normal of the node plane
+	float dist;									//distance of the node plane
+	int children[2];							//child nodes, negative are areas, zero is solid
+	int planenum;								//plane number of the node
+	int pad;
+} aas_flatnode_t;
+
 //routing cache
 typedef struct aas_routingcache_s
 {
 	byte type;									//portal or area cache
+	byte referenced;							//CLOCK reference bit, set on access
+	unsigned short serial;						//route query that last used the cache
 	float time;									//last time accessed or updated
 	int size;									//size of the routing cache
 	int cluster;								//cluster the cache is for
@@ -203,6 +215,9 @@ typedef struct aas_s
 	//name of the aas file
 	char filename[MAX_PATH];
 	char mapname[MAX_PATH];
+	//read-only mapping of the aas file the static lumps point into
+	char *shared;
+	int sharedlength;
 	//bounding boxes
 	int numbboxes;
 	aas_bbox_t *bboxes;
@@ -236,6 +251,9 @@ typedef struct aas_s
 	//nodes of the bsp tree
 	int numnodes;
 	aas_node_t *nodes;
+	//the nodes with their planes in one aligned array for tree walks
+	aas_flatnode_t *flatnodes;
+	void *flatnodesmemory;
 	//cluster portals
 	int numportals;
 	aas_portal_t *portals;
@@ -276,9 +294,10 @@ typedef struct aas_s
 	//array of size numclusters with cluster cache
 	aas_routingcache_t ***clusterareacache;
 	aas_routingcache_t **portalcache;
-	//cache list sorted on time
-	aas_routingcache_t *oldestcache;		// start of cache list sorted on time
-	aas_routingcache_t *newestcache;		// end of cache list sorted on time
+	//cache list in allocation order, swept by the CLOCK hand
+	aas_routingcache_t *oldestcache;		// start of cache list
+	aas_routingcache_t *newestcache;		// end of cache list
+	aas_routingcache_t *cachehand;			// CLOCK hand into the cache list
 	//maximum travel time through portal areas
 	int *portalmaxtraveltimes;
 	//areas the reachabilities go through
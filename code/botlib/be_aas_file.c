@@ -54,6 +54,8 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 void AAS_SwapAASData(void)
 {
 	int i, j;
+	//shared data is only mapped on little endian hosts, nothing to swap
+	if (aasworld.shared) return;
 	//bounding boxes
 	for (i = 0; i < aasworld.numbboxes; i++)
 	{
@@ -174,6 +176,20 @@ void AAS_SwapAASData(void)
 	} //end for
 } //end of the function AAS_SwapAASData
 //===========================================================================
+// lumps pointing into the shared mapping are not ours to free
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+static void AAS_FreeAASLump(void *ptr)
+{
+	if (!ptr) return;
+	if (aasworld.shared && (char *) ptr >= aasworld.shared &&
+			(char *) ptr < aasworld.shared + aasworld.sharedlength) return;
+	FreeMemory(ptr);
+} //end of the function AAS_FreeAASLump
+//===========================================================================
 // dump the current loaded aas file
 //
 // Parameter:				-
@@ -183,49 +199,57 @@ void AAS_SwapAASData(void)
 void AAS_DumpAASData(void)
 {
 	aasworld.numbboxes = 0;
-	if (aasworld.bboxes) FreeMemory(aasworld.bboxes);
+	AAS_FreeAASLump(aasworld.bboxes);
 	aasworld.bboxes = NULL;
 	aasworld.numvertexes = 0;
-	if (aasworld.vertexes) FreeMemory(aasworld.vertexes);
+	AAS_FreeAASLump(aasworld.vertexes);
 	aasworld.vertexes = NULL;
 	aasworld.numplanes = 0;
-	if (aasworld.planes) FreeMemory(aasworld.planes);
+	AAS_FreeAASLump(aasworld.planes);
 	aasworld.planes = NULL;
 	aasworld.numedges = 0;
-	if (aasworld.edges) FreeMemory(aasworld.edges);
+	AAS_FreeAASLump(aasworld.edges);
 	aasworld.edges = NULL;
 	aasworld.edgeindexsize = 0;
-	if (aasworld.edgeindex) FreeMemory(aasworld.edgeindex);
+	AAS_FreeAASLump(aasworld.edgeindex);
 	aasworld.edgeindex = NULL;
 	aasworld.numfaces = 0;
-	if (aasworld.faces) FreeMemory(aasworld.faces);
+	AAS_FreeAASLump(aasworld.faces);
 	aasworld.faces = NULL;
 	aasworld.faceindexsize = 0;
-	if (aasworld.faceindex) FreeMemory(aasworld.faceindex);
+	AAS_FreeAASLump(aasworld.faceindex);
 	aasworld.faceindex = NULL;
 	aasworld.numareas = 0;
-	if (aasworld.areas) FreeMemory(aasworld.areas);
+	AAS_FreeAASLump(aasworld.areas);
 	aasworld.areas = NULL;
 	aasworld.numareasettings = 0;
-	if (aasworld.areasettings) FreeMemory(aasworld.areasettings);
+	AAS_FreeAASLump(aasworld.areasettings);
 	aasworld.areasettings = NULL;
 	aasworld.reachabilitysize = 0;
-	if (aasworld.reachability) FreeMemory(aasworld.reachability);
+	AAS_FreeAASLump(aasworld.reachability);
 	aasworld.reachability = NULL;
 	aasworld.numnodes = 0;
-	if (aasworld.nodes) FreeMemory(aasworld.nodes);
+	AAS_FreeAASLump(aasworld.nodes);
 	aasworld.nodes = NULL;
+	AAS_FreeFlatNodes();
 	aasworld.numportals = 0;
-	if (aasworld.portals) FreeMemory(aasworld.portals);
+	AAS_FreeAASLump(aasworld.portals);
 	aasworld.portals = NULL;
 	aasworld.numportals = 0;
-	if (aasworld.portalindex) FreeMemory(aasworld.portalindex);
+	AAS_FreeAASLump(aasworld.portalindex);
 	aasworld.portalindex = NULL;
 	aasworld.portalindexsize = 0;
-	if (aasworld.clusters) FreeMemory(aasworld.clusters);
+	AAS_FreeAASLump(aasworld.clusters);
 	aasworld.clusters = NULL;
 	aasworld.numclusters = 0;
 	//
+	if (aasworld.shared)
+	{
+		botimport.FS_UnmapShared(aasworld.shared, aasworld.sharedlength);
+		aasworld.shared = NULL;
+		aasworld.sharedlength = 0;
+	} //end if
+	//
 	aasworld.loaded = qfalse;
 	aasworld.initialized = qfalse;
 	aasworld.savefile = qfalse;
@@ -319,6 +343,37 @@ char *AAS_LoadAASLump(fileHandle_t fp, int offset, int length, int *lastoffset,
 	return buf;
 } //end of the function AAS_LoadAASLump
 //===========================================================================
+// lumps that are never written at run time stay in the shared mapping,
+// the rest get a private copy
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+static char *AAS_GetAASLump(fileHandle_t fp, int offset, int length, int *lastoffset, int size, qboolean readonly)
+{
+	char *buf;
+
+	if (!aasworld.shared || !length)
+	{
+		return AAS_LoadAASLump(fp, offset, length, lastoffset, size);
+	} //end if
+	if (offset < 0 || length < 0 || offset + length > aasworld.sharedlength)
+	{
+		AAS_Error("aas lump outside the file\n");
+		AAS_DumpAASData();
+		botimport.FS_FCloseFile(fp);
+		return NULL;
+	} //end if
+	if (readonly)
+	{
+		return aasworld.shared + offset;
+	} //end if
+	buf = (char *) GetClearedHunkMemory(length+1);
+	Com_Memcpy(buf, aasworld.shared + offset, length);
+	return buf;
+} //end of the function AAS_GetAASLump
+//===========================================================================
 //
 // Parameter:			-
 // Returns:				-
@@ -389,93 +444,105 @@ int AAS_LoadAASFile(char *filename)
 		botimport.FS_FCloseFile(fp);
 		return BLERR_WRONGAASFILEVERSION;
 	} //end if
+#ifdef Q3_LITTLE_ENDIAN
+	//servers sharing a cache map one copy of the static lumps, unless
+	//the data is going to be rebuilt
+	if (botimport.FS_MapShared &&
+			!LibVarGetValue("forcewrite") && !LibVarGetValue("forceclustering") &&
+			!LibVarGetValue("forcereachability") && !LibVarGetValue("aasoptimize"))
+	{
+		aasworld.shared = (char *) botimport.FS_MapShared(filename, &aasworld.sharedlength);
+	} //end if
+#endif //Q3_LITTLE_ENDIAN
 	//load the lumps:
 	//bounding boxes
 	offset = LittleLong(header.lumps[AASLUMP_BBOXES].fileofs);
 	length = LittleLong(header.lumps[AASLUMP_BBOXES].filelen);
-	aasworld.bboxes = (aas_bbox_t *) AAS_LoadAASLump(fp, offset, length, &lastoffset, sizeof(aas_bbox_t));
+	aasworld.bboxes = (aas_bbox_t *) AAS_GetAASLump(fp, offset, length, &lastoffset, sizeof(aas_bbox_t), qtrue);
 	aasworld.numbboxes = length / sizeof(aas_bbox_t);
 	if (aasworld.numbboxes && !aasworld.bboxes) return BLERR_CANNOTREADAASLUMP;
 	//vertexes
 	offset = LittleLong(header.lumps[AASLUMP_VERTEXES].fileofs);
 	length = LittleLong(header.lumps[AASLUMP_VERTEXES].filelen);
-	aasworld.vertexes = (aas_vertex_t *) AAS_LoadAASLump(fp, offset, length, &lastoffset, sizeof(aas_vertex_t));
+	aasworld.vertexes = (aas_vertex_t *) AAS_GetAASLump(fp, offset, length, &lastoffset, sizeof(aas_vertex_t), qtrue);
 	aasworld.numvertexes = length / sizeof(aas_vertex_t);
 	if (aasworld.numvertexes && !aasworld.vertexes) return BLERR_CANNOTREADAASLUMP;
 	//planes
 	offset = LittleLong(header.lumps[AASLUMP_PLANES].fileofs);
 	length = LittleLong(header.lumps[AASLUMP_PLANES].filelen);
-	aasworld.planes = (aas_plane_t *) AAS_LoadAASLump(fp, offset, length, &lastoffset, sizeof(aas_plane_t));
+	aasworld.planes = (aas_plane_t *) AAS_GetAASLump(fp, offset, length, &lastoffset, sizeof(aas_plane_t), qtrue);
 	aasworld.numplanes = length / sizeof(aas_plane_t);
 	if (aasworld.numplanes && !aasworld.planes) return BLERR_CANNOTREADAASLUMP;
 	//edges
 	offset = LittleLong(header.lumps[AASLUMP_EDGES].fileofs);
 	length = LittleLong(header.lumps[AASLUMP_EDGES].filelen);
-	aasworld.edges = (aas_edge_t *) AAS_LoadAASLump(fp, offset, length, &lastoffset, sizeof(aas_edge_t));
+	aasworld.edges = (aas_edge_t *) AAS_GetAASLump(fp, offset, length, &lastoffset, sizeof(aas_edge_t), qtrue);
 	aasworld.numedges = length / sizeof(aas_edge_t);
 	if (aasworld.numedges && !aasworld.edges) return BLERR_CANNOTREADAASLUMP;
 	//edgeindex
 	offset = LittleLong(header.lumps[AASLUMP_EDGEINDEX].fileofs);
 	length = LittleLong(header.lumps[AASLUMP_EDGEINDEX].filelen);
-	aasworld.edgeindex = (aas_edgeindex_t *) AAS_LoadAASLump(fp, offset, length, &lastoffset, sizeof(aas_edgeindex_t));
+	aasworld.edgeindex = (aas_edgeindex_t *) AAS_GetAASLump(fp, offset, length, &lastoffset, sizeof(aas_edgeindex_t), qtrue);
 	aasworld.edgeindexsize = length / sizeof(aas_edgeindex_t);
 	if (aasworld.edgeindexsize && !aasworld.edgeindex) return BLERR_CANNOTREADAASLUMP;
 	//faces
 	offset = LittleLong(header.lumps[AASLUMP_FACES].fileofs);
 	length = LittleLong(header.lumps[AASLUMP_FACES].filelen);
-	aasworld.faces = (aas_face_t *) AAS_LoadAASLump(fp, offset, length, &lastoffset, sizeof(aas_face_t));
+	aasworld.faces = (aas_face_t *) AAS_GetAASLump(fp, offset, length, &lastoffset, sizeof(aas_face_t), qtrue);
 	aasworld.numfaces = length / sizeof(aas_face_t);
 	if (aasworld.numfaces && !aasworld.faces) return BLERR_CANNOTREADAASLUMP;
 	//faceindex
 	offset = LittleLong(header.lumps[AASLUMP_FACEINDEX].fileofs);
 	length = LittleLong(header.lumps[AASLUMP_FACEINDEX].filelen);
-	aasworld.faceindex = (aas_faceindex_t *) AAS_LoadAASLump(fp, offset, length, &lastoffset, sizeof(aas_faceindex_t));
+	aasworld.faceindex = (aas_faceindex_t *) AAS_GetAASLump(fp, offset, length, &lastoffset, sizeof(aas_faceindex_t), qtrue);
 	aasworld.faceindexsize = length / sizeof(aas_faceindex_t);
 	if (aasworld.faceindexsize && !aasworld.faceindex) return BLERR_CANNOTREADAASLUMP;
 	//convex areas
 	offset = LittleLong(header.lumps[AASLUMP_AREAS].fileofs);
 	length = LittleLong(header.lumps[AASLUMP_AREAS].filelen);
-	aasworld.areas = (aas_area_t *) AAS_LoadAASLump(fp, offset, length, &lastoffset, sizeof(aas_area_t));
+	aasworld.areas = (aas_area_t *) AAS_GetAASLump(fp, offset, length, &lastoffset, sizeof(aas_area_t), qtrue);
 	aasworld.numareas = length / sizeof(aas_area_t);
 	if (aasworld.numareas && !aasworld.areas) return BLERR_CANNOTREADAASLUMP;
 	//area settings
 	offset = LittleLong(header.lumps[AASLUMP_AREASETTINGS].fileofs);
 	length = LittleLong(header.lumps[AASLUMP_AREASETTINGS].filelen);
-	aasworld.areasettings = (aas_areasettings_t *) AAS_LoadAASLump(fp, offset, length, &lastoffset, sizeof(aas_areasettings_t));
+	aasworld.areasettings = (aas_areasettings_t *) AAS_GetAASLump(fp, offset, length, &lastoffset, sizeof(aas_areasettings_t), qfalse);
 	aasworld.numareasettings = length / sizeof(aas_areasettings_t);
 	if (aasworld.numareasettings && !aasworld.areasettings) return BLERR_CANNOTREADAASLUMP;
 	//reachability list
 	offset = LittleLong(header.lumps[AASLUMP_REACHABILITY].fileofs);
 	length = LittleLong(header.lumps[AASLUMP_REACHABILITY].filelen);
-	aasworld.reachability = (aas_reachability_t *) AAS_LoadAASLump(fp, offset, length, &lastoffset, sizeof(aas_reachability_t));
+	aasworld.reachability = (aas_reachability_t *) AAS_GetAASLump(fp, offset, length, &lastoffset, sizeof(aas_reachability_t), qfalse);
 	aasworld.reachabilitysize = length / sizeof(aas_reachability_t);
 	if (aasworld.reachabilitysize && !aasworld.reachability) return BLERR_CANNOTREADAASLUMP;
 	//nodes
 	offset = LittleLong(header.lumps[AASLUMP_NODES].fileofs);
 	length = LittleLong(header.lumps[AASLUMP_NODES].filelen);
-	aasworld.nodes = (aas_node_t *) AAS_LoadAASLump(fp, offset, length, &lastoffset, sizeof(aas_node_t));
+	aasworld.nodes = (aas_node_t *) AAS_GetAASLump(fp, offset, length, &lastoffset, sizeof(aas_node_t), qtrue);
 	aasworld.numnodes = length / sizeof(aas_node_t);
 	if (aasworld.numnodes && !aasworld.nodes) return BLERR_CANNOTREADAASLUMP;
 	//cluster portals
 	offset = LittleLong(header.lumps[AASLUMP_PORTALS].fileofs);
 	length = LittleLong(header.lumps[AASLUMP_PORTALS].filelen);
-	aasworld.portals = (aas_portal_t *) AAS_LoadAASLump(fp, offset, length, &lastoffset, sizeof(aas_portal_t));
+	aasworld.portals = (aas_portal_t *) AAS_GetAASLump(fp, offset, length, &lastoffset, sizeof(aas_portal_t), qfalse);
 	aasworld.numportals = length / sizeof(aas_portal_t);
 	if (aasworld.numportals && !aasworld.portals) return BLERR_CANNOTREADAASLUMP;
 	//cluster portal index
 	offset = LittleLong(header.lumps[AASLUMP_PORTALINDEX].fileofs);
 	length = LittleLong(header.lumps[AASLUMP_PORTALINDEX].filelen);
-	aasworld.portalindex = (aas_portalindex_t *) AAS_LoadAASLump(fp, offset, length, &lastoffset, sizeof(aas_portalindex_t));
+	aasworld.portalindex = (aas_portalindex_t *) AAS_GetAASLump(fp, offset, length, &lastoffset, sizeof(aas_portalindex_t), qfalse);
 	aasworld.portalindexsize = length / sizeof(aas_portalindex_t);
 	if (aasworld.portalindexsize && !aasworld.portalindex) return BLERR_CANNOTREADAASLUMP;
 	//clusters
 	offset = LittleLong(header.lumps[AASLUMP_CLUSTERS].fileofs);
 	length = LittleLong(header.lumps[AASLUMP_CLUSTERS].filelen);
-	aasworld.clusters = (aas_cluster_t *) AAS_LoadAASLump(fp, offset, length, &lastoffset, sizeof(aas_cluster_t));
+	aasworld.clusters = (aas_cluster_t *) AAS_GetAASLump(fp, offset, length, &lastoffset, sizeof(aas_cluster_t), qfalse);
 	aasworld.numclusters = length / sizeof(aas_cluster_t);
 	if (aasworld.numclusters && !aasworld.clusters) return BLERR_CANNOTREADAASLUMP;
 	//swap everything
 	AAS_SwapAASData();
+	//fold the node planes into the nodes for the tree walks
+	AAS_InitFlatNodes();
 	//aas file is loaded
 	aasworld.loaded = qtrue;
 	//close the file
@@ -29,6 +29,7 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
  *
  *****************************************************************************/
 
+#include <setjmp.h>
 #include "../qcommon/q_shared.h"
 #include "l_memory.h"
 #include "l_libvar.h"
@@ -200,14 +201,8 @@ void AAS_SetInitialized(void)
 // Returns:					-
 // Changes Globals:		-
 //===========================================================================
-void AAS_ContinueInit(float time)
+static void AAS_InitSteps(void)
 {
-	//if no AAS file loaded
-	if (!aasworld.loaded) return;
-	//if AAS is already initialized
-	if (aasworld.initialized) return;
-	//calculate reachability, if not finished return
-	if (AAS_ContinueInitReachability(time)) return;
 	//initialize clustering for the new map
 	AAS_InitClustering();
 	//if reachability has been calculated and an AAS file should be written
@@ -215,7 +210,8 @@ void AAS_ContinueInit(float time)
 	if (aasworld.savefile || ((int)LibVarGetValue("forcewrite")))
 	{
 		//optimize the AAS data
-		if ((int)LibVarValue("aasoptimize", "0")) AAS_Optimize();
+		//shared lumps can't be replaced
+		if ((int)LibVarValue("aasoptimize", "0") && !aasworld.shared) AAS_Optimize();
 		//save the AAS file
 		if (AAS_WriteAASFile(aasworld.filename))
 		{
@@ -228,6 +224,220 @@ void AAS_ContinueInit(float time)
 	} //end if
 	//initialize the routing
 	AAS_InitRouting();
+	//fill the routing cache up front
+	if ((int)LibVarValue("aasprecache", "0")) AAS_CreateAllRoutingCache();
+} //end of the function AAS_InitSteps
+//===========================================================================
+// AAS initialization on a worker thread
+//
+// Reachability, clustering and routing init run on a worker thread that
+// takes turns with the server: every frame AAS_StartFrame hands it up to
+// "aasinitslice" msec and waits until it gives control back at one of the
+// AAS_InitYield checkpoints.  Only one of the two runs at any time, so the
+// engine imports and the memory allocator stay single threaded, yet a map
+// without reachability or clusters no longer stops the server for seconds.
+// The handoff goes through a semaphore per side, so neither polls.
+// Bots idle until the main thread marks AAS initialized after the join.
+// A map change or shutdown aborts an unfinished init: the worker jumps
+// out at its next checkpoint, where all its state lives in aasworld.
+//===========================================================================
+
+#define AASINIT_MAIN		0
+#define AASINIT_WORKER		1
+#define AASINIT_DONE		2
+
+typedef struct aas_initthread_s
+{
+	void *thread;
+	void *mainsem;				//posted when the worker yields or is done
+	void *workersem;			//posted when the worker gets a slice
+	volatile int turn;			//who runs, AASINIT_*
+	int sliceend;				//worker yields once Sys_MilliSeconds passes this
+	int abort;					//unwind at the next checkpoint
+	jmp_buf abortjmp;
+	int starttime;
+	int frames;
+	int worktime;
+	int longestslice;
+} aas_initthread_t;
+
+static aas_initthread_t aasinit;
+
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+static void AAS_InitThread(void *arg)
+{
+	botimport.SemaphoreWait(aasinit.workersem, -1);
+	if (setjmp(aasinit.abortjmp))
+	{
+		AAS_AbortInitReachability();
+		aasworld.initialized = qfalse;
+		aasinit.turn = AASINIT_DONE;
+		botimport.SemaphorePost(aasinit.mainsem);
+		return;
+	} //end if
+	//calculate reachability
+	while (AAS_ContinueInitReachability(aasworld.time)) AAS_InitYield();
+	AAS_InitSteps();
+	aasinit.turn = AASINIT_DONE;
+	botimport.SemaphorePost(aasinit.mainsem);
+} //end of the function AAS_InitThread
+//===========================================================================
+// called from the worker at points where the main thread may run, does
+// nothing without a worker
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void AAS_InitYield(void)
+{
+	if (!aasinit.thread) return;
+	if (aasinit.abort) longjmp(aasinit.abortjmp, 1);
+	if (Sys_MilliSeconds() < aasinit.sliceend) return;
+	aasinit.turn = AASINIT_MAIN;
+	botimport.SemaphorePost(aasinit.mainsem);
+	botimport.SemaphoreWait(aasinit.workersem, -1);
+	if (aasinit.abort) longjmp(aasinit.abortjmp, 1);
+} //end of the function AAS_InitYield
+//===========================================================================
+// lets the worker run and waits until it yields or is done
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+static void AAS_HandOverInit(void)
+{
+	aasinit.turn = AASINIT_WORKER;
+	botimport.SemaphorePost(aasinit.workersem);
+	botimport.SemaphoreWait(aasinit.mainsem, -1);
+} //end of the function AAS_HandOverInit
+//===========================================================================
+// gives the worker one time slice and waits until it yields
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+static void AAS_RunInitSlice(void)
+{
+	int start, elapsed;
+
+	start = Sys_MilliSeconds();
+	aasinit.sliceend = start + (int) LibVarValue("aasinitslice", "10");
+	AAS_HandOverInit();
+	elapsed = Sys_MilliSeconds() - start;
+	aasinit.frames++;
+	aasinit.worktime += elapsed;
+	if (elapsed > aasinit.longestslice) aasinit.longestslice = elapsed;
+} //end of the function AAS_RunInitSlice
+//===========================================================================
+// joins the finished worker and releases its semaphores
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+static void AAS_FreeInitThread(void)
+{
+	botimport.JoinThread(aasinit.thread);
+	aasinit.thread = NULL;
+	botimport.DestroySemaphore(aasinit.mainsem);
+	botimport.DestroySemaphore(aasinit.workersem);
+	aasinit.mainsem = aasinit.workersem = NULL;
+} //end of the function AAS_FreeInitThread
+//===========================================================================
+// drops the unfinished init of the old map before the map changes or
+// the library shuts down
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+static void AAS_StopInitThread(void)
+{
+	if (!aasinit.thread) return;
+	//the worker unwinds as soon as it gets the turn, so the next
+	//post it makes is the one when it's done
+	aasinit.abort = qtrue;
+	if (aasinit.turn != AASINIT_DONE) AAS_HandOverInit();
+	AAS_FreeInitThread();
+} //end of the function AAS_StopInitThread
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+static void AAS_ContinueInitThread(void)
+{
+	if (!aasinit.thread)
+	{
+		Com_Memset(&aasinit, 0, sizeof(aasinit));
+		aasinit.starttime = Sys_MilliSeconds();
+		aasinit.mainsem = botimport.CreateSemaphore(0);
+		aasinit.workersem = botimport.CreateSemaphore(0);
+		if (aasinit.mainsem && aasinit.workersem)
+		{
+			aasinit.thread = botimport.CreateThread(AAS_InitThread, NULL);
+		} //end if
+		if (!aasinit.thread)
+		{
+			if (aasinit.mainsem) botimport.DestroySemaphore(aasinit.mainsem);
+			if (aasinit.workersem) botimport.DestroySemaphore(aasinit.workersem);
+			aasinit.mainsem = aasinit.workersem = NULL;
+			botimport.Print(PRT_WARNING, "couldn't start the AAS init thread\n");
+			while (AAS_ContinueInitReachability(aasworld.time));
+			AAS_InitSteps();
+			AAS_SetInitialized();
+			return;
+		} //end if
+	} //end if
+	AAS_RunInitSlice();
+	if (aasinit.turn != AASINIT_DONE) return;
+
+	AAS_FreeInitThread();
+	if (!com_quiet->integer)
+	{
+		botimport.Print(PRT_MESSAGE, "AAS init: %d msec of work over %d frames in %d msec, longest frame %d msec\n",
+			aasinit.worktime, aasinit.frames, Sys_MilliSeconds() - aasinit.starttime, aasinit.longestslice);
+	} //end if
+	AAS_SetInitialized();
+} //end of the function AAS_ContinueInitThread
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void AAS_ContinueInit(float time)
+{
+	static int starttime;
+
+	//if no AAS file loaded
+	if (!aasworld.loaded) return;
+	//if AAS is already initialized
+	if (aasworld.initialized) return;
+	//on a worker thread
+	if ((int)LibVarValue("aasthread", "1") && botimport.CreateThread && botimport.CreateSemaphore)
+	{
+		AAS_ContinueInitThread();
+		return;
+	} //end if
+	if (!starttime) starttime = Sys_MilliSeconds();
+	//calculate reachability, if not finished return
+	if (AAS_ContinueInitReachability(time)) return;
+	AAS_InitSteps();
+	if (!com_quiet->integer)
+	{
+		botimport.Print(PRT_MESSAGE, "AAS init: %d msec\n", Sys_MilliSeconds() - starttime);
+	} //end if
+	starttime = 0;
 	//at this point AAS is initialized
 	AAS_SetInitialized();
 } //end of the function AAS_ContinueInit
@@ -274,6 +484,16 @@ int AAS_StartFrame(float time)
 		AAS_WriteRouteCache();
 		LibVarSet("saveroutingcache", "0");
 	} //end if
+	if (LibVarGetValue("routingcachestats"))
+	{
+		AAS_RoutingCacheStats();
+		LibVarSet("routingcachestats", "0");
+	} //end if
+	if (LibVarGetValue("aasbenchmark"))
+	{
+		AAS_BenchmarkPointQueries((int) LibVarGetValue("aasbenchmark"));
+		LibVarSet("aasbenchmark", "0");
+	} //end if
 	//
 	aasworld.numframes++;
 	return BLERR_NOERROR;
@@ -351,6 +571,7 @@ int AAS_LoadMap(const char *mapname)
 		return 0;
 	} //end if
 	//
+	AAS_StopInitThread();
 	aasworld.initialized = qfalse;
 	//NOTE: free the routing caches before loading a new map because
 	// to free the caches the old number of areas, number of clusters
@@ -408,6 +629,7 @@ int AAS_Setup(void)
 //===========================================================================
 void AAS_Shutdown(void)
 {
+	AAS_StopInitThread();
 	AAS_ShutdownAlternativeRouting();
 	//
 	AAS_DumpBSPData();
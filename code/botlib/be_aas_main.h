@@ -45,6 +45,8 @@ void AAS_Shutdown(void);
 int AAS_LoadMap(const char *mapname);
 //start a new time frame
 int AAS_StartFrame(float time);
+//let the main thread run if the init worker used up its time slice
+void AAS_InitYield(void);
 #endif //AASINTERN
 
 //returns true if AAS is initialized
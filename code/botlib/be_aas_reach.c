@@ -476,6 +476,7 @@ void AAS_SetupReachabilityHeap(void)
 void AAS_ShutDownReachabilityHeap(void)
 {
 	FreeMemory(reachabilityheap);
+	reachabilityheap = NULL;
 	numlreachabilities = 0;
 } //end of the function AAS_ShutDownReachabilityHeap
 //===========================================================================
@@ -4380,6 +4381,7 @@ int AAS_ContinueInitReachability(float time)
 	//loop over the areas
 	for (i = aasworld.numreachabilityareas; i < aasworld.numareas && i < todo; i++)
 	{
+		AAS_InitYield();
 		aasworld.numreachabilityareas++;
 		//only create jumppad reachabilities from jumppad areas
 		if (aasworld.areasettings[i].contents & AREACONTENTS_JUMPPAD)
@@ -4485,6 +4487,7 @@ int AAS_ContinueInitReachability(float time)
 		AAS_ShutDownReachabilityHeap();
 		//
 		FreeMemory(areareachability);
+		areareachability = NULL;
 		//
 		aasworld.numreachabilityareas++;
 		//
@@ -4504,6 +4507,18 @@ int AAS_ContinueInitReachability(float time)
 // Returns:					-
 // Changes Globals:		-
 //===========================================================================
+void AAS_AbortInitReachability(void)
+{
+	if (reachabilityheap) AAS_ShutDownReachabilityHeap();
+	if (areareachability) FreeMemory(areareachability);
+	areareachability = NULL;
+} //end of the function AAS_AbortInitReachability
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
 void AAS_InitReachability(void)
 {
 	if (!aasworld.loaded) return;
@@ -34,6 +34,8 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 void AAS_InitReachability(void);
 //continue calculating the reachabilities
 int AAS_ContinueInitReachability(float time);
+//free the temporary reachabilities of an unfinished calculation
+void AAS_AbortInitReachability(void);
 //
 int AAS_BestReachableLinkArea(aas_link_t *areas);
 #endif //AASINTERN
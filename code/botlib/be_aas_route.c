@@ -84,6 +84,52 @@ int numportalcacheupdates;
 int routingcachesize;
 int max_routingcachesize;
 
+//the routing caches live in one slab of max_routingcachesize bytes
+//blocks are carved first fit from an address ordered free list and
+//the CLOCK hand in aasworld evicts caches when the slab is full
+#define ROUTINGBLOCK_ALIGN			16
+
+typedef struct aas_routingblock_s
+{
+	int size;									//size of the free block
+	struct aas_routingblock_s *next;			//next free block at a higher address
+} aas_routingblock_t;
+
+typedef struct aas_routingslab_s
+{
+	byte *base;									//start of the slab
+	int size;									//size of the slab in bytes
+	int used;									//bytes in use by caches in the slab
+	aas_routingblock_t *freeblocks;				//address ordered free blocks
+	unsigned short serial;						//current route query
+	int numcaches;								//number of caches in the cache list
+	int hits;									//cache lookups that found a cache
+	int misses;									//cache lookups that created a cache
+	int evictions;								//caches freed by the CLOCK hand
+	int overflows;								//caches that did not fit in the slab
+} aas_routingslab_t;
+
+aas_routingslab_t routingslab;
+
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+void AAS_RoutingCacheStats(void)
+{
+	int lookups;
+
+	lookups = routingslab.hits + routingslab.misses;
+	botimport.Print(PRT_MESSAGE, "%d routing caches, %d bytes in use\n",
+						routingslab.numcaches, routingcachesize);
+	botimport.Print(PRT_MESSAGE, "%d of %d bytes routing cache slab used\n",
+						routingslab.used, routingslab.size);
+	botimport.Print(PRT_MESSAGE, "%d lookups, %d hits (%d%%), %d evictions, %d overflows\n",
+						lookups, routingslab.hits, lookups ? (int) (100.0f * routingslab.hits / lookups) : 0,
+						routingslab.evictions, routingslab.overflows);
+} //end of the function AAS_RoutingCacheStats
 //===========================================================================
 //
 // Parameter:			-
@@ -95,7 +141,7 @@ void AAS_RoutingInfo(void)
 {
 	botimport.Print(PRT_MESSAGE, "%d area cache updates\n", numareacacheupdates);
 	botimport.Print(PRT_MESSAGE, "%d portal cache updates\n", numportalcacheupdates);
-	botimport.Print(PRT_MESSAGE, "%d bytes routing cache\n", routingcachesize);
+	AAS_RoutingCacheStats();
 } //end of the function AAS_RoutingInfo
 #endif //ROUTING_DEBUG
 //===========================================================================
@@ -197,8 +243,116 @@ int AAS_TravelFlagForType(int traveltype)
 // Returns:				-
 // Changes Globals:		-
 //===========================================================================
+void AAS_InitRoutingSlab(int size)
+{
+	Com_Memset(&routingslab, 0, sizeof(aas_routingslab_t));
+	routingslab.serial = 1;
+	size &= ~(ROUTINGBLOCK_ALIGN - 1);
+	if (size < (int) sizeof(aas_routingblock_t)) return;
+	routingslab.base = (byte *) GetMemory(size);
+	routingslab.size = size;
+	routingslab.freeblocks = (aas_routingblock_t *) routingslab.base;
+	routingslab.freeblocks->size = size;
+	routingslab.freeblocks->next = NULL;
+} //end of the function AAS_InitRoutingSlab
+//===========================================================================
+// all caches must have been freed before the slab is
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+void AAS_FreeRoutingSlab(void)
+{
+	if (routingslab.base) FreeMemory(routingslab.base);
+	routingslab.base = NULL;
+	routingslab.size = 0;
+	routingslab.used = 0;
+	routingslab.freeblocks = NULL;
+} //end of the function AAS_FreeRoutingSlab
+//===========================================================================
+// returns a block from the slab or NULL when no free block is large enough
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+void *AAS_AllocRoutingBlock(int size)
+{
+	aas_routingblock_t *block, **prev, *rest;
+
+	//sizes are kept a multiple of ROUTINGBLOCK_ALIGN so any remainder
+	//is either empty or large enough to hold a free block
+	size = (size + ROUTINGBLOCK_ALIGN - 1) & ~(ROUTINGBLOCK_ALIGN - 1);
+	for (prev = &routingslab.freeblocks; *prev; prev = &(*prev)->next)
+	{
+		block = *prev;
+		if (block->size < size) continue;
+		if (block->size > size)
+		{
+			rest = (aas_routingblock_t *) ((byte *) block + size);
+			rest->size = block->size - size;
+			rest->next = block->next;
+			*prev = rest;
+		} //end if
+		else
+		{
+			*prev = block->next;
+		} //end else
+		routingslab.used += size;
+		return block;
+	} //end for
+	return NULL;
+} //end of the function AAS_AllocRoutingBlock
+//===========================================================================
+// returns qfalse if the cache was not allocated from the slab
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+int AAS_FreeRoutingBlock(aas_routingcache_t *cache)
+{
+	aas_routingblock_t *block, *before, *next;
+
+	if ((byte *) cache < routingslab.base ||
+			(byte *) cache >= routingslab.base + routingslab.size) return qfalse;
+	block = (aas_routingblock_t *) cache;
+	block->size = (cache->size + ROUTINGBLOCK_ALIGN - 1) & ~(ROUTINGBLOCK_ALIGN - 1);
+	routingslab.used -= block->size;
+	//find the free blocks around this one
+	before = NULL;
+	for (next = routingslab.freeblocks; next && next < block; next = next->next)
+	{
+		before = next;
+	} //end for
+	//merge with the next free block
+	if (next && (byte *) block + block->size == (byte *) next)
+	{
+		block->size += next->size;
+		next = next->next;
+	} //end if
+	block->next = next;
+	//merge with the previous free block
+	if (before && (byte *) before + before->size == (byte *) block)
+	{
+		before->size += block->size;
+		before->next = block->next;
+	} //end if
+	else if (before) before->next = block;
+	else routingslab.freeblocks = block;
+	return qtrue;
+} //end of the function AAS_FreeRoutingBlock
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
 void AAS_UnlinkCache(aas_routingcache_t *cache)
 {
+	if (aasworld.cachehand == cache) aasworld.cachehand = cache->time_next;
+	routingslab.numcaches--;
 	if (cache->time_next) cache->time_next->time_prev = cache->time_prev;
 	else aasworld.newestcache = cache->time_prev;
 	if (cache->time_prev) cache->time_prev->time_next = cache->time_next;
@@ -214,6 +368,7 @@ void AAS_UnlinkCache(aas_routingcache_t *cache)
 //===========================================================================
 void AAS_LinkCache(aas_routingcache_t *cache)
 {
+	routingslab.numcaches++;
 	if (aasworld.newestcache)
 	{
 		aasworld.newestcache->time_next = cache;
@@ -237,7 +392,7 @@ void AAS_FreeRoutingCache(aas_routingcache_t *cache)
 {
 	AAS_UnlinkCache(cache);
 	routingcachesize -= cache->size;
-	FreeMemory(cache);
+	if (!AAS_FreeRoutingBlock(cache)) FreeMemory(cache);
 } //end of the function AAS_FreeRoutingCache
 //===========================================================================
 //
@@ -688,24 +843,44 @@ int AAS_FreeOldestCache(void)
 } //end of the function AAS_FreeOldestCache
 */
 //===========================================================================
+// evicts one cache, when heaponly is set only caches that overflowed the
+// slab onto the heap are considered because freeing slab caches doesn't
+// give any memory back to the heap
 //
-// Parameter:			-
-// Returns:				-
+// Parameter:			heaponly	: only evict caches allocated from the heap
+// Returns:				qtrue if a cache was freed
 // Changes Globals:		-
 //===========================================================================
-int AAS_FreeOldestCache(void)
+int AAS_FreeOldestCache(int heaponly)
 {
-	int clusterareanum;
+	int i, clusterareanum;
 	aas_routingcache_t *cache;
 
-	for (cache = aasworld.oldestcache; cache; cache = cache->time_next) {
+	//two sweeps clear every reference bit once and then find a victim
+	for (i = 0; i < 2 * routingslab.numcaches; i++)
+	{
+		cache = aasworld.cachehand;
+		if (!cache) cache = aasworld.oldestcache;
+		if (!cache) break;
+		aasworld.cachehand = cache->time_next;
+		// slab caches don't return memory to the heap
+		if (heaponly && (byte *) cache >= routingslab.base &&
+				(byte *) cache < routingslab.base + routingslab.size) {
+			continue;
+		}
 		// never free area cache leading towards a portal
 		if (cache->type == CACHETYPE_AREA && aasworld.areasettings[cache->areanum].cluster < 0) {
 			continue;
 		}
-		break;
-	}
-	if (cache) {
+		// never free cache used by the current route query
+		if (cache->serial == routingslab.serial) {
+			continue;
+		}
+		// give recently accessed cache a second chance
+		if (cache->referenced) {
+			cache->referenced = 0;
+			continue;
+		}
 		// unlink the cache
 		if (cache->type == CACHETYPE_AREA) {
 			//number of the area in the cluster
@@ -722,11 +897,35 @@ int AAS_FreeOldestCache(void)
 			if (cache->next) cache->next->prev = cache->prev;
 		}
 		AAS_FreeRoutingCache(cache);
+		routingslab.evictions++;
 		return qtrue;
 	}
 	return qfalse;
 } //end of the function AAS_FreeOldestCache
 //===========================================================================
+// returns memory for a routing cache of the given size, evicting caches
+// from the slab until it fits and falling back to the heap if it never does
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+aas_routingcache_t *AAS_GetRoutingCacheMemory(int size)
+{
+	aas_routingcache_t *cache;
+
+	if (routingslab.base)
+	{
+		do
+		{
+			cache = (aas_routingcache_t *) AAS_AllocRoutingBlock(size);
+			if (cache) return cache;
+		} while(AAS_FreeOldestCache(qfalse));
+		routingslab.overflows++;
+	} //end if
+	return (aas_routingcache_t *) GetMemory(size);
+} //end of the function AAS_GetRoutingCacheMemory
+//===========================================================================
 //
 // Parameter:			-
 // Returns:				-
@@ -743,11 +942,14 @@ aas_routingcache_t *AAS_AllocRoutingCache(int numtraveltimes)
 						+ numtraveltimes * sizeof(unsigned char);
 	//
 	routingcachesize += size;
+	routingslab.misses++;
 	//
-	cache = (aas_routingcache_t *) GetClearedMemory(size);
+	cache = AAS_GetRoutingCacheMemory(size);
+	Com_Memset(cache, 0, size);
 	cache->reachabilities = (unsigned char *) cache + sizeof(aas_routingcache_t)
 								+ numtraveltimes * sizeof(unsigned short int);
 	cache->size = size;
+	cache->serial = routingslab.serial;
 	return cache;
 } //end of the function AAS_AllocRoutingCache
 //===========================================================================
@@ -893,6 +1095,7 @@ void AAS_CreateAllRoutingCache(void)
 	botimport.Print(PRT_MESSAGE, "AAS_CreateAllRoutingCache\n");
 	for (i = 1; i < aasworld.numareas; i++)
 	{
+		AAS_InitYield();
 		if (!AAS_AreaReachability(i)) continue;
 		for (j = 1; j < aasworld.numareas; j++)
 		{
@@ -932,6 +1135,26 @@ typedef struct routecacheheader_s
 //void AAS_DecompressVis(byte *in, int numareas, byte *decompressed);
 //int AAS_CompressVis(byte *vis, int numareas, byte *dest);
 
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+void AAS_WriteCache(aas_routingcache_t *cache, fileHandle_t fp)
+{
+	int headersize;
+	aas_routingcache_t header;
+
+	//clear the CLOCK state so the dump only depends on the routing data
+	headersize = (int) ((byte *) cache->traveltimes - (byte *) cache);
+	Com_Memcpy(&header, cache, headersize);
+	header.referenced = 0;
+	header.serial = 0;
+	botimport.FS_Write(&header, headersize, fp);
+	botimport.FS_Write((unsigned char *)cache + headersize, cache->size - headersize, fp);
+} //end of the function AAS_WriteCache
+
 void AAS_WriteRouteCache(void)
 {
 	int i, j, numportalcache, numareacache, totalsize;
@@ -987,7 +1210,7 @@ void AAS_WriteRouteCache(void)
 	{
 		for (cache = aasworld.portalcache[i]; cache; cache = cache->next)
 		{
-			botimport.FS_Write(cache, cache->size, fp);
+			AAS_WriteCache(cache, fp);
 			totalsize += cache->size;
 		} //end for
 	} //end for
@@ -998,7 +1221,7 @@ void AAS_WriteRouteCache(void)
 		{
 			for (cache = aasworld.clusterareacache[i][j]; cache; cache = cache->next)
 			{
-				botimport.FS_Write(cache, cache->size, fp);
+				AAS_WriteCache(cache, fp);
 				totalsize += cache->size;
 			} //end for
 		} //end for
@@ -1031,15 +1254,21 @@ void AAS_WriteRouteCache(void)
 //===========================================================================
 aas_routingcache_t *AAS_ReadCache(fileHandle_t fp)
 {
-	int size;
-	aas_routingcache_t *cache;
-
-	botimport.FS_Read(&size, sizeof(size), fp);
-	cache = (aas_routingcache_t *) GetMemory(size);
-	cache->size = size;
-	botimport.FS_Read((unsigned char *)cache + sizeof(size), size - sizeof(size), fp);
-	cache->reachabilities = (unsigned char *) cache + sizeof(aas_routingcache_t) - sizeof(unsigned short) +
-		(size - sizeof(aas_routingcache_t) + sizeof(unsigned short)) / 3 * 2;
+	int headersize, numtraveltimes;
+	aas_routingcache_t header, *cache;
+
+	//the cache is stored as written by AAS_WriteCache, header first
+	headersize = (int) ((byte *) header.traveltimes - (byte *) &header);
+	botimport.FS_Read(&header, headersize, fp);
+	cache = AAS_GetRoutingCacheMemory(header.size);
+	Com_Memcpy(cache, &header, headersize);
+	botimport.FS_Read((unsigned char *)cache + headersize, header.size - headersize, fp);
+	numtraveltimes = (header.size - sizeof(aas_routingcache_t)) / 3;
+	cache->reachabilities = (unsigned char *) cache + sizeof(aas_routingcache_t)
+								+ numtraveltimes * sizeof(unsigned short int);
+	cache->referenced = 0;
+	cache->serial = 0;
+	routingcachesize += cache->size;
 	return cache;
 } //end of the function AAS_ReadCache
 //===========================================================================
@@ -1104,6 +1333,7 @@ int AAS_ReadRouteCache(void)
 		if (aasworld.portalcache[cache->areanum])
 			aasworld.portalcache[cache->areanum]->prev = cache;
 		aasworld.portalcache[cache->areanum] = cache;
+		AAS_LinkCache(cache);
 	} //end for
 	//read all the cluster area cache
 	for (i = 0; i < routecacheheader.numareacache; i++)
@@ -1115,6 +1345,7 @@ int AAS_ReadRouteCache(void)
 		if (aasworld.clusterareacache[cache->cluster][clusterareanum])
 			aasworld.clusterareacache[cache->cluster][clusterareanum]->prev = cache;
 		aasworld.clusterareacache[cache->cluster][clusterareanum] = cache;
+		AAS_LinkCache(cache);
 	} //end for
 	// read the visareas
 	/*
@@ -1222,16 +1453,20 @@ void AAS_InitRouting(void)
 	AAS_InitRoutingUpdate();
 	//create reversed reachability links used by the routing update algorithm
 	AAS_CreateReversedReachability();
+	AAS_InitYield();
 	//initialize the cluster cache
 	AAS_InitClusterAreaCache();
+	AAS_InitYield();
 	//initialize portal cache
 	AAS_InitPortalCache();
 	//initialize the area travel times
 	AAS_CalculateAreaTravelTimes();
+	AAS_InitYield();
 	//calculate the maximum travel times through portals
 	AAS_InitPortalMaxTravelTimes();
 	//get the areas reachabilities go through
 	AAS_InitReachabilityAreas();
+	AAS_InitYield();
 	//
 #ifdef ROUTING_DEBUG
 	numareacacheupdates = 0;
@@ -1240,6 +1475,9 @@ void AAS_InitRouting(void)
 	//
 	routingcachesize = 0;
 	max_routingcachesize = 1024 * (int) LibVarValue("max_routingcache", "4096");
+	//allocate the slab the routing caches are stored in
+	AAS_FreeRoutingSlab();
+	AAS_InitRoutingSlab(max_routingcachesize);
 	// read any routing cache if available
 	AAS_ReadRouteCache();
 } //end of the function AAS_InitRouting
@@ -1255,6 +1493,8 @@ void AAS_FreeRoutingCaches(void)
 	AAS_FreeAllClusterAreaCache();
 	// free all the existing portal cache
 	AAS_FreeAllPortalCache();
+	// free the slab the caches were stored in
+	AAS_FreeRoutingSlab();
 	// free cached travel times within areas
 	if (aasworld.areatraveltimes) FreeMemory(aasworld.areatraveltimes);
 	aasworld.areatraveltimes = NULL;
@@ -1426,15 +1666,17 @@ aas_routingcache_t *AAS_GetAreaRoutingCache(int clusternum, int areanum, int tra
 		if (clustercache) clustercache->prev = cache;
 		aasworld.clusterareacache[clusternum][clusterareanum] = cache;
 		AAS_UpdateAreaRoutingCache(cache);
+		cache->type = CACHETYPE_AREA;
+		AAS_LinkCache(cache);
 	} //end if
 	else
 	{
-		AAS_UnlinkCache(cache);
+		routingslab.hits++;
 	} //end else
 	//the cache has been accessed
 	cache->time = AAS_RoutingTime();
-	cache->type = CACHETYPE_AREA;
-	AAS_LinkCache(cache);
+	cache->referenced = 1;
+	cache->serial = routingslab.serial;
 	return cache;
 } //end of the function AAS_GetAreaRoutingCache
 //===========================================================================
@@ -1566,15 +1808,17 @@ aas_routingcache_t *AAS_GetPortalRoutingCache(int clusternum, int areanum, int t
 		aasworld.portalcache[areanum] = cache;
 		//update the cache
 		AAS_UpdatePortalRoutingCache(cache);
+		cache->type = CACHETYPE_PORTAL;
+		AAS_LinkCache(cache);
 	} //end if
 	else
 	{
-		AAS_UnlinkCache(cache);
+		routingslab.hits++;
 	} //end else
 	//the cache has been accessed
 	cache->time = AAS_RoutingTime();
-	cache->type = CACHETYPE_PORTAL;
-	AAS_LinkCache(cache);
+	cache->referenced = 1;
+	cache->serial = routingslab.serial;
 	return cache;
 } //end of the function AAS_GetPortalRoutingCache
 //===========================================================================
@@ -1617,9 +1861,12 @@ int AAS_AreaRouteToGoalArea(int areanum, vec3_t origin, int goalareanum, int tra
 		} //end if
 		return qfalse;
 	} //end if
-	// make sure the routing cache doesn't grow to large
+	//caches used from here on are not evicted until the next query
+	if (!++routingslab.serial) routingslab.serial = 1;
+	// make sure the routing cache doesn't grow to large, only the caches
+	// that overflowed the slab are taken from the heap
 	while(AvailableMemory() < 1 * 1024 * 1024) {
-		if (!AAS_FreeOldestCache()) break;
+		if (!AAS_FreeOldestCache(qtrue)) break;
 	}
 	//
 	if (AAS_AreaDoNotEnter(areanum) || AAS_AreaDoNotEnter(goalareanum))
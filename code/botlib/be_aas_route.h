@@ -41,6 +41,8 @@ void AAS_CreateAllRoutingCache(void);
 void AAS_WriteRouteCache(void);
 //
 void AAS_RoutingInfo(void);
+//print routing cache hit rate, evictions and memory use
+void AAS_RoutingCacheStats(void);
 #endif //AASINTERN
 
 //returns the travel flag for the given travel type
@@ -63,6 +63,25 @@ typedef struct aas_tracestack_s
 
 int numaaslinks;
 
+//flattened nodes are aligned so two fit exactly in a cache line
+#define AAS_FLATNODE_ALIGN			32
+//exact point to area lookups remembered by AAS_PointAreaNum
+#define AAS_POINTAREACACHE_BITS		8
+#define AAS_POINTAREACACHE_SIZE		(1 << AAS_POINTAREACACHE_BITS)
+//kept off the planes so rounding can't put a moved point on the other side
+#define AAS_POINTAREA_EPSILON		0.05f
+
+typedef struct aas_pointareacache_s
+{
+	vec3_t point;
+	float radius;								//same area within this distance of point
+	int areanum;								//-1 if the entry is unused
+} aas_pointareacache_t;
+
+aas_pointareacache_t pointareacache[AAS_POINTAREACACHE_SIZE];
+//last lookup of every client, follows a moving bot
+aas_pointareacache_t clientpointareacache[MAX_CLIENTS];
+
 //===========================================================================
 //
 // Parameter:				-
@@ -203,30 +222,103 @@ void AAS_FreeAASLinkedEntities(void)
 	aasworld.arealinkedentities = NULL;
 } //end of the function AAS_InitAASLinkedEntities
 //===========================================================================
-// returns the AAS area the point is in
 //
 // Parameter:				-
 // Returns:					-
 // Changes Globals:		-
 //===========================================================================
-int AAS_PointAreaNum(vec3_t point)
+void AAS_FreeFlatNodes(void)
+{
+	if (aasworld.flatnodesmemory) FreeMemory(aasworld.flatnodesmemory);
+	aasworld.flatnodesmemory = NULL;
+	aasworld.flatnodes = NULL;
+} //end of the function AAS_FreeFlatNodes
+//===========================================================================
+// copies the node planes into the nodes so walking the tree only touches
+// one aligned record per node, must be called after the nodes and planes
+// are loaded
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void AAS_InitFlatNodes(void)
+{
+	int i;
+	aas_node_t *node;
+	aas_plane_t *plane;
+	aas_flatnode_t *flatnode;
+
+	AAS_FreeFlatNodes();
+	for (i = 0; i < AAS_POINTAREACACHE_SIZE; i++)
+	{
+		pointareacache[i].areanum = -1;
+	} //end for
+	for (i = 0; i < MAX_CLIENTS; i++)
+	{
+		clientpointareacache[i].areanum = -1;
+	} //end for
+	if (!aasworld.numnodes) return;
+	aasworld.flatnodesmemory = GetMemory(aasworld.numnodes * sizeof(aas_flatnode_t) + AAS_FLATNODE_ALIGN);
+	aasworld.flatnodes = (aas_flatnode_t *) (((size_t) aasworld.flatnodesmemory + AAS_FLATNODE_ALIGN - 1) &
+												~(size_t) (AAS_FLATNODE_ALIGN - 1));
+	for (i = 0; i < aasworld.numnodes; i++)
+	{
+		node = &aasworld.nodes[i];
+		plane = &aasworld.planes[node->planenum];
+		flatnode = &aasworld.flatnodes[i];
+		VectorCopy(plane->normal, flatnode->normal);
+		flatnode->dist = plane->dist;
+		flatnode->children[0] = node->children[0];
+		flatnode->children[1] = node->children[1];
+		flatnode->planenum = node->planenum;
+		flatnode->pad = 0;
+	} //end for
+} //end of the function AAS_InitFlatNodes
+//===========================================================================
+// returns the AAS area the point is in walking the original nodes and
+// planes, only used to verify and benchmark the flattened tree
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+int AAS_PointAreaNumTree(vec3_t point)
 {
 	int nodenum;
 	vec_t	dist;
 	aas_node_t *node;
 	aas_plane_t *plane;
 
-	if (!aasworld.loaded)
+	//start with node 1 because node zero is a dummy used for solid leafs
+	nodenum = 1;
+	while (nodenum > 0)
 	{
-		botimport.Print(PRT_ERROR, "AAS_PointAreaNum: aas not loaded\n");
-		return 0;
-	} //end if
+		node = &aasworld.nodes[nodenum];
+		plane = &aasworld.planes[node->planenum];
+		dist = DotProduct(point, plane->normal) - plane->dist;
+		if (dist > 0) nodenum = node->children[0];
+		else nodenum = node->children[1];
+	} //end while
+	if (!nodenum) return 0;
+	return -nodenum;
+} //end of the function AAS_PointAreaNumTree
+//===========================================================================
+// returns the AAS area the point is in walking the flattened nodes
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+int AAS_PointAreaNumFlat(vec3_t point)
+{
+	int nodenum;
+	aas_flatnode_t *node;
 
 	//start with node 1 because node zero is a dummy used for solid leafs
 	nodenum = 1;
 	while (nodenum > 0)
 	{
-//		botimport.Print(PRT_MESSAGE, "[%d]", nodenum);
 #ifdef AAS_SAMPLE_DEBUG
 		if (nodenum >= aasworld.numnodes)
 		{
@@ -234,18 +326,8 @@ int AAS_PointAreaNum(vec3_t point)
 			return 0;
 		} //end if
 #endif //AAS_SAMPLE_DEBUG
-		node = &aasworld.nodes[nodenum];
-#ifdef AAS_SAMPLE_DEBUG
-		if (node->planenum < 0 || node->planenum >= aasworld.numplanes)
-		{
-			botimport.Print(PRT_ERROR, "node->planenum = %d >= aasworld.numplanes = %d\n", node->planenum, aasworld.numplanes);
-			return 0;
-		} //end if
-#endif //AAS_SAMPLE_DEBUG
-		plane = &aasworld.planes[node->planenum];
-		dist = DotProduct(point, plane->normal) - plane->dist;
-		if (dist > 0) nodenum = node->children[0];
-		else nodenum = node->children[1];
+		node = &aasworld.flatnodes[nodenum];
+		nodenum = node->children[!(DotProduct(point, node->normal) - node->dist > 0)];
 	} //end while
 	if (!nodenum)
 	{
@@ -255,8 +337,252 @@ int AAS_PointAreaNum(vec3_t point)
 		return 0;
 	} //end if
 	return -nodenum;
+} //end of the function AAS_PointAreaNumFlat
+//===========================================================================
+// returns the AAS area the point is in walking the flattened nodes, radius
+// is set to the distance the point can move without crossing any of the
+// planes on its way down the tree
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+static int AAS_PointAreaNumRadius(vec3_t point, float *radius)
+{
+	int nodenum;
+	float dist, mindist;
+	aas_flatnode_t *node;
+
+	mindist = 999999;
+	//start with node 1 because node zero is a dummy used for solid leafs
+	nodenum = 1;
+	while (nodenum > 0)
+	{
+		node = &aasworld.flatnodes[nodenum];
+		dist = DotProduct(point, node->normal) - node->dist;
+		if (dist > 0)
+		{
+			nodenum = node->children[0];
+			if (dist < mindist) mindist = dist;
+		} //end if
+		else
+		{
+			nodenum = node->children[1];
+			if (-dist < mindist) mindist = -dist;
+		} //end else
+	} //end while
+	*radius = mindist - AAS_POINTAREA_EPSILON;
+	if (!nodenum) return 0;
+	return -nodenum;
+} //end of the function AAS_PointAreaNumRadius
+//===========================================================================
+// returns the AAS area the point is in, reusing the last answer of the
+// cache as long as the point stays within its radius
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+static int AAS_PointAreaNumCached(vec3_t point, aas_pointareacache_t *cache)
+{
+	vec3_t dir;
+
+	if (cache->areanum >= 0)
+	{
+		VectorSubtract(point, cache->point, dir);
+		if (DotProduct(dir, dir) < cache->radius * cache->radius) return cache->areanum;
+	} //end if
+	VectorCopy(point, cache->point);
+	cache->areanum = AAS_PointAreaNumRadius(point, &cache->radius);
+	if (cache->radius < 0) cache->radius = 0;
+	return cache->areanum;
+} //end of the function AAS_PointAreaNumCached
+//===========================================================================
+// returns the AAS area the point is in
+//
+// bots ask for the area of the same origin many times during a think, the
+// last answers are kept in a small table indexed by the exact point
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+int AAS_PointAreaNum(vec3_t point)
+{
+	floatint_t v[3];
+	aas_pointareacache_t *cache;
+
+	if (!aasworld.loaded)
+	{
+		botimport.Print(PRT_ERROR, "AAS_PointAreaNum: aas not loaded\n");
+		return 0;
+	} //end if
+
+	v[0].f = point[0];
+	v[1].f = point[1];
+	v[2].f = point[2];
+	cache = &pointareacache[((v[0].ui * 73856093u) ^ (v[1].ui * 19349663u) ^ (v[2].ui * 83492791u)) >>
+							(32 - AAS_POINTAREACACHE_BITS)];
+	if (cache->areanum >= 0 && VectorCompare(cache->point, point))
+	{
+		return cache->areanum;
+	} //end if
+	VectorCopy(point, cache->point);
+	cache->areanum = AAS_PointAreaNumFlat(point);
+	return cache->areanum;
 } //end of the function AAS_PointAreaNum
 //===========================================================================
+// returns the AAS area the point of the client is in, the origin of a bot
+// only moves a few units between lookups so the last one usually holds
+//
+// Parameter:				point	: point to find the area of
+//								client	: client asking, -1 for none
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+int AAS_ClientPointAreaNum(vec3_t point, int client)
+{
+	if (client < 0 || client >= MAX_CLIENTS) return AAS_PointAreaNum(point);
+	if (!aasworld.loaded)
+	{
+		botimport.Print(PRT_ERROR, "AAS_ClientPointAreaNum: aas not loaded\n");
+		return 0;
+	} //end if
+	return AAS_PointAreaNumCached(point, &clientpointareacache[client]);
+} //end of the function AAS_ClientPointAreaNum
+//===========================================================================
+// times one kind of query over the points, every test is repeated until it
+// ran long enough for Sys_MilliSeconds to give a usable per query time
+//
+// Parameter:				test			: AASBENCH_*
+//								points		: AAS_BENCHMARK_POINTS points
+//								numqueries	: number of queries per pass
+// Returns:					nanoseconds per query
+// Changes Globals:		-
+//===========================================================================
+#define AAS_BENCHMARK_POINTS		4096
+#define AAS_BENCHMARK_MSEC			250
+
+#define AASBENCH_TREE				0
+#define AASBENCH_FLAT				1
+#define AASBENCH_MEMO				2
+#define AASBENCH_MOVING				3
+#define AASBENCH_TRACEAREAS			4
+#define AASBENCH_TRACEBBOX			5
+
+static float AAS_TimePointQueries(int test, vec3_t *points, int numqueries)
+{
+	int i, start, elapsed, passes;
+	int areas[32];
+	volatile int sink;
+	vec3_t point;
+	aas_pointareacache_t cache;
+
+	cache.areanum = -1;
+	sink = 0;
+	start = Sys_MilliSeconds();
+	for (passes = 0; ; passes++)
+	{
+		elapsed = Sys_MilliSeconds() - start;
+		if (passes && elapsed >= AAS_BENCHMARK_MSEC) break;
+		switch(test)
+		{
+			case AASBENCH_TREE:
+				for (i = 0; i < numqueries; i++) sink += AAS_PointAreaNumTree(points[i & (AAS_BENCHMARK_POINTS - 1)]);
+				break;
+			case AASBENCH_FLAT:
+				for (i = 0; i < numqueries; i++) sink += AAS_PointAreaNumFlat(points[i & (AAS_BENCHMARK_POINTS - 1)]);
+				break;
+			case AASBENCH_MEMO:
+				//every point is asked for 8 times in a row like the origin of a bot during a think
+				for (i = 0; i < numqueries; i++) sink += AAS_PointAreaNum(points[(i >> 3) & (AAS_BENCHMARK_POINTS - 1)]);
+				break;
+			case AASBENCH_MOVING:
+				//a bot walking 2 units between lookups
+				for (i = 0; i < numqueries; i++)
+				{
+					VectorCopy(points[(i >> 3) & (AAS_BENCHMARK_POINTS - 1)], point);
+					point[0] += (i & 7) * 2;
+					sink += AAS_PointAreaNumCached(point, &cache);
+				} //end for
+				break;
+			case AASBENCH_TRACEAREAS:
+				for (i = 0; i < numqueries; i++)
+				{
+					sink += AAS_TraceAreas(points[i & (AAS_BENCHMARK_POINTS - 1)],
+											points[(i + 1) & (AAS_BENCHMARK_POINTS - 1)], areas, NULL, 32);
+				} //end for
+				break;
+			case AASBENCH_TRACEBBOX:
+				for (i = 0; i < numqueries; i++)
+				{
+					sink += AAS_TraceClientBBox(points[i & (AAS_BENCHMARK_POINTS - 1)],
+											points[(i + 1) & (AAS_BENCHMARK_POINTS - 1)], PRESENCE_NORMAL, ENTITYNUM_NONE).area;
+				} //end for
+				break;
+		} //end switch
+	} //end for
+	return elapsed * 1000000.0f / ((float) passes * numqueries);
+} //end of the function AAS_TimePointQueries
+//===========================================================================
+// times the point and trace queries on points inside random areas and
+// checks the flattened tree and the cached lookups against the original
+// nodes
+//
+// Parameter:				numqueries	: number of queries per pass
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void AAS_BenchmarkPointQueries(int numqueries)
+{
+	int i, j, areanum, mismatches, movingmismatches;
+	unsigned int seed;
+	vec3_t *points, point;
+	aas_area_t *area;
+	aas_pointareacache_t cache;
+
+	if (!aasworld.loaded || !aasworld.flatnodes || aasworld.numareas < 2) return;
+	if (numqueries < AAS_BENCHMARK_POINTS) numqueries = AAS_BENCHMARK_POINTS;
+	//the same points every run
+	points = (vec3_t *) GetMemory(AAS_BENCHMARK_POINTS * sizeof(vec3_t));
+	seed = 1;
+	for (i = 0; i < AAS_BENCHMARK_POINTS; i++)
+	{
+		seed = seed * 1103515245 + 12345;
+		areanum = 1 + (seed >> 8) % (aasworld.numareas - 1);
+		area = &aasworld.areas[areanum];
+		for (j = 0; j < 3; j++)
+		{
+			seed = seed * 1103515245 + 12345;
+			points[i][j] = area->mins[j] + (area->maxs[j] - area->mins[j]) * ((seed >> 8) & 0xffff) / 65535.0f;
+		} //end for
+	} //end for
+	mismatches = 0;
+	movingmismatches = 0;
+	cache.areanum = -1;
+	for (i = 0; i < AAS_BENCHMARK_POINTS; i++)
+	{
+		if (AAS_PointAreaNumTree(points[i]) != AAS_PointAreaNumFlat(points[i])) mismatches++;
+		for (j = 0; j < 8; j++)
+		{
+			VectorCopy(points[i], point);
+			point[0] += j * 2;
+			if (AAS_PointAreaNumCached(point, &cache) != AAS_PointAreaNumTree(point)) movingmismatches++;
+		} //end for
+	} //end for
+	botimport.Print(PRT_MESSAGE, "%d queries per pass, %d mismatches between tree and flattened nodes, "
+						"%d between tree and moving cache\n", numqueries, mismatches, movingmismatches);
+	botimport.Print(PRT_MESSAGE, "tree walk %.1f ns, flattened %.1f ns, memoized %.1f ns, moving bot %.1f ns per point query\n",
+						AAS_TimePointQueries(AASBENCH_TREE, points, numqueries),
+						AAS_TimePointQueries(AASBENCH_FLAT, points, numqueries),
+						AAS_TimePointQueries(AASBENCH_MEMO, points, numqueries),
+						AAS_TimePointQueries(AASBENCH_MOVING, points, numqueries));
+	botimport.Print(PRT_MESSAGE, "AAS_TraceAreas %.1f ns, AAS_TraceClientBBox %.1f ns per trace\n",
+						AAS_TimePointQueries(AASBENCH_TRACEAREAS, points, numqueries),
+						AAS_TimePointQueries(AASBENCH_TRACEBBOX, points, numqueries));
+	FreeMemory(points);
+} //end of the function AAS_BenchmarkPointQueries
+//===========================================================================
 //
 // Parameter:			-
 // Returns:				-
@@ -405,12 +731,27 @@ vec_t AAS_BoxOriginDistanceFromPlane(vec3_t normal, vec3_t mins, vec3_t maxs, in
 qboolean AAS_AreaEntityCollision(int areanum, vec3_t start, vec3_t end,
 										int presencetype, int passent, aas_trace_t *trace)
 {
-	int collision;
-	vec3_t boxmins, boxmaxs;
+	int collision, i;
+	vec3_t boxmins, boxmaxs, sweptmins, sweptmaxs;
 	aas_link_t *link;
+	aas_entity_t *ent;
 	bsp_trace_t bsptrace;
 
 	AAS_PresenceTypeBoundingBox(presencetype, boxmins, boxmaxs);
+	//bounds of the box moving from start to end
+	for (i = 0; i < 3; i++)
+	{
+		if (start[i] < end[i])
+		{
+			sweptmins[i] = start[i] + boxmins[i] - 1;
+			sweptmaxs[i] = end[i] + boxmaxs[i] + 1;
+		} //end if
+		else
+		{
+			sweptmins[i] = end[i] + boxmins[i] - 1;
+			sweptmaxs[i] = start[i] + boxmaxs[i] + 1;
+		} //end else
+	} //end for
 
 	Com_Memset(&bsptrace, 0, sizeof(bsp_trace_t)); //make compiler happy
 	//assume no collision
@@ -420,6 +761,15 @@ qboolean AAS_AreaEntityCollision(int areanum, vec3_t start, vec3_t end,
 	{
 		//ignore the pass entity
 		if (link->entnum == passent) continue;
+		//the entity is linked in every area its bounds touch, skip the
+		//engine trace if it's nowhere near this part of the line
+		ent = &aasworld.entities[link->entnum];
+		for (i = 0; i < 3; i++)
+		{
+			if (ent->i.origin[i] + ent->i.mins[i] > sweptmaxs[i]) break;
+			if (ent->i.origin[i] + ent->i.maxs[i] < sweptmins[i]) break;
+		} //end for
+		if (i < 3) continue;
 		//
 		if (AAS_EntityCollision(link->entnum, start, boxmins, boxmaxs, end,
 												CONTENTS_SOLID|CONTENTS_PLAYERCLIP, &bsptrace))
@@ -453,7 +803,7 @@ aas_trace_t AAS_TraceClientBBox(vec3_t start, vec3_t end, int presencetype,
 	vec3_t cur_start, cur_end, cur_mid, v1, v2;
 	aas_tracestack_t tracestack[127];
 	aas_tracestack_t *tstack_p;
-	aas_node_t *aasnode;
+	aas_flatnode_t *aasnode;
 	aas_plane_t *plane;
 	aas_trace_t trace;
 
@@ -597,42 +947,14 @@ aas_trace_t AAS_TraceClientBBox(vec3_t start, vec3_t end, int presencetype,
 		} //end if
 #endif //AAS_SAMPLE_DEBUG
 		//the node to test against
-		aasnode = &aasworld.nodes[nodenum];
+		aasnode = &aasworld.flatnodes[nodenum];
 		//start point of current line to test against node
 		VectorCopy(tstack_p->start, cur_start);
 		//end point of the current line to test against node
 		VectorCopy(tstack_p->end, cur_end);
-		//the current node plane
-		plane = &aasworld.planes[aasnode->planenum];
-
-		switch(plane->type)
-		{/*FIXME: wtf doesn't this work? obviously the axial node planes aren't always facing positive!!!
-			//check for axial planes
-			case PLANE_X:
-			{
-				front = cur_start[0] - plane->dist;
-				back = cur_end[0] - plane->dist;
-				break;
-			} //end case
-			case PLANE_Y:
-			{
-				front = cur_start[1] - plane->dist;
-				back = cur_end[1] - plane->dist;
-				break;
-			} //end case
-			case PLANE_Z:
-			{
-				front = cur_start[2] - plane->dist;
-				back = cur_end[2] - plane->dist;
-				break;
-			} //end case*/
-			default: //gee it's not an axial plane
-			{
-				front = DotProduct(cur_start, plane->normal) - plane->dist;
-				back = DotProduct(cur_end, plane->normal) - plane->dist;
-				break;
-			} //end default
-		} //end switch
+		//distances of the line end points to the node plane
+		front = DotProduct(cur_start, aasnode->normal) - aasnode->dist;
+		back = DotProduct(cur_end, aasnode->normal) - aasnode->dist;
 		// bk010221 - old location of FPE hack and divide by zero expression
 		//if the whole to be traced line is totally at the front of this node
 		//only go down the tree with the front child
@@ -730,8 +1052,7 @@ int AAS_TraceAreas(vec3_t start, vec3_t end, int *areas, vec3_t *points, int max
 	vec3_t cur_start, cur_end, cur_mid;
 	aas_tracestack_t tracestack[127];
 	aas_tracestack_t *tstack_p;
-	aas_node_t *aasnode;
-	aas_plane_t *plane;
+	aas_flatnode_t *aasnode;
 
 	numareas = 0;
 	areas[0] = 0;
@@ -788,42 +1109,14 @@ int AAS_TraceAreas(vec3_t start, vec3_t end, int *areas, vec3_t *points, int max
 		} //end if
 #endif //AAS_SAMPLE_DEBUG
 		//the node to test against
-		aasnode = &aasworld.nodes[nodenum];
+		aasnode = &aasworld.flatnodes[nodenum];
 		//start point of current line to test against node
 		VectorCopy(tstack_p->start, cur_start);
 		//end point of the current line to test against node
 		VectorCopy(tstack_p->end, cur_end);
-		//the current node plane
-		plane = &aasworld.planes[aasnode->planenum];
-
-		switch(plane->type)
-		{/*FIXME: wtf doesn't this work? obviously the node planes aren't always facing positive!!!
-			//check for axial planes
-			case PLANE_X:
-			{
-				front = cur_start[0] - plane->dist;
-				back = cur_end[0] - plane->dist;
-				break;
-			} //end case
-			case PLANE_Y:
-			{
-				front = cur_start[1] - plane->dist;
-				back = cur_end[1] - plane->dist;
-				break;
-			} //end case
-			case PLANE_Z:
-			{
-				front = cur_start[2] - plane->dist;
-				back = cur_end[2] - plane->dist;
-				break;
-			} //end case*/
-			default: //gee it's not an axial plane
-			{
-				front = DotProduct(cur_start, plane->normal) - plane->dist;
-				back = DotProduct(cur_end, plane->normal) - plane->dist;
-				break;
-			} //end default
-		} //end switch
+		//distances of the line end points to the node plane
+		front = DotProduct(cur_start, aasnode->normal) - aasnode->dist;
+		back = DotProduct(cur_end, aasnode->normal) - aasnode->dist;
 
 		//if the whole to be traced line is totally at the front of this node
 		//only go down the tree with the front child
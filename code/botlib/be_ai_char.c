@@ -139,6 +139,90 @@ void BotFreeCharacterStrings(bot_character_t *ch)
 	} //end for
 } //end of the function BotFreeCharacterStrings
 //========================================================================
+// cached characters store the characteristics followed by the string
+// values, the string pointers are offsets from the start plus one
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//========================================================================
+void BotWriteCharacterCache(char *cachefile, int checksum, bot_character_t *ch)
+{
+	int i, size, fixedsize;
+	char *copy, *ptr;
+	bot_character_t *cc;
+
+	fixedsize = sizeof(bot_character_t) + MAX_CHARACTERISTICS * sizeof(bot_characteristic_t);
+	size = fixedsize;
+	for (i = 0; i < MAX_CHARACTERISTICS; i++)
+	{
+		if (ch->c[i].type == CT_STRING) size += strlen(ch->c[i].value.string) + 1;
+	} //end for
+	copy = (char *) GetMemory(size);
+	Com_Memcpy(copy, ch, fixedsize);
+	cc = (bot_character_t *) copy;
+	//the block has room for one characteristic more than is ever used
+	Com_Memset(&cc->c[MAX_CHARACTERISTICS], 0, sizeof(bot_characteristic_t));
+	ptr = copy + fixedsize;
+	for (i = 0; i < MAX_CHARACTERISTICS; i++)
+	{
+		if (ch->c[i].type != CT_STRING) continue;
+		strcpy(ptr, ch->c[i].value.string);
+		cc->c[i].value.string = (char *) (size_t) (ptr - copy + 1);
+		ptr += strlen(ptr) + 1;
+	} //end for
+	PC_WriteScriptCache(cachefile, checksum, copy, size);
+	FreeMemory(copy);
+} //end of the function BotWriteCharacterCache
+//========================================================================
+// returns NULL if there is no valid cache, the strings are allocated one
+// by one like when the character is parsed
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//========================================================================
+bot_character_t *BotReadCharacterCache(char *cachefile, int checksum, char *charfile)
+{
+	int i, j, size, fixedsize;
+	size_t offset;
+	char *data, *string;
+	bot_character_t *ch;
+
+	data = (char *) PC_LoadScriptCache(cachefile, checksum, &size);
+	if (!data) return NULL;
+	fixedsize = sizeof(bot_character_t) + MAX_CHARACTERISTICS * sizeof(bot_characteristic_t);
+	if (size < fixedsize)
+	{
+		FreeMemory(data);
+		return NULL;
+	} //end if
+	ch = (bot_character_t *) GetClearedMemory(fixedsize);
+	Com_Memcpy(ch, data, fixedsize);
+	Com_Memset(&ch->c[MAX_CHARACTERISTICS], 0, sizeof(bot_characteristic_t));
+	for (i = 0; i < MAX_CHARACTERISTICS; i++)
+	{
+		if (ch->c[i].type != CT_STRING) continue;
+		offset = (size_t) ch->c[i].value.string;
+		if (offset <= (size_t) fixedsize || offset - 1 >= (size_t) size ||
+			!memchr(data + offset - 1, '\0', size - (offset - 1)))
+		{
+			//a broken cache is ignored, only free the strings allocated so far
+			for (j = i; j < MAX_CHARACTERISTICS; j++) ch->c[j].type = 0;
+			BotFreeCharacterStrings(ch);
+			FreeMemory(ch);
+			FreeMemory(data);
+			return NULL;
+		} //end if
+		string = data + offset - 1;
+		ch->c[i].value.string = GetMemory(strlen(string) + 1);
+		strcpy(ch->c[i].value.string, string);
+	} //end for
+	FreeMemory(data);
+	Q_strncpyz(ch->filename, charfile, sizeof(ch->filename));
+	return ch;
+} //end of the function BotReadCharacterCache
+//========================================================================
 //
 // Parameter:			-
 // Returns:				-
@@ -211,12 +295,19 @@ void BotDefaultCharacteristics(bot_character_t *ch, bot_character_t *defaultch)
 //===========================================================================
 bot_character_t *BotLoadCharacterFromFile(char *charfile, int skill)
 {
-	int indent, index, foundcharacter;
+	int indent, index, foundcharacter, checksum;
+	char cachefile[MAX_QPATH];
 	bot_character_t *ch;
 	source_t *source;
 	token_t token;
 
 	foundcharacter = qfalse;
+	//use the parsed character from the binary cache if the source didn't change
+	PC_SetBaseFolder(BOTFILESBASEFOLDER);
+	checksum = PC_SourceChecksum(charfile);
+	Com_sprintf(cachefile, sizeof(cachefile), "%s/cache/%s.%d.bin", BOTFILESBASEFOLDER, charfile, skill);
+	ch = BotReadCharacterCache(cachefile, checksum, charfile);
+	if (ch) return ch;
 	//a bot character is parsed in two phases
 	PC_SetBaseFolder(BOTFILESBASEFOLDER);
 	source = LoadSourceFile(charfile);
@@ -351,6 +442,7 @@ bot_character_t *BotLoadCharacterFromFile(char *charfile, int skill)
 		FreeMemory(ch);
 		return NULL;
 	} //end if
+	BotWriteCharacterCache(cachefile, checksum, ch);
 	return ch;
 } //end of the function BotLoadCharacterFromFile
 //===========================================================================
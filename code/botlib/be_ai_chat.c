@@ -2031,6 +2031,124 @@ void BotDumpInitialChat(bot_chat_t *chat)
 	Log_Write("}");
 } //end of the function BotDumpInitialChat
 //===========================================================================
+// cached chats store their pointers as offsets from the start of the chat
+// plus one, so NULL stays NULL
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void *BotChatCacheOffset(void *ptr, bot_chat_t *chat)
+{
+	if (!ptr) return NULL;
+	return (void *) ((char *) ptr - (char *) chat + 1);
+} //end of the function BotChatCacheOffset
+//===========================================================================
+// turns a cached offset back into a pointer, qfalse if the object of
+// objsize bytes doesn't fit in the cached block
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+int BotChatCachePointer(void **ptr, bot_chat_t *chat, int size, int objsize)
+{
+	size_t offset;
+
+	offset = (size_t) *ptr;
+	if (!offset) return qtrue;
+	if (offset - 1 > (size_t) size || (size_t) size - (offset - 1) < (size_t) objsize) return qfalse;
+	*ptr = (char *) chat + offset - 1;
+	return qtrue;
+} //end of the function BotChatCachePointer
+//===========================================================================
+// like BotChatCachePointer for a string that must end inside the block
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+int BotChatCacheString(char **ptr, bot_chat_t *chat, int size)
+{
+	size_t offset;
+
+	offset = (size_t) *ptr;
+	if (!offset || offset - 1 >= (size_t) size) return qfalse;
+	if (!memchr((char *) chat + offset - 1, '\0', size - (offset - 1))) return qfalse;
+	*ptr = (char *) chat + offset - 1;
+	return qtrue;
+} //end of the function BotChatCacheString
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void BotWriteChatCache(char *cachefile, int checksum, bot_chat_t *chat, int size)
+{
+	char *copy;
+	bot_chattype_t *t, *ct;
+	bot_chatmessage_t *m, *cm;
+
+	copy = (char *) GetMemory(size);
+	Com_Memcpy(copy, chat, size);
+	((bot_chat_t *) copy)->types = BotChatCacheOffset(chat->types, chat);
+	for (t = chat->types; t; t = t->next)
+	{
+		ct = (bot_chattype_t *) (copy + ((char *) t - (char *) chat));
+		ct->firstchatmessage = BotChatCacheOffset(t->firstchatmessage, chat);
+		ct->next = BotChatCacheOffset(t->next, chat);
+		for (m = t->firstchatmessage; m; m = m->next)
+		{
+			cm = (bot_chatmessage_t *) (copy + ((char *) m - (char *) chat));
+			cm->chatmessage = BotChatCacheOffset(m->chatmessage, chat);
+			cm->next = BotChatCacheOffset(m->next, chat);
+		} //end for
+	} //end for
+	PC_WriteScriptCache(cachefile, checksum, copy, size);
+	FreeMemory(copy);
+} //end of the function BotWriteChatCache
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+bot_chat_t *BotReadChatCache(char *cachefile, int checksum)
+{
+	int size, valid, numobjects, maxobjects;
+	bot_chat_t *chat;
+	bot_chattype_t *t;
+	bot_chatmessage_t *m;
+
+	chat = (bot_chat_t *) PC_LoadScriptCache(cachefile, checksum, &size);
+	if (!chat) return NULL;
+	//a corrupt cache could link the lists into a loop
+	numobjects = 0;
+	maxobjects = size / sizeof(bot_chatmessage_t);
+	valid = size >= (int) sizeof(bot_chat_t) &&
+			BotChatCachePointer((void **) &chat->types, chat, size, sizeof(bot_chattype_t));
+	for (t = valid ? chat->types : NULL; t && valid; t = t->next)
+	{
+		valid = ++numobjects <= maxobjects &&
+				BotChatCachePointer((void **) &t->firstchatmessage, chat, size, sizeof(bot_chatmessage_t)) &&
+				BotChatCachePointer((void **) &t->next, chat, size, sizeof(bot_chattype_t));
+		for (m = valid ? t->firstchatmessage : NULL; m && valid; m = m->next)
+		{
+			valid = ++numobjects <= maxobjects &&
+					BotChatCacheString(&m->chatmessage, chat, size) &&
+					BotChatCachePointer((void **) &m->next, chat, size, sizeof(bot_chatmessage_t));
+		} //end for
+	} //end for
+	//a broken cache is ignored and the chat parsed again
+	if (!valid)
+	{
+		FreeMemory(chat);
+		return NULL;
+	} //end if
+	return chat;
+} //end of the function BotReadChatCache
+//===========================================================================
 //
 // Parameter:				-
 // Returns:					-
@@ -2038,19 +2156,31 @@ void BotDumpInitialChat(bot_chat_t *chat)
 //===========================================================================
 bot_chat_t *BotLoadInitialChat(char *chatfile, char *chatname)
 {
-	int pass, foundchat, indent, size;
+	int pass, foundchat, indent, size, checksum, starttime;
 	char *ptr = NULL;
 	char chatmessagestring[MAX_MESSAGE_SIZE];
+	char cachefile[MAX_QPATH];
 	source_t *source;
 	token_t token;
 	bot_chat_t *chat = NULL;
 	bot_chattype_t *chattype = NULL;
 	bot_chatmessage_t *chatmessage = NULL;
-#ifdef DEBUG
-	int starttime;
 
 	starttime = Sys_MilliSeconds();
-#endif //DEBUG
+	//use the parsed chat from the binary cache if the source didn't change
+	PC_SetBaseFolder(BOTFILESBASEFOLDER);
+	checksum = PC_SourceChecksum(chatfile);
+	Com_sprintf(cachefile, sizeof(cachefile), "%s/cache/%s.%s.bin", BOTFILESBASEFOLDER, chatfile, chatname);
+	chat = BotReadChatCache(cachefile, checksum);
+	if (chat)
+	{
+		botimport.Print(PRT_MESSAGE, "loaded %s from %s (cached)\n", chatname, chatfile);
+		if (botDeveloper)
+		{
+			botimport.Print(PRT_MESSAGE, "initial chats loaded in %d msec\n", Sys_MilliSeconds() - starttime);
+		} //end if
+		return chat;
+	} //end if
 	//
 	size = 0;
 	foundchat = qfalse;
@@ -2199,9 +2329,12 @@ bot_chat_t *BotLoadInitialChat(char *chatfile, char *chatname)
 	{
 		BotCheckInitialChatIntegrety(chat);
 	} //end if
-#ifdef DEBUG
-	botimport.Print(PRT_MESSAGE, "initial chats loaded in %d msec\n", Sys_MilliSeconds() - starttime);
-#endif //DEBUG
+	//store the parsed chat for the next time it's loaded
+	BotWriteChatCache(cachefile, checksum, chat, size);
+	if (botDeveloper)
+	{
+		botimport.Print(PRT_MESSAGE, "initial chats loaded in %d msec\n", Sys_MilliSeconds() - starttime);
+	} //end if
 	//character was read succesfully
 	return chat;
 } //end of the function BotLoadInitialChat
@@ -266,9 +266,10 @@ void BotMutateGoalFuzzyLogic(int goalstate, float range)
 //===========================================================================
 itemconfig_t *LoadItemConfig(char *filename)
 {
-	int max_iteminfo;
+	int max_iteminfo, checksum, size, cachedsize;
 	token_t token;
 	char path[MAX_PATH];
+	char cachefile[MAX_QPATH];
 	source_t *source;
 	itemconfig_t *ic;
 	iteminfo_t *ii;
@@ -283,14 +284,29 @@ itemconfig_t *LoadItemConfig(char *filename)
 
 	strncpy( path, filename, MAX_PATH );
 	PC_SetBaseFolder(BOTFILESBASEFOLDER);
+	size = sizeof(itemconfig_t) + max_iteminfo * sizeof(iteminfo_t);
+	//use the parsed item config from the binary cache if the source didn't change
+	checksum = PC_SourceChecksum(path);
+	Com_sprintf(cachefile, sizeof(cachefile), "%s/cache/%s.bin", BOTFILESBASEFOLDER, path);
+	ic = (itemconfig_t *) PC_LoadScriptCache(cachefile, checksum, &cachedsize);
+	if (ic)
+	{
+		if (cachedsize == size && ic->numiteminfo >= 0 && ic->numiteminfo <= max_iteminfo)
+		{
+			ic->iteminfo = (iteminfo_t *) ((char *) ic + sizeof(itemconfig_t));
+			if (!com_quiet->integer)
+				botimport.Print(PRT_MESSAGE, "loaded %s (cached)\n", path);
+			return ic;
+		} //end if
+		FreeMemory(ic);
+	} //end if
 	source = LoadSourceFile( path );
 	if( !source ) {
 		botimport.Print( PRT_ERROR, "counldn't load %s\n", path );
 		return NULL;
 	} //end if
 	//initialize item config
-	ic = (itemconfig_t *) GetClearedHunkMemory(sizeof(itemconfig_t) +
-														max_iteminfo * sizeof(iteminfo_t));
+	ic = (itemconfig_t *) GetClearedHunkMemory(size);
 	ic->iteminfo = (iteminfo_t *) ((char *) ic + sizeof(itemconfig_t));
 	ic->numiteminfo = 0;
 	//parse the item config file
@@ -337,6 +353,8 @@ itemconfig_t *LoadItemConfig(char *filename)
 	if (!ic->numiteminfo) botimport.Print(PRT_WARNING, "no item info loaded\n");
 	if (!com_quiet->integer)
 		botimport.Print(PRT_MESSAGE, "loaded %s\n", path);
+	//store the parsed item config, the item info pointer is set again on load
+	PC_WriteScriptCache(cachefile, checksum, ic, size);
 	return ic;
 } //end of the function LoadItemConfig
 //===========================================================================
@@ -231,12 +231,14 @@ float AngleDiff(float ang1, float ang2)
         return diff;
 } //end of the function AngleDiff
 //===========================================================================
+// the area of the origin is looked up in the cache of the client, -1 for
+// a point that isn't the origin of a client
 //
 // Parameter:                   -
 // Returns:                             -
 // Changes Globals:             -
 //===========================================================================
-int BotFuzzyPointReachabilityArea(vec3_t origin)
+static int BotFuzzyClientReachabilityArea(vec3_t origin, int client)
 {
         int firstareanum, j, x, y, z;
         int areas[10], numareas, areanum, bestareanum;
@@ -244,7 +246,7 @@ int BotFuzzyPointReachabilityArea(vec3_t origin)
         vec3_t points[10], v, end;
 
         firstareanum = 0;
-        areanum = AAS_PointAreaNum(origin);
+        areanum = AAS_ClientPointAreaNum(origin, client);
         if (areanum)
         {
                 firstareanum = areanum;
@@ -289,6 +291,16 @@ int BotFuzzyPointReachabilityArea(vec3_t origin)
                 if (bestareanum) return bestareanum;
         } //end for
         return firstareanum;
+} //end of the function BotFuzzyClientReachabilityArea
+//===========================================================================
+//
+// Parameter:                   -
+// Returns:                             -
+// Changes Globals:             -
+//===========================================================================
+int BotFuzzyPointReachabilityArea(vec3_t origin)
+{
+        return BotFuzzyClientReachabilityArea(origin, -1);
 } //end of the function BotFuzzyPointReachabilityArea
 //===========================================================================
 //
@@ -313,7 +325,7 @@ int BotReachabilityArea(vec3_t origin, int client)
                 //if standing on the world the bot should be in a valid area
                 if (bsptrace.ent == ENTITYNUM_WORLD)
                 {
-                        return BotFuzzyPointReachabilityArea(origin);
+                        return BotFuzzyClientReachabilityArea(origin, client);
                 } //end if
 
                 modelnum = AAS_EntityModelindex(bsptrace.ent);
@@ -334,10 +346,10 @@ int BotReachabilityArea(vec3_t origin, int client)
                 //if the bot is swimming the bot should be in a valid area
                 if (AAS_Swimming(origin))
                 {
-                        return BotFuzzyPointReachabilityArea(origin);
+                        return BotFuzzyClientReachabilityArea(origin, client);
                 } //end if
                 //
-                areanum = BotFuzzyPointReachabilityArea(origin);
+                areanum = BotFuzzyClientReachabilityArea(origin, client);
                 //if the bot is in an area with reachabilities
                 if (areanum && AAS_AreaReachability(areanum)) return areanum;
                 //trace down till the ground is hit because the bot is standing on some other entity
@@ -353,7 +365,7 @@ int BotReachabilityArea(vec3_t origin, int client)
                 return BotFuzzyPointReachabilityArea(org);
         } //end if
         //
-        return BotFuzzyPointReachabilityArea(origin);
+        return BotFuzzyClientReachabilityArea(origin, client);
 } //end of the function BotReachabilityArea
 //===========================================================================
 // returns the reachability area the bot is in
@@ -1387,7 +1399,7 @@ bot_moveresult_t BotFinishTravel_Walk(bot_movestate_t *ms, aas_reachability_t *r
         //if not on the ground and changed areas... don't walk back!!
         //(doesn't seem to help)
         /*
-        ms->areanum = BotFuzzyPointReachabilityArea(ms->origin);
+        ms->areanum = BotFuzzyClientReachabilityArea(ms->origin, ms->client);
         if (ms->areanum == reach->areanum)
         {
 #ifdef DEBUG
@@ -3121,7 +3133,7 @@ void BotMoveToGoal(bot_moveresult_t *result, int movestate, bot_goal_t *goal, in
                                 else if (modeltype == MODELTYPE_FUNC_STATIC || modeltype == MODELTYPE_FUNC_DOOR)
                                 {
                                         // check if ontop of a door bridge ?
-                                        ms->areanum = BotFuzzyPointReachabilityArea(ms->origin);
+                                        ms->areanum = BotFuzzyClientReachabilityArea(ms->origin, ms->client);
                                         // if not in a reachability area
                                         if (!AAS_AreaReachability(ms->areanum))
                                         {
@@ -3153,7 +3165,7 @@ void BotMoveToGoal(bot_moveresult_t *result, int movestate, bot_goal_t *goal, in
                 AAS_ReachabilityFromNum(ms->lastreachnum, &lastreach);
                 //reachability area the bot is in
                 //ms->areanum = BotReachabilityArea(ms->origin, ((lastreach.traveltype & TRAVELTYPE_MASK) != TRAVEL_ELEVATOR));
-                ms->areanum = BotFuzzyPointReachabilityArea(ms->origin);
+                ms->areanum = BotFuzzyClientReachabilityArea(ms->origin, ms->client);
                 //
                 if ( !ms->areanum )
                 {
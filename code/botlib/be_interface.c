@@ -76,6 +76,8 @@ int botlibsetup = qfalse;
 //===========================================================================
 int Sys_MilliSeconds(void)
 {
+	//clock() is processor time, only fall back to it without the engine clock
+	if (botimport.MilliSeconds) return botimport.MilliSeconds();
 	return clock() * 1000 / CLOCKS_PER_SEC;
 } //end of the function Sys_MilliSeconds
 //===========================================================================
@@ -185,6 +185,8 @@ typedef struct botlib_import_s
 	void		(*BSPModelMinsMaxsOrigin)(int modelnum, vec3_t angles, vec3_t mins, vec3_t maxs, vec3_t origin);
 	//send a bot client command
 	void		(*BotClientCommand)(int client, char *command);
+	//real time in milliseconds, NULL if not available
+	int			(*MilliSeconds)(void);
 	//memory allocation
 	void		*(*GetMemory)(int size);		// allocate from Zone
 	void		(*FreeMemory)(void *ptr);		// free memory from Zone
@@ -196,6 +198,15 @@ typedef struct botlib_import_s
 	int			(*FS_Write)( const void *buffer, int len, fileHandle_t f );
 	void		(*FS_FCloseFile)( fileHandle_t f );
 	int			(*FS_Seek)( fileHandle_t f, long offset, int origin );
+	void		*(*FS_MapShared)( const char *qpath, int *length );	// read-only, NULL if not available
+	void		(*FS_UnmapShared)( void *data, int length );
+	//threads, NULL if not available
+	void		*(*CreateThread)( void (*function)( void *arg ), void *arg );
+	void		(*JoinThread)( void *thread );
+	void		*(*CreateSemaphore)( int count );
+	void		(*DestroySemaphore)( void *sem );
+	void		(*SemaphorePost)( void *sem );
+	qboolean	(*SemaphoreWait)( void *sem, int msec );	// msec < 0 waits forever
 	//debug visualisation stuff
 	int			(*DebugLineCreate)(void);
 	void		(*DebugLineDelete)(int line);
@@ -483,7 +494,9 @@ name:						default:			module(s):			description:
 "rs_maxjumpfallheight"		"450"				be_aas_move.c
 
 "max_aaslinks"				"4096"				be_aas_sample.c		maximum links in the AAS
-"max_routingcache"			"4096"				be_aas_route.c		maximum routing cache size in KB
+"max_routingcache"			"4096"				be_aas_route.c		routing cache slab size in KB, 0 = no limit
+"aasbenchmark"				"0"					be_aas_sample.c		time this many AAS point and trace queries
+"routingcachestats"			"0"					be_aas_main.c		print routing cache statistics
 "forceclustering"			"0"					be_aas_main.c		force recalculation of clusters
 "forcereachability"			"0"					be_aas_main.c		force recalculation of reachabilities
 "forcewrite"				"0"					be_aas_main.c		force writing of aas file
@@ -492,6 +505,7 @@ name:						default:			module(s):			description:
 "bot_visualizejumppads"		"0"					be_aas_reach.c		visualize jump pads
 
 "bot_reloadcharacters"		"0"					-					reload bot character files
+"scriptcache"				"1"					l_precomp.c			cache parsed chats and item configs in botfiles/cache
 "ai_gametype"				"0"					be_ai_goal.c		game type
 "droppedweight"				"1000"				be_ai_goal.c		additional dropped item weight
 "weapindex_rocketlauncher"	"5"					be_ai_move.c		rl weapon index for rocket jumping
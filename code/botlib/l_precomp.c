@@ -60,6 +60,7 @@ typedef enum {qfalse, qtrue}	qboolean;
 #include "l_script.h"
 #include "l_precomp.h"
 #include "l_log.h"
+#include "l_libvar.h"
 #endif //BOTLIB
 
 #ifdef MEQCC
@@ -3235,4 +3236,224 @@ void PC_CheckOpenSourceHandles(void)
 		} //end if
 	} //end for
 } //end of the function PC_CheckOpenSourceHandles
+#ifdef BOTLIB
+//============================================================================
+// binary cache of parsed script data
+//
+// the parsed data is stored with its internal pointers turned into offsets
+// and is only used while the checksum of the source file, the files it
+// includes and the global defines still matches
+//============================================================================
+
+#define SCRIPTCACHE_ID				(('P'<<24)+('C'<<16)+('S'<<8)+'B')
+#define SCRIPTCACHE_VERSION			2
+#define MAX_SCRIPTCACHE_INCLUDEDEPTH	8
+//32 bit FNV-1a
+#define SCRIPTCACHE_HASHSTART		2166136261u
+#define SCRIPTCACHE_HASHPRIME		16777619u
+
+typedef struct scriptcacheheader_s
+{
+	int ident;
+	int version;
+	int pointersize;						//size of the stored pointer offsets
+	int checksum;							//checksum of the source
+	int size;								//size of the cached data
+} scriptcacheheader_t;
+
+//============================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//============================================================================
+unsigned int PC_HashData(unsigned int hash, const void *data, int length)
+{
+	const byte *ptr;
+	int i;
+
+	ptr = (const byte *) data;
+	for (i = 0; i < length; i++)
+	{
+		hash = (hash ^ ptr[i]) * SCRIPTCACHE_HASHPRIME;
+	} //end for
+	return hash;
+} //end of the function PC_HashData
+//============================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//============================================================================
+unsigned int PC_HashString(unsigned int hash, const char *string)
+{
+	//the terminator is hashed too so "ab" "c" differs from "a" "bc"
+	return PC_HashData(hash, string, strlen(string) + 1);
+} //end of the function PC_HashString
+//============================================================================
+// hashes the contents of a script file and the files it includes with
+// #include "file" or #include <file>, directives in comments and strings
+// are skipped
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//============================================================================
+void PC_ChecksumScriptFile(const char *filename, unsigned int *hash, int *length, int depth)
+{
+	script_t *script;
+	char *ptr, *end, include[MAX_PATH];
+	int i;
 
+	script = LoadScriptFile(filename);
+	if (!script) return;
+	*hash = PC_HashData(*hash, &script->length, sizeof(int));
+	*hash = PC_HashData(*hash, script->buffer, script->length);
+	*length += script->length;
+	//also hash the included files
+	end = script->end_p;
+	for (ptr = script->buffer; ptr < end && depth < MAX_SCRIPTCACHE_INCLUDEDEPTH; ptr++)
+	{
+		//skip comments
+		if (ptr[0] == '/' && ptr + 1 < end && ptr[1] == '/')
+		{
+			while(ptr < end && *ptr != '\n') ptr++;
+			continue;
+		} //end if
+		if (ptr[0] == '/' && ptr + 1 < end && ptr[1] == '*')
+		{
+			for (ptr += 2; ptr + 1 < end && !(ptr[0] == '*' && ptr[1] == '/'); ptr++) ;
+			ptr++;
+			continue;
+		} //end if
+		//skip strings
+		if (*ptr == '"')
+		{
+			for (ptr++; ptr < end && *ptr != '"' && *ptr != '\n'; ptr++)
+			{
+				if (*ptr == '\\' && ptr + 1 < end) ptr++;
+			} //end for
+			continue;
+		} //end if
+		if (*ptr != '#') continue;
+		for (ptr++; ptr < end && (*ptr == ' ' || *ptr == '\t'); ptr++) ;
+		if (end - ptr < 7 || strncmp(ptr, "include", 7)) continue;
+		for (ptr += 7; ptr < end && (*ptr == ' ' || *ptr == '\t'); ptr++) ;
+		if (ptr >= end || (*ptr != '"' && *ptr != '<')) continue;
+		for (i = 0, ptr++; ptr < end && *ptr != '"' && *ptr != '>' && *ptr != '\n' && i < MAX_PATH-1; ptr++)
+		{
+			include[i++] = *ptr;
+		} //end for
+		include[i] = '\0';
+		PC_ConvertPath(include);
+		PC_ChecksumScriptFile(include, hash, length, depth + 1);
+	} //end for
+	FreeScript(script);
+} //end of the function PC_ChecksumScriptFile
+//============================================================================
+// returns 0 if the source file can't be loaded
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//============================================================================
+int PC_SourceChecksum(const char *filename)
+{
+	unsigned int hash;
+	int length;
+	define_t *define;
+	token_t *token;
+
+	hash = SCRIPTCACHE_HASHSTART;
+	length = 0;
+	PC_ChecksumScriptFile(filename, &hash, &length, 0);
+	if (!length) return 0;
+	//the global defines change what the source parses to
+	for (define = globaldefines; define; define = define->next)
+	{
+		hash = PC_HashString(hash, define->name);
+		hash = PC_HashData(hash, &define->numparms, sizeof(int));
+		for (token = define->parms; token; token = token->next)
+		{
+			hash = PC_HashString(hash, token->string);
+		} //end for
+		for (token = define->tokens; token; token = token->next)
+		{
+			hash = PC_HashData(hash, &token->type, sizeof(int));
+			hash = PC_HashString(hash, token->string);
+		} //end for
+	} //end for
+	//zero means no checksum
+	if (!hash) hash = 1;
+	return (int) hash;
+} //end of the function PC_SourceChecksum
+//============================================================================
+// returns the cached data allocated with GetMemory or NULL if there is no
+// cache for the given checksum
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//============================================================================
+void *PC_LoadScriptCache(const char *cachefile, int checksum, int *size)
+{
+	fileHandle_t fp;
+	scriptcacheheader_t header;
+	int length;
+	void *data;
+
+	if (!checksum || !LibVarValue("scriptcache", "1")) return NULL;
+	length = botimport.FS_FOpenFile(cachefile, &fp, FS_READ);
+	if (!fp) return NULL;
+	if (length < (int) sizeof(scriptcacheheader_t))
+	{
+		botimport.FS_FCloseFile(fp);
+		return NULL;
+	} //end if
+	if (botimport.FS_Read(&header, sizeof(scriptcacheheader_t), fp) != sizeof(scriptcacheheader_t) ||
+		header.ident != SCRIPTCACHE_ID ||
+		header.version != SCRIPTCACHE_VERSION ||
+		header.pointersize != sizeof(void *) ||
+		header.checksum != checksum ||
+		header.size <= 0 ||
+		header.size != length - (int) sizeof(scriptcacheheader_t))
+	{
+		botimport.FS_FCloseFile(fp);
+		return NULL;
+	} //end if
+	data = GetMemory(header.size);
+	//a short read is as good as no cache
+	if (botimport.FS_Read(data, header.size, fp) != header.size)
+	{
+		botimport.FS_FCloseFile(fp);
+		FreeMemory(data);
+		return NULL;
+	} //end if
+	botimport.FS_FCloseFile(fp);
+	*size = header.size;
+	return data;
+} //end of the function PC_LoadScriptCache
+//============================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//============================================================================
+void PC_WriteScriptCache(const char *cachefile, int checksum, void *data, int size)
+{
+	fileHandle_t fp;
+	scriptcacheheader_t header;
+
+	if (!checksum || !LibVarValue("scriptcache", "1")) return;
+	botimport.FS_FOpenFile(cachefile, &fp, FS_WRITE);
+	if (!fp) return;
+	header.ident = SCRIPTCACHE_ID;
+	header.version = SCRIPTCACHE_VERSION;
+	header.pointersize = sizeof(void *);
+	header.checksum = checksum;
+	header.size = size;
+	botimport.FS_Write(&header, sizeof(scriptcacheheader_t), fp);
+	botimport.FS_Write(data, size, fp);
+	botimport.FS_FCloseFile(fp);
+} //end of the function PC_WriteScriptCache
+#endif //BOTLIB
@@ -178,3 +178,12 @@ int PC_FreeSourceHandle(int handle);
 int PC_ReadTokenHandle(int handle, pc_token_t *pc_token);
 int PC_SourceFileAndLine(int handle, char *filename, int *line);
 void PC_CheckOpenSourceHandles(void);
+
+#ifdef BOTLIB
+//returns a checksum of a source file, the files it includes and the global defines
+int PC_SourceChecksum(const char *filename);
+//loads parsed data cached for a source with the given checksum
+void *PC_LoadScriptCache(const char *cachefile, int checksum, int *size);
+//stores parsed data for a source with the given checksum
+void PC_WriteScriptCache(const char *cachefile, int checksum, void *data, int size);
+#endif //BOTLIB
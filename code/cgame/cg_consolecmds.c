@@ -93,14 +93,16 @@ static void CG_ScoresDown_f( void ) {
 		// the scores are more than two seconds out of data,
 		// so request new ones
 		cg.scoresRequestTime = cg.time;
-		trap_SendClientCommand( "score" );
 
 		// leave the current scores up if they were already
 		// displayed, but if this is the first hit, clear them out
+		// and ask for a full board instead of a delta
 		if ( !cg.showScores ) {
 			cg.showScores = qtrue;
 			cg.numScores = 0;
+			cg.scoreSequence = 0;
 		}
+		trap_SendClientCommand( va( "score %i", cg.scoreSequence ) );
 	} else {
 		// show the cached contents even if they just pressed if it
 		// is within two seconds
@@ -533,6 +533,8 @@ typedef struct {
 
 	// scoreboard
 	int			scoresRequestTime;
+	int			scoreSequence;		// of the last dscores, what "score" deltas against
+	qboolean	scoreResync;		// asked for a full board after a dscores we couldn't apply
 	int			numScores;
 	int			selectedScore;
 	int			teamScores[2];
@@ -1481,6 +1483,7 @@ int			trap_Milliseconds( void );
 // console variable interaction
 void		trap_Cvar_Register( vmCvar_t *vmCvar, const char *varName, const char *defaultValue, int flags );
 void		trap_Cvar_Update( vmCvar_t *vmCvar );
+void		trap_Cvar_Generations( int *generations, int count );
 void		trap_Cvar_Set( const char *var_name, const char *value );
 void		trap_Cvar_VariableStringBuffer( const char *var_name, char *buffer, int bufsize );
 
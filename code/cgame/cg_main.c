@@ -318,6 +318,9 @@ static cvarTable_t cvarTable[] = {
 
 static int  cvarTableSize = sizeof( cvarTable ) / sizeof( cvarTable[0] );
 
+// kept current by the engine, see CG_CVAR_GENERATIONS
+static int	cvarGenerations[MAX_CVAR_HANDLES];
+
 /*
 =================
 CG_RegisterCvars
@@ -333,6 +336,8 @@ void CG_RegisterCvars( void ) {
 			cv->defaultString, cv->cvarFlags );
 	}
 
+	trap_Cvar_Generations( cvarGenerations, MAX_CVAR_HANDLES );
+
 	// see if we are also running the server on this machine
 	trap_Cvar_VariableStringBuffer( "sv_running", var, sizeof( var ) );
 	cgs.localServer = atoi( var );
@@ -374,6 +379,10 @@ void CG_UpdateCvars( void ) {
 	cvarTable_t	*cv;
 
 	for ( i = 0, cv = cvarTable ; i < cvarTableSize ; i++, cv++ ) {
+		if ( (unsigned)cv->vmCvar->handle < MAX_CVAR_HANDLES &&
+			cvarGenerations[cv->vmCvar->handle] == cv->vmCvar->modificationCount ) {
+			continue;
+		}
 		trap_Cvar_Update( cv->vmCvar );
 	}
 
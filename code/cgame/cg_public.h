@@ -182,7 +182,9 @@ typedef enum {
 	CG_CEIL,
 	CG_TESTPRINTINT,
 	CG_TESTPRINTFLOAT,
-	CG_ACOS
+	CG_ACOS,
+
+	CG_CVAR_GENERATIONS = 150	// ( int *generations, int count ), see G_CVAR_GENERATIONS
 } cgameImport_t;
 
 
@@ -58,6 +58,52 @@ static int CG_ValidOrder(const char *p) {
 }
 #endif
 
+#define	SCORE_FIELDS	14
+
+// the board dscores deltas are applied to, cg.scores is rebuilt from it
+static int	scoreRows[MAX_CLIENTS][SCORE_FIELDS];
+
+/*
+=================
+CG_SetScores
+
+Fills cg.scores from scoreRows
+=================
+*/
+static void CG_SetScores( void ) {
+	int		i;
+	int		*row;
+
+	memset( cg.scores, 0, sizeof( cg.scores ) );
+	for ( i = 0 ; i < cg.numScores ; i++ ) {
+		row = scoreRows[i];
+		cg.scores[i].client = row[0];
+		cg.scores[i].score = row[1];
+		cg.scores[i].ping = row[2];
+		cg.scores[i].time = row[3];
+		cg.scores[i].scoreFlags = row[4];
+		cg.scores[i].accuracy = row[6];
+		cg.scores[i].impressiveCount = row[7];
+		cg.scores[i].excellentCount = row[8];
+		cg.scores[i].guantletCount = row[9];
+		cg.scores[i].defendCount = row[10];
+		cg.scores[i].assistCount = row[11];
+		cg.scores[i].perfect = row[12];
+		cg.scores[i].captures = row[13];
+
+		if ( cg.scores[i].client < 0 || cg.scores[i].client >= MAX_CLIENTS ) {
+			cg.scores[i].client = 0;
+		}
+		cgs.clientinfo[ cg.scores[i].client ].score = cg.scores[i].score;
+		cgs.clientinfo[ cg.scores[i].client ].powerups = row[5];
+
+		cg.scores[i].team = cgs.clientinfo[cg.scores[i].client].team;
+	}
+#ifdef MISSIONPACK
+	CG_SetScoreSelection(NULL);
+#endif
+}
+
 /*
 =================
 CG_ParseScores
@@ -65,7 +111,7 @@ CG_ParseScores
 =================
 */
 static void CG_ParseScores( void ) {
-	int		i, powerups;
+	int		i, j;
 
 	cg.numScores = atoi( CG_Argv( 1 ) );
 	if ( cg.numScores > MAX_CLIENTS ) {
@@ -75,36 +121,70 @@ static void CG_ParseScores( void ) {
 	cg.teamScores[0] = atoi( CG_Argv( 2 ) );
 	cg.teamScores[1] = atoi( CG_Argv( 3 ) );
 
-	memset( cg.scores, 0, sizeof( cg.scores ) );
 	for ( i = 0 ; i < cg.numScores ; i++ ) {
-		//
-		cg.scores[i].client = atoi( CG_Argv( i * 14 + 4 ) );
-		cg.scores[i].score = atoi( CG_Argv( i * 14 + 5 ) );
-		cg.scores[i].ping = atoi( CG_Argv( i * 14 + 6 ) );
-		cg.scores[i].time = atoi( CG_Argv( i * 14 + 7 ) );
-		cg.scores[i].scoreFlags = atoi( CG_Argv( i * 14 + 8 ) );
-		powerups = atoi( CG_Argv( i * 14 + 9 ) );
-		cg.scores[i].accuracy = atoi(CG_Argv(i * 14 + 10));
-		cg.scores[i].impressiveCount = atoi(CG_Argv(i * 14 + 11));
-		cg.scores[i].excellentCount = atoi(CG_Argv(i * 14 + 12));
-		cg.scores[i].guantletCount = atoi(CG_Argv(i * 14 + 13));
-		cg.scores[i].defendCount = atoi(CG_Argv(i * 14 + 14));
-		cg.scores[i].assistCount = atoi(CG_Argv(i * 14 + 15));
-		cg.scores[i].perfect = atoi(CG_Argv(i * 14 + 16));
-		cg.scores[i].captures = atoi(CG_Argv(i * 14 + 17));
+		for ( j = 0 ; j < SCORE_FIELDS ; j++ ) {
+			scoreRows[i][j] = atoi( CG_Argv( i * SCORE_FIELDS + 4 + j ) );
+		}
+	}
 
-		if ( cg.scores[i].client < 0 || cg.scores[i].client >= MAX_CLIENTS ) {
-			cg.scores[i].client = 0;
+	// not something a dscores can be applied to
+	cg.scoreSequence = 0;
+	CG_SetScores();
+}
+
+/*
+=================
+CG_ParseDeltaScores
+
+dscores <sequence> <base> <numScores> <red> <blue> [<index> <fields>]...
+=================
+*/
+static void CG_ParseDeltaScores( void ) {
+	int		sequence, base, numScores;
+	int		i, j, index, argc;
+
+	sequence = atoi( CG_Argv( 1 ) );
+	base = atoi( CG_Argv( 2 ) );
+	if ( base && base != cg.scoreSequence ) {
+		// against a board we don't have, ask for all of it once
+		cg.scoreSequence = 0;
+		if ( !cg.scoreResync ) {
+			cg.scoreResync = qtrue;
+			trap_SendClientCommand( "score 0" );
 		}
-		cgs.clientinfo[ cg.scores[i].client ].score = cg.scores[i].score;
-		cgs.clientinfo[ cg.scores[i].client ].powerups = powerups;
+		return;
+	}
+	if ( !base ) {
+		cg.scoreResync = qfalse;
+	}
 
-		cg.scores[i].team = cgs.clientinfo[cg.scores[i].client].team;
+	numScores = atoi( CG_Argv( 3 ) );
+	if ( numScores < 0 ) {
+		numScores = 0;
+	} else if ( numScores > MAX_CLIENTS ) {
+		numScores = MAX_CLIENTS;
+	}
+	if ( !base ) {
+		memset( scoreRows, 0, sizeof( scoreRows ) );
 	}
-#ifdef MISSIONPACK
-	CG_SetScoreSelection(NULL);
-#endif
 
+	cg.teamScores[0] = atoi( CG_Argv( 4 ) );
+	cg.teamScores[1] = atoi( CG_Argv( 5 ) );
+
+	argc = trap_Argc();
+	for ( i = 6 ; i + SCORE_FIELDS < argc ; i += SCORE_FIELDS + 1 ) {
+		index = atoi( CG_Argv( i ) );
+		if ( index < 0 || index >= numScores ) {
+			continue;
+		}
+		for ( j = 0 ; j < SCORE_FIELDS ; j++ ) {
+			scoreRows[index][j] = atoi( CG_Argv( i + 1 + j ) );
+		}
+	}
+
+	cg.numScores = numScores;
+	cg.scoreSequence = sequence;
+	CG_SetScores();
 }
 
 /*
@@ -1054,6 +1134,11 @@ static void CG_ServerCommand( void ) {
 		return;
 	}
 
+	if ( !strcmp( cmd, "dscores" ) ) {
+		CG_ParseDeltaScores();
+		return;
+	}
+
 	if ( !strcmp( cmd, "scores" ) ) {
 		CG_ParseScores();
 		return;
@@ -103,4 +103,5 @@ equ	ceil						-109
 equ	testPrintInt				-110
 equ	testPrintFloat				-111
 equ acos						-112
+equ trap_Cvar_Generations		-151
 
@@ -62,6 +62,10 @@ void	trap_Cvar_Update( vmCvar_t *vmCvar ) {
 	syscall( CG_CVAR_UPDATE, vmCvar );
 }
 
+void	trap_Cvar_Generations( int *generations, int count ) {
+	syscall( CG_CVAR_GENERATIONS, generations, count );
+}
+
 void	trap_Cvar_Set( const char *var_name, const char *value ) {
 	syscall( CG_CVAR_SET, var_name, value );
 }
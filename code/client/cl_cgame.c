@@ -399,6 +399,7 @@ void CL_ShutdownCGame( void ) {
 				return;
 		}
 		VM_Call( cgvm, CG_SHUTDOWN );
+		Cvar_SetGenerations( CVAR_GEN_CGAME, NULL, 0 );
 		VM_Free( cgvm );
 		cgvm = NULL;
 }
@@ -417,6 +418,27 @@ The cgame module is making a system call
 ====================
 */
 intptr_t CL_CgameSystemCalls( intptr_t *args ) {
+		// while fast-forwarding a demo the cgame only runs to keep up
+		// with snapshots and commands, none of this would be seen or heard
+		if ( clc.demoSeeking ) {
+				switch( args[0] ) {
+				case CG_S_STARTSOUND:
+				case CG_S_STARTLOCALSOUND:
+				case CG_S_ADDLOOPINGSOUND:
+				case CG_S_ADDREALLOOPINGSOUND:
+				case CG_R_CLEARSCENE:
+				case CG_R_ADDREFENTITYTOSCENE:
+				case CG_R_ADDPOLYTOSCENE:
+				case CG_R_ADDPOLYSTOSCENE:
+				case CG_R_ADDLIGHTTOSCENE:
+				case CG_R_ADDADDITIVELIGHTTOSCENE:
+				case CG_R_RENDERSCENE:
+				case CG_R_SETCOLOR:
+				case CG_R_DRAWSTRETCHPIC:
+						return 0;
+				}
+		}
+
 		switch( args[0] ) {
 		case CG_PRINT:
 				Com_Printf( "%s", (const char*)VMA(1) );
@@ -432,6 +454,9 @@ intptr_t CL_CgameSystemCalls( intptr_t *args ) {
 		case CG_CVAR_UPDATE:
 				Cvar_Update( VMA(1) );
 				return 0;
+		case CG_CVAR_GENERATIONS:
+				Cvar_SetGenerations( CVAR_GEN_CGAME, VMA(1), VM_ArgCount( cgvm, args[1], args[2], sizeof( int ) ) );
+				return 0;
 		case CG_CVAR_SET:
 				Cvar_Set( VMA(1), VMA(2) );
 				return 0;
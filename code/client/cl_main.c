@@ -23,6 +23,7 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include "client.h"
 #include <limits.h>
+#include <stddef.h>
 #include "../ioq3-urt/ioq3-urt.h"
 extern cvar_t *com_quiet;
 #ifdef USE_MUMBLE
@@ -67,6 +68,8 @@ cvar_t  *cl_shownet;
 cvar_t  *cl_showSend;
 cvar_t  *cl_timedemo;
 cvar_t  *cl_timedemoLog;
+cvar_t  *cl_demoSeekInterval;
+cvar_t  *cl_demoSeekMemory;
 cvar_t  *cl_autoRecordDemo;
 cvar_t  *cl_aviFrameRate;
 cvar_t  *cl_aviMotionJpeg;
@@ -874,6 +877,233 @@ void CL_DemoCompleted( void )
         CL_NextDemo();
 }
 
+/*
+=================
+CL_DemoOpenCompressed
+=================
+*/
+static qboolean CL_DemoOpenCompressed( const char *name ) {
+        int                     size;
+
+        // reopen to get at the length, the file may live in a pk3
+        FS_FCloseFile( clc.demofile );
+        size = FS_FOpenFileRead( name, &clc.demofile, qtrue );
+        if ( !clc.demofile ) {
+                return qfalse;
+        }
+
+        if ( !DemoZ_Open( &clc.demoz, clc.demofile, size, name ) ) {
+                return qfalse;
+        }
+        clc.demoCompressed = qtrue;
+        return qtrue;
+}
+
+/*
+=================
+CL_DemoFreeCompressed
+=================
+*/
+static void CL_DemoFreeCompressed( void ) {
+        DemoZ_Free( &clc.demoz );
+        clc.demoCompressed = qfalse;
+}
+
+/*
+=================
+CL_DemoFreeSeekPoints
+=================
+*/
+static void CL_DemoFreeSeekPoints( void ) {
+        int                     i;
+
+        for ( i = 0; i < clc.demoNumSeekPoints; i++ ) {
+                Z_Free( clc.demoSeekPoints[i] );
+                clc.demoSeekPoints[i] = NULL;
+        }
+        clc.demoNumSeekPoints = 0;
+        clc.demoSeekThinned = 0;
+        clc.demoSeekMemory = 0;
+}
+
+/*
+=================
+CL_DemoThinSeekPoints
+
+Keep every other seek point and space new ones wider
+=================
+*/
+static void CL_DemoThinSeekPoints( void ) {
+        int                     i;
+
+        for ( i = 0; i < clc.demoNumSeekPoints; i++ ) {
+                if ( i & 1 ) {
+                        clc.demoSeekMemory -= clc.demoSeekPoints[i]->size;
+                        Z_Free( clc.demoSeekPoints[i] );
+                } else {
+                        clc.demoSeekPoints[i / 2] = clc.demoSeekPoints[i];
+                }
+                clc.demoSeekPoints[i] = NULL;
+        }
+        clc.demoNumSeekPoints = ( clc.demoNumSeekPoints + 1 ) / 2;
+        clc.demoSeekThinned++;
+}
+
+// clientActive_t up to the big arrays at its end is cached as is
+#define CL_SEEK_HEAD    offsetof( clientActive_t, snapshots )
+
+/*
+=================
+CL_DemoCacheSeekPoint
+
+Remember the client state every cl_demoSeekInterval msec of a
+plain demo.  Only taken once the cgame has run every server
+command, so the cached configstrings are complete.
+
+Only the baselines that were set and the parse entities a valid
+snapshot can still be delta'd from are kept, and the points are
+thinned out to stay under cl_demoSeekMemory and to leave at least
+half of the free zone memory to the rest of the client.
+=================
+*/
+static void CL_DemoCacheSeekPoint( void ) {
+        demoSeekPoint_t *p;
+        byte            *data;
+        int                     i, interval, size, limit, len;
+        int                     numBaselines, first, commandsSize;
+
+        if ( cl_demoSeekInterval->integer <= 0 || !cl.snap.valid ) {
+                return;
+        }
+        if ( clc.lastExecutedServerCommand != clc.serverCommandSequence ) {
+                return;
+        }
+
+        interval = cl_demoSeekInterval->integer << clc.demoSeekThinned;
+        if ( clc.demoNumSeekPoints ) {
+                p = clc.demoSeekPoints[clc.demoNumSeekPoints - 1];
+                if ( cl.snap.serverTime < p->serverTime + interval ) {
+                        return;
+                }
+        }
+
+        // entity 0 can't be told from an unset baseline, so it is always kept
+        numBaselines = 0;
+        for ( i = 0; i < MAX_GENTITIES; i++ ) {
+                if ( !i || cl.entityBaselines[i].number == i ) {
+                        numBaselines++;
+                }
+        }
+
+        first = cl.snap.parseEntitiesNum;
+        for ( i = 0; i < PACKET_BACKUP; i++ ) {
+                if ( cl.snapshots[i].valid && cl.snapshots[i].parseEntitiesNum < first ) {
+                        first = cl.snapshots[i].parseEntitiesNum;
+                }
+        }
+        if ( first < cl.parseEntitiesNum - MAX_PARSE_ENTITIES ) {
+                first = cl.parseEntitiesNum - MAX_PARSE_ENTITIES;
+        }
+
+        commandsSize = 0;
+        for ( i = 0; i < MAX_RELIABLE_COMMANDS; i++ ) {
+                commandsSize += strlen( clc.serverCommands[i] ) + 1;
+        }
+
+        size = sizeof( *p ) + CL_SEEK_HEAD + sizeof( cl.snapshots )
+                + ( numBaselines + cl.parseEntitiesNum - first ) * sizeof( entityState_t )
+                + commandsSize;
+
+        // out of room, keep every other point and space them wider
+        limit = cl_demoSeekMemory->integer * 1024 * 1024;
+        while ( clc.demoNumSeekPoints == MAX_DEMO_SEEKPOINTS
+                || ( limit > 0 && clc.demoNumSeekPoints > 1 && clc.demoSeekMemory + size > limit )
+                || ( clc.demoNumSeekPoints > 1 && size > Z_AvailableMemory() / 2 ) ) {
+                CL_DemoThinSeekPoints();
+        }
+        if ( limit > 0 && clc.demoSeekMemory + size > limit ) {
+                return;
+        }
+        if ( size > Z_AvailableMemory() / 2 ) {
+                return;
+        }
+
+        p = Z_Malloc( size );
+        p->offset = FS_FTell( clc.demofile );
+        p->serverMessageSequence = clc.serverMessageSequence;
+        p->serverCommandSequence = clc.serverCommandSequence;
+        p->lastExecutedServerCommand = clc.lastExecutedServerCommand;
+        p->serverTime = cl.snap.serverTime;
+        p->size = size;
+        p->numBaselines = numBaselines;
+        p->firstParseEntity = first;
+        p->numParseEntities = cl.parseEntitiesNum - first;
+
+        data = (byte *)( p + 1 );
+        Com_Memcpy( data, &cl, CL_SEEK_HEAD );
+        data += CL_SEEK_HEAD;
+        Com_Memcpy( data, cl.snapshots, sizeof( cl.snapshots ) );
+        data += sizeof( cl.snapshots );
+        for ( i = 0; i < MAX_GENTITIES; i++ ) {
+                if ( !i || cl.entityBaselines[i].number == i ) {
+                        Com_Memcpy( data, &cl.entityBaselines[i], sizeof( entityState_t ) );
+                        data += sizeof( entityState_t );
+                }
+        }
+        for ( i = first; i < cl.parseEntitiesNum; i++ ) {
+                Com_Memcpy( data, &cl.parseEntities[i & ( MAX_PARSE_ENTITIES - 1 )], sizeof( entityState_t ) );
+                data += sizeof( entityState_t );
+        }
+        for ( i = 0; i < MAX_RELIABLE_COMMANDS; i++ ) {
+                len = strlen( clc.serverCommands[i] ) + 1;
+                Com_Memcpy( data, clc.serverCommands[i], len );
+                data += len;
+        }
+
+        clc.demoSeekPoints[clc.demoNumSeekPoints++] = p;
+        clc.demoSeekMemory += p->size;
+}
+
+/*
+=================
+CL_DemoRestoreSeekPoint
+
+Put the state cached by CL_DemoCacheSeekPoint back into cl and clc
+=================
+*/
+static void CL_DemoRestoreSeekPoint( demoSeekPoint_t *p ) {
+        byte            *data;
+        entityState_t   *es;
+        int                     i, len;
+
+        Com_Memset( &cl, 0, sizeof( cl ) );
+
+        data = (byte *)( p + 1 );
+        Com_Memcpy( &cl, data, CL_SEEK_HEAD );
+        data += CL_SEEK_HEAD;
+        Com_Memcpy( cl.snapshots, data, sizeof( cl.snapshots ) );
+        data += sizeof( cl.snapshots );
+        for ( i = 0; i < p->numBaselines; i++ ) {
+                es = (entityState_t *)data;
+                Com_Memcpy( &cl.entityBaselines[es->number], es, sizeof( entityState_t ) );
+                data += sizeof( entityState_t );
+        }
+        for ( i = 0; i < p->numParseEntities; i++ ) {
+                Com_Memcpy( &cl.parseEntities[( p->firstParseEntity + i ) & ( MAX_PARSE_ENTITIES - 1 )],
+                        data, sizeof( entityState_t ) );
+                data += sizeof( entityState_t );
+        }
+        for ( i = 0; i < MAX_RELIABLE_COMMANDS; i++ ) {
+                len = strlen( (char *)data ) + 1;
+                Com_Memcpy( clc.serverCommands[i], data, len );
+                data += len;
+        }
+
+        clc.serverMessageSequence = p->serverMessageSequence;
+        clc.serverCommandSequence = p->serverCommandSequence;
+        clc.lastExecutedServerCommand = p->lastExecutedServerCommand;
+}
+
 /*
 =================
 CL_ReadDemoMessage
@@ -890,6 +1120,27 @@ void CL_ReadDemoMessage( void ) {
                 return;
         }
 
+        if ( cls.state == CA_ACTIVE ) {
+                if ( !clc.demoFirstServerTime ) {
+                        clc.demoFirstServerTime = cl.snap.serverTime;
+                }
+                if ( !clc.demoCompressed ) {
+                        CL_DemoCacheSeekPoint();
+                }
+        }
+
+        if ( clc.demoCompressed ) {
+                MSG_Init( &buf, bufData, sizeof( bufData ) );
+                if ( !DemoZ_ReadMessage( &clc.demoz, &buf, &clc.serverMessageSequence ) ) {
+                        CL_DemoCompleted ();
+                        return;
+                }
+                clc.lastPacketTime = cls.realtime;
+                buf.readcount = 0;
+                CL_ParseServerMessage( &buf );
+                return;
+        }
+
         // get the sequence number
         r = FS_Read( &s, 4, clc.demofile);
         if ( r != 4 ) {
@@ -972,6 +1223,15 @@ static int CL_WalkDemoExt(char *arg, char *name, int *demofile)
                 }
         }
 
+        Com_sprintf(name, MAX_OSPATH, "demos/%s.%s", arg, DEMOZ_EXT);
+        FS_FOpenFileRead( name, demofile, qtrue );
+
+        if (*demofile)
+        {
+                Com_Printf("Demo file: %s\n", name);
+                return PROTOCOL_VERSION;
+        }
+
         Com_Printf("Not found: %s\n", name);
 
         return -1;
@@ -1030,7 +1290,11 @@ void CL_PlayDemo_f( void ) {
         // check for an extension .DEMOEXT_?? (?? is protocol)
         ext_test = strrchr(arg, '.');
 
-        if (com_newdemoformat->integer) {
+        if(ext_test && !Q_stricmp(ext_test + 1, DEMOZ_EXT)) {
+                Com_sprintf(name, sizeof(name), "demos/%s", arg);
+                FS_FOpenFileRead(name, &clc.demofile, qtrue);
+                protocol = PROTOCOL_VERSION;
+        } else if (com_newdemoformat->integer) {
           if(ext_test && !Q_stricmpn(ext_test + 1, NEWDEMOEXT, ARRAY_LEN(NEWDEMOEXT) - 1)) {
                 Com_sprintf(name, sizeof(name), "demos/%s", arg);
                 FS_FOpenFileRead(name, &clc.demofile, qtrue);
@@ -1079,7 +1343,12 @@ void CL_PlayDemo_f( void ) {
         Q_strncpyz( clc.demoName, arg, sizeof( clc.demoName ) );
 
         Con_Close();
-        if (com_newdemoformat->integer) {
+        if (!Q_stricmp(COM_GetExtension(name), DEMOZ_EXT)) {
+          if (!CL_DemoOpenCompressed(name)) {
+                CL_DemoCompleted();
+                return;
+          }
+        } else if (com_newdemoformat->integer) {
           char *s1, *s2;
           int r, len;
 
@@ -1159,6 +1428,199 @@ void CL_PlayDemo_f( void ) {
 }
 
 
+/*
+====================
+CL_DemoSeekFrame
+
+Let the cgame catch up on snapshots and server commands at the
+current demo time.  Nothing it draws or plays reaches the screen
+or speakers while clc.demoSeeking is set.
+====================
+*/
+static void CL_DemoSeekFrame( void ) {
+        cl.serverTimeDelta = cl.snap.serverTime - cls.realtime;
+        cl.serverTime = cl.oldServerTime = cl.snap.serverTime;
+        CL_CGameRendering( STEREO_CENTER );
+}
+
+/*
+====================
+CL_DemoFastForward
+
+Parse demo messages up to the given server time without rendering,
+returns the number of messages read
+====================
+*/
+static int CL_DemoFastForward( int target ) {
+        int                     count;
+
+        clc.demoSeeking = qtrue;
+        for ( count = 0; cls.state == CA_ACTIVE && cl.snap.serverTime < target; count++ ) {
+                CL_ReadDemoMessage();
+
+                // don't let reliable commands cycle out before the cgame saw them
+                if ( clc.serverCommandSequence - clc.lastExecutedServerCommand >= MAX_RELIABLE_COMMANDS / 2 ) {
+                        CL_DemoSeekFrame();
+                }
+        }
+        if ( cls.state == CA_ACTIVE ) {
+                CL_DemoSeekFrame();
+        }
+        clc.demoSeeking = qfalse;
+
+        S_ClearSoundBuffer();
+        return count;
+}
+
+/*
+====================
+CL_DemoSeekKeyframe
+
+Restart a seekable demo at the keyframe of block n
+====================
+*/
+static qboolean CL_DemoSeekKeyframe( int n ) {
+        if ( !DemoZ_LoadBlock( &clc.demoz, n, qtrue ) ) {
+                return qfalse;
+        }
+
+        // the keyframe starts with a gamestate, so this is a fresh demo start
+        cls.state = CA_CONNECTED;
+        while ( cls.state >= CA_CONNECTED && cls.state < CA_PRIMED ) {
+                CL_ReadDemoMessage();
+        }
+
+        // and go active on its snapshot like CL_SetCGameTime would
+        while ( cls.state == CA_PRIMED ) {
+                CL_ReadDemoMessage();
+                if ( cl.newSnapshots ) {
+                        cl.newSnapshots = qfalse;
+                        CL_FirstSnapshot();
+                }
+        }
+        clc.firstDemoFrameSkipped = qtrue;
+        return cls.state == CA_ACTIVE;
+}
+
+/*
+====================
+CL_DemoSeekRestore
+
+Go back to the cached state of a plain demo at or before target.
+The cgame can't run backwards, so it is brought up again on top of it.
+====================
+*/
+static qboolean CL_DemoSeekRestore( int target ) {
+        demoSeekPoint_t *p;
+        int                     i;
+
+        for ( i = clc.demoNumSeekPoints - 1; i > 0; i-- ) {
+                if ( clc.demoSeekPoints[i]->serverTime <= target ) {
+                        break;
+                }
+        }
+        p = clc.demoSeekPoints[i];
+
+        FS_Seek( clc.demofile, p->offset, FS_SEEK_SET );
+
+        cls.state = CA_LOADING;
+        CL_FlushMemory();
+
+        CL_DemoRestoreSeekPoint( p );
+
+        cls.cgameStarted = qtrue;
+        CL_InitCGame();
+
+        cl.newSnapshots = qfalse;
+        CL_FirstSnapshot();
+        clc.firstDemoFrameSkipped = qtrue;
+        return cls.state == CA_ACTIVE;
+}
+
+/*
+====================
+CL_DemoSeek_f
+
+demoseek <[mm:]ss | +seconds | -seconds>
+
+Seeking forward parses the demo without drawing anything.  Seeking
+back restarts from a keyframe of a seekable demo, or from the nearest
+state cached every cl_demoSeekInterval msec of a plain one.
+====================
+*/
+void CL_DemoSeek_f( void ) {
+        char            *arg, *colon;
+        int                     target, i, start, count;
+
+        if ( Cmd_Argc() != 2 ) {
+                Com_Printf( "demoseek <[mm:]ss | +seconds | -seconds>\n" );
+                return;
+        }
+        if ( !clc.demoplaying || cls.state != CA_ACTIVE ) {
+                Com_Printf( "Not playing a demo.\n" );
+                return;
+        }
+
+        arg = Cmd_Argv( 1 );
+        if ( arg[0] == '+' || arg[0] == '-' ) {
+                target = cl.snap.serverTime + atof( arg ) * 1000;
+        } else if ( ( colon = strchr( arg, ':' ) ) != NULL ) {
+                target = clc.demoFirstServerTime + ( atoi( arg ) * 60 + atof( colon + 1 ) ) * 1000;
+        } else {
+                target = clc.demoFirstServerTime + atof( arg ) * 1000;
+        }
+
+        start = Sys_Milliseconds();
+
+        if ( clc.demoCompressed ) {
+                // keyframes are demoKeyframeMsec apart, so guess the block and fix
+                // up for the extra ones written when a block filled up early
+                i = ( target - clc.demoz.index[0].serverTime ) / clc.demoz.keyframeMsec;
+                if ( i >= clc.demoz.numBlocks ) {
+                        i = clc.demoz.numBlocks - 1;
+                }
+                if ( i < 0 ) {
+                        i = 0;
+                }
+                while ( i > 0 && clc.demoz.index[i].serverTime > target ) {
+                        i--;
+                }
+                while ( i + 1 < clc.demoz.numBlocks && clc.demoz.index[i + 1].serverTime <= target ) {
+                        i++;
+                }
+                while ( i > 0 && !clc.demoz.index[i].gamestateSize ) {
+                        i--;
+                }
+
+                // jump unless the keyframe is behind what is already parsed
+                if ( target < cl.snap.serverTime || i >= clc.demoz.blockNum ) {
+                        if ( !CL_DemoSeekKeyframe( i ) ) {
+                                CL_DemoCompleted();
+                                return;
+                        }
+                }
+        } else if ( target < cl.snap.serverTime ) {
+                if ( !clc.demoNumSeekPoints ) {
+                        Com_Printf( "Can't seek back in this demo, no state was cached (cl_demoSeekInterval, cl_demoSeekMemory).\n" );
+                        return;
+                }
+                if ( !CL_DemoSeekRestore( target ) ) {
+                        CL_DemoCompleted();
+                        return;
+                }
+        }
+
+        count = CL_DemoFastForward( target );
+        if ( cls.state != CA_ACTIVE ) {
+                return;
+        }
+
+        i = ( cl.snap.serverTime - clc.demoFirstServerTime ) / 1000;
+        Com_Printf( "Demo at %i:%02i, seek took %i msec, %i messages parsed\n",
+                i / 60, i % 60, Sys_Milliseconds() - start, count );
+}
+
+
 /*
 ====================
 CL_StartDemoLoop
@@ -1401,6 +1863,8 @@ void CL_Disconnect( qboolean showMainMenu ) {
                 FS_FCloseFile( clc.demofile );
                 clc.demofile = 0;
         }
+        CL_DemoFreeCompressed();
+        CL_DemoFreeSeekPoints();
 
         if ( uivm && showMainMenu ) {
                 VM_Call( uivm, UI_SET_ACTIVE_MENU, UIMENU_NONE );
@@ -3401,6 +3865,8 @@ void CL_Init( void ) {
 
         cl_timedemo = Cvar_Get ("timedemo", "0", 0);
         cl_timedemoLog = Cvar_Get ("cl_timedemoLog", "", CVAR_ARCHIVE);
+        cl_demoSeekInterval = Cvar_Get ("cl_demoSeekInterval", "30000", CVAR_ARCHIVE);
+        cl_demoSeekMemory = Cvar_Get ("cl_demoSeekMemory", "16", CVAR_ARCHIVE);
         cl_autoRecordDemo = Cvar_Get ("cl_autoRecordDemo", "0", CVAR_ARCHIVE);
         cl_aviFrameRate = Cvar_Get ("cl_aviFrameRate", "25", CVAR_ARCHIVE);
         cl_aviMotionJpeg = Cvar_Get ("cl_aviMotionJpeg", "1", CVAR_ARCHIVE);
@@ -3544,6 +4010,7 @@ void CL_Init( void ) {
         Cmd_AddCommand ("record", CL_Record_f);
         Cmd_AddCommand ("demo", CL_PlayDemo_f);
         Cmd_SetCommandCompletionFunc( "demo", CL_CompleteDemoName );
+        Cmd_AddCommand ("demoseek", CL_DemoSeek_f);
         Cmd_AddCommand ("cinematic", CL_PlayCinematic_f);
         Cmd_AddCommand ("stoprecord", CL_StopRecord_f);
         Cmd_AddCommand ("connect", CL_Connect_f);
@@ -3614,6 +4081,7 @@ void CL_Shutdown( char *finalmsg ) {
         Cmd_RemoveCommand ("disconnect");
         Cmd_RemoveCommand ("record");
         Cmd_RemoveCommand ("demo");
+        Cmd_RemoveCommand ("demoseek");
         Cmd_RemoveCommand ("cinematic");
         Cmd_RemoveCommand ("stoprecord");
         Cmd_RemoveCommand ("connect");
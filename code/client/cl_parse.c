@@ -53,35 +53,6 @@ MESSAGE PARSING
 =========================================================================
 */
 
-/*
-==================
-CL_DeltaEntity
-
-Parses deltas from the given base and adds the resulting entity
-to the current frame
-==================
-*/
-void CL_DeltaEntity (msg_t *msg, clSnapshot_t *frame, int newnum, entityState_t *old,
-                                         qboolean unchanged) {
-        entityState_t   *state;
-
-        // save the parsed entity state into the big circular buffer so
-        // it can be used as the source for a later delta
-        state = &cl.parseEntities[cl.parseEntitiesNum & (MAX_PARSE_ENTITIES-1)];
-
-        if ( unchanged ) {
-                *state = *old;
-        } else {
-                MSG_ReadDeltaEntity( msg, old, state, newnum );
-        }
-
-        if ( state->number == (MAX_GENTITIES-1) ) {
-                return;         // entity was delta removed
-        }
-        cl.parseEntitiesNum++;
-        frame->numEntities++;
-}
-
 /*
 ==================
 CL_ParsePacketEntities
@@ -89,104 +60,25 @@ CL_ParsePacketEntities
 ==================
 */
 void CL_ParsePacketEntities( msg_t *msg, clSnapshot_t *oldframe, clSnapshot_t *newframe) {
-        int                     newnum;
-        entityState_t   *oldstate;
-        int                     oldindex, oldnum;
+        parseEntities_t pe;
+        const char              *error;
 
-        newframe->parseEntitiesNum = cl.parseEntitiesNum;
-        newframe->numEntities = 0;
+        pe.entities = cl.parseEntities;
+        pe.mask = MAX_PARSE_ENTITIES - 1;
+        pe.num = cl.parseEntitiesNum;
+        pe.baselines = cl.entityBaselines;
 
-        // delta from the entities present in oldframe
-        oldindex = 0;
-        oldstate = NULL;
-        if (!oldframe) {
-                oldnum = 99999;
+        newframe->parseEntitiesNum = cl.parseEntitiesNum;
+        if ( oldframe ) {
+                error = MSG_ReadPacketEntities( msg, &pe, oldframe->parseEntitiesNum,
+                        oldframe->numEntities, &newframe->numEntities );
         } else {
-                if ( oldindex >= oldframe->numEntities ) {
-                        oldnum = 99999;
-                } else {
-                        oldstate = &cl.parseEntities[
-                                (oldframe->parseEntitiesNum + oldindex) & (MAX_PARSE_ENTITIES-1)];
-                        oldnum = oldstate->number;
-                }
+                error = MSG_ReadPacketEntities( msg, &pe, 0, 0, &newframe->numEntities );
         }
+        cl.parseEntitiesNum = pe.num;
 
-        while ( 1 ) {
-                // read the entity index number
-                newnum = MSG_ReadBits( msg, GENTITYNUM_BITS );
-
-                if ( newnum == (MAX_GENTITIES-1) ) {
-                        break;
-                }
-
-                if ( msg->readcount > msg->cursize ) {
-                        Com_Error (ERR_DROP,"CL_ParsePacketEntities: end of message");
-                }
-
-                while ( oldnum < newnum ) {
-                        // one or more entities from the old packet are unchanged
-                        if ( cl_shownet->integer == 3 ) {
-                                Com_Printf ("%3i:  unchanged: %i\n", msg->readcount, oldnum);
-                        }
-                        CL_DeltaEntity( msg, newframe, oldnum, oldstate, qtrue );
-
-                        oldindex++;
-
-                        if ( oldindex >= oldframe->numEntities ) {
-                                oldnum = 99999;
-                        } else {
-                                oldstate = &cl.parseEntities[
-                                        (oldframe->parseEntitiesNum + oldindex) & (MAX_PARSE_ENTITIES-1)];
-                                oldnum = oldstate->number;
-                        }
-                }
-                if (oldnum == newnum) {
-                        // delta from previous state
-                        if ( cl_shownet->integer == 3 ) {
-                                Com_Printf ("%3i:  delta: %i\n", msg->readcount, newnum);
-                        }
-                        CL_DeltaEntity( msg, newframe, newnum, oldstate, qfalse );
-
-                        oldindex++;
-
-                        if ( oldindex >= oldframe->numEntities ) {
-                                oldnum = 99999;
-                        } else {
-                                oldstate = &cl.parseEntities[
-                                        (oldframe->parseEntitiesNum + oldindex) & (MAX_PARSE_ENTITIES-1)];
-                                oldnum = oldstate->number;
-                        }
-                        continue;
-                }
-
-                if ( oldnum > newnum ) {
-                        // delta from baseline
-                        if ( cl_shownet->integer == 3 ) {
-                                Com_Printf ("%3i:  baseline: %i\n", msg->readcount, newnum);
-                        }
-                        CL_DeltaEntity( msg, newframe, newnum, &cl.entityBaselines[newnum], qfalse );
-                        continue;
-                }
-
-        }
-
-        // any remaining entities in the old frame are copied over
-        while ( oldnum != 99999 ) {
-                // one or more entities from the old packet are unchanged
-                if ( cl_shownet->integer == 3 ) {
-                        Com_Printf ("%3i:  unchanged: %i\n", msg->readcount, oldnum);
-                }
-                CL_DeltaEntity( msg, newframe, oldnum, oldstate, qtrue );
-
-                oldindex++;
-
-                if ( oldindex >= oldframe->numEntities ) {
-                        oldnum = 99999;
-                } else {
-                        oldstate = &cl.parseEntities[
-                                (oldframe->parseEntitiesNum + oldindex) & (MAX_PARSE_ENTITIES-1)];
-                        oldnum = oldstate->number;
-                }
+        if ( error ) {
+                Com_Error( ERR_DROP, "CL_ParsePacketEntities: %s", error );
         }
 }
 
@@ -654,12 +546,7 @@ CL_ParseGamestate
 ==================
 */
 void CL_ParseGamestate( msg_t *msg ) {
-        int                             i;
-        entityState_t   *es;
-        int                             newnum;
-        entityState_t   nullstate;
-        int                             cmd;
-        char                    *s;
+        const char              *error;
 
         Con_Close();
 
@@ -672,42 +559,9 @@ void CL_ParseGamestate( msg_t *msg ) {
         clc.serverCommandSequence = MSG_ReadLong( msg );
 
         // parse all the configstrings and baselines
-        cl.gameState.dataCount = 1;     // leave a 0 at the beginning for uninitialized configstrings
-        while ( 1 ) {
-                cmd = MSG_ReadByte( msg );
-
-                if ( cmd == svc_EOF ) {
-                        break;
-                }
-
-                if ( cmd == svc_configstring ) {
-                        int             len;
-
-                        i = MSG_ReadShort( msg );
-                        if ( i < 0 || i >= MAX_CONFIGSTRINGS ) {
-                                Com_Error( ERR_DROP, "configstring > MAX_CONFIGSTRINGS" );
-                        }
-                        s = MSG_ReadBigString( msg );
-                        len = strlen( s );
-                        if ( len + 1 + cl.gameState.dataCount > MAX_GAMESTATE_CHARS ) {
-                                Com_Error( ERR_DROP, "MAX_GAMESTATE_CHARS exceeded" );
-                        }
-
-                        // append it to the gameState string buffer
-                        cl.gameState.stringOffsets[ i ] = cl.gameState.dataCount;
-                        Com_Memcpy( cl.gameState.stringData + cl.gameState.dataCount, s, len + 1 );
-                        cl.gameState.dataCount += len + 1;
-                } else if ( cmd == svc_baseline ) {
-                        newnum = MSG_ReadBits( msg, GENTITYNUM_BITS );
-                        if ( newnum < 0 || newnum >= MAX_GENTITIES ) {
-                                Com_Error( ERR_DROP, "Baseline number out of range: %i", newnum );
-                        }
-                        Com_Memset (&nullstate, 0, sizeof(nullstate));
-                        es = &cl.entityBaselines[ newnum ];
-                        MSG_ReadDeltaEntity( msg, &nullstate, es, newnum );
-                } else {
-                        Com_Error( ERR_DROP, "CL_ParseGamestate: bad command byte 0x%02X",cmd );
-                }
+        error = MSG_ReadGamestate( msg, &cl.gameState, cl.entityBaselines );
+        if ( error ) {
+                Com_Error( ERR_DROP, "CL_ParseGamestate: %s", error );
         }
 
         clc.clientNum = MSG_ReadLong(msg);
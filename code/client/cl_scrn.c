@@ -597,11 +597,10 @@ void SCR_UpdateScreen( void ) {
                         SCR_DrawScreenField( STEREO_CENTER );
                 }
 
-                if ( com_speeds->integer ) {
-                        re.EndFrame( &time_frontend, &time_backend );
-                } else {
-                        re.EndFrame( NULL, NULL );
-                }
+                // the renderer only keeps msec, perfstats gets those too
+                re.EndFrame( &time_frontend, &time_backend );
+                Perf_Record( PERF_RENDER_FRONT, time_frontend * 1000 );
+                Perf_Record( PERF_RENDER_BACK, time_backend * 1000 );
         }
 
         recursive = 0;
@@ -147,6 +147,25 @@ typedef struct {
         entityState_t   parseEntities[MAX_PARSE_ENTITIES];
 } clientActive_t;
 
+// client state cached while playing a plain demo, so seeking
+// backwards only has to replay from the nearest one
+#define MAX_DEMO_SEEKPOINTS     64
+
+typedef struct {
+        int                     offset;                         // file position of the next message
+        int                     serverMessageSequence;
+        int                     serverCommandSequence;
+        int                     lastExecutedServerCommand;
+        int                     serverTime;                     // of cl.snap
+        int                     size;                           // bytes allocated for the point
+        int                     numBaselines;
+        int                     firstParseEntity;               // oldest one a valid snapshot refers to
+        int                     numParseEntities;
+        // followed by cl up to the snapshots, cl.snapshots, the baselines
+        // that were set, the parse entities from firstParseEntity on and
+        // the server commands as consecutive strings
+} demoSeekPoint_t;
+
 extern  clientActive_t          cl;
 
 /*
@@ -226,6 +245,17 @@ typedef struct {
         qboolean        firstDemoFrameSkipped;
         fileHandle_t    demofile;
 
+        // seekable demo container, see DEMOZ_MAGIC
+        qboolean        demoCompressed;
+        demozReader_t   demoz;
+
+        qboolean        demoSeeking;            // fast-forwarding, the cgame runs but draws nothing
+        int             demoFirstServerTime;
+        demoSeekPoint_t *demoSeekPoints[MAX_DEMO_SEEKPOINTS];
+        int             demoNumSeekPoints;
+        int             demoSeekThinned;        // times the seek points were halved to fit
+        int             demoSeekMemory;         // bytes held by the seek points
+
         int                     timeDemoFrames;         // counter of rendered frames
         int                     timeDemoStart;          // cls.realtime before first frame
         int                     timeDemoBaseTime;       // each frame will be at this time + frameNum * 50
@@ -405,6 +435,8 @@ extern  cvar_t  *m_side;
 extern  cvar_t  *m_filter;
 
 extern  cvar_t  *cl_timedemo;
+extern  cvar_t  *cl_demoSeekInterval;
+extern  cvar_t  *cl_demoSeekMemory;
 extern  cvar_t  *cl_aviFrameRate;
 extern  cvar_t  *cl_aviMotionJpeg;
 
@@ -68,6 +68,10 @@ int numbots;
 float floattime;
 //time to do a regular update
 float regularupdate_time;
+//bot think statistics since they were last printed
+int botthink_frames;
+int botthink_count;
+int botthink_msec;
 //
 int bot_interbreed;
 int bot_interbreedmatchcount;
@@ -75,6 +79,9 @@ int bot_interbreedmatchcount;
 vmCvar_t bot_thinktime;
 vmCvar_t bot_memorydump;
 vmCvar_t bot_saveroutingcache;
+vmCvar_t bot_routingcachestats;
+vmCvar_t bot_thinkstats;
+vmCvar_t bot_aasbenchmark;
 vmCvar_t bot_pause;
 vmCvar_t bot_report;
 vmCvar_t bot_testsolid;
@@ -1367,6 +1374,38 @@ int BotAILoadMap( int restart ) {
 	return qtrue;
 }
 
+/*
+==============
+BotPrintThinkStats
+==============
+*/
+void BotPrintThinkStats(void) {
+	float msec;
+	int frametime, thinktime, fps;
+
+	if (!botthink_frames || !botthink_count) {
+		BotAI_Print(PRT_MESSAGE, "no bot thinks yet\n");
+		return;
+	}
+	msec = (float) botthink_msec / botthink_count;
+	BotAI_Print(PRT_MESSAGE, "%d frames, %d thinks, %.1f thinks per frame\n",
+		botthink_frames, botthink_count, (float) botthink_count / botthink_frames);
+	//every bot thinks once per bot_thinktime but never more than once a server frame
+	fps = trap_Cvar_VariableIntegerValue("sv_fps");
+	frametime = fps > 0 ? 1000 / fps : 50;
+	thinktime = bot_thinktime.integer > frametime ? bot_thinktime.integer : frametime;
+	if (msec > 0) {
+		BotAI_Print(PRT_MESSAGE, "%.2f msec per think, about %d bots before thinking fills the frame\n",
+			msec, (int) (thinktime / msec));
+	}
+	else {
+		BotAI_Print(PRT_MESSAGE, "less than 1 msec spent thinking\n");
+	}
+	botthink_frames = 0;
+	botthink_count = 0;
+	botthink_msec = 0;
+}
+
 #ifdef MISSIONPACK
 void ProximityMine_Trigger( gentity_t *trigger, gentity_t *other, trace_t *trace );
 #endif
@@ -1377,7 +1416,7 @@ BotAIStartFrame
 ==================
 */
 int BotAIStartFrame(int time) {
-	int i;
+	int i, numthinks, thinkstart;
 	gentity_t	*ent;
 	bot_entitystate_t state;
 	int elapsed_time, thinktime;
@@ -1395,6 +1434,9 @@ int BotAIStartFrame(int time) {
 	trap_Cvar_Update(&bot_thinktime);
 	trap_Cvar_Update(&bot_memorydump);
 	trap_Cvar_Update(&bot_saveroutingcache);
+	trap_Cvar_Update(&bot_routingcachestats);
+	trap_Cvar_Update(&bot_thinkstats);
+	trap_Cvar_Update(&bot_aasbenchmark);
 	trap_Cvar_Update(&bot_pause);
 	trap_Cvar_Update(&bot_report);
 
@@ -1431,6 +1473,18 @@ int BotAIStartFrame(int time) {
 		trap_BotLibVarSet("saveroutingcache", "1");
 		trap_Cvar_Set("bot_saveroutingcache", "0");
 	}
+	if (bot_routingcachestats.integer) {
+		trap_BotLibVarSet("routingcachestats", "1");
+		trap_Cvar_Set("bot_routingcachestats", "0");
+	}
+	if (bot_thinkstats.integer) {
+		BotPrintThinkStats();
+		trap_Cvar_Set("bot_thinkstats", "0");
+	}
+	if (bot_aasbenchmark.integer) {
+		trap_BotLibVarSet("aasbenchmark", bot_aasbenchmark.string);
+		trap_Cvar_Set("bot_aasbenchmark", "0");
+	}
 	//check if bot interbreeding is activated
 	BotInterbreeding();
 	//cap the bot think time
@@ -1529,6 +1583,8 @@ int BotAIStartFrame(int time) {
 	floattime = trap_AAS_Time();
 
 	// execute scheduled bot AI
+	numthinks = 0;
+	thinkstart = trap_Milliseconds();
 	for( i = 0; i < MAX_CLIENTS; i++ ) {
 		if( !botstates[i] || !botstates[i]->inuse ) {
 			continue;
@@ -1543,9 +1599,13 @@ int BotAIStartFrame(int time) {
 
 			if (g_entities[i].client->pers.connected == CON_CONNECTED) {
 				BotAI(i, (float) thinktime / 1000);
+				numthinks++;
 			}
 		}
 	}
+	botthink_msec += trap_Milliseconds() - thinkstart;
+	botthink_count += numthinks;
+	botthink_frames++;
 
 
 	// execute bot user commands every frame
@@ -1587,6 +1647,9 @@ int BotInitLibrary(void) {
 	//maximum number of items in a level
 	trap_Cvar_VariableStringBuffer("max_levelitems", buf, sizeof(buf));
 	if (strlen(buf)) trap_BotLibVarSet("max_levelitems", buf);
+	//maximum routing cache size in KB
+	trap_Cvar_VariableStringBuffer("max_routingcache", buf, sizeof(buf));
+	if (strlen(buf)) trap_BotLibVarSet("max_routingcache", buf);
 	//game type
 	trap_Cvar_VariableStringBuffer("g_gametype", buf, sizeof(buf));
 	if (!strlen(buf)) strcpy(buf, "0");
@@ -1620,6 +1683,9 @@ int BotInitLibrary(void) {
 	trap_Cvar_VariableStringBuffer("bot_reloadcharacters", buf, sizeof(buf));
 	if (!strlen(buf)) strcpy(buf, "0");
 	trap_BotLibVarSet("bot_reloadcharacters", buf);
+	//use the binary cache of parsed bot files
+	trap_Cvar_VariableStringBuffer("bot_scriptcache", buf, sizeof(buf));
+	if (strlen(buf)) trap_BotLibVarSet("scriptcache", buf);
 	//base directory
 	trap_Cvar_VariableStringBuffer("fs_basepath", buf, sizeof(buf));
 	if (strlen(buf)) trap_BotLibVarSet("basedir", buf);
@@ -1648,6 +1714,9 @@ int BotAISetup( int restart ) {
 	trap_Cvar_Register(&bot_thinktime, "bot_thinktime", "100", CVAR_CHEAT);
 	trap_Cvar_Register(&bot_memorydump, "bot_memorydump", "0", CVAR_CHEAT);
 	trap_Cvar_Register(&bot_saveroutingcache, "bot_saveroutingcache", "0", CVAR_CHEAT);
+	trap_Cvar_Register(&bot_routingcachestats, "bot_routingcachestats", "0", 0);
+	trap_Cvar_Register(&bot_thinkstats, "bot_thinkstats", "0", 0);
+	trap_Cvar_Register(&bot_aasbenchmark, "bot_aasbenchmark", "0", CVAR_CHEAT);
 	trap_Cvar_Register(&bot_pause, "bot_pause", "0", CVAR_CHEAT);
 	trap_Cvar_Register(&bot_report, "bot_report", "0", CVAR_CHEAT);
 	trap_Cvar_Register(&bot_testsolid, "bot_testsolid", "0", CVAR_CHEAT);
@@ -24,10 +24,80 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include "../../ui/menudef.h"			// for the voice chats
 
+#define	SCORE_FIELDS	14
+
+// what each client was last sent with dscores
+typedef struct {
+	int		sequence;		// of the last dscores, 0 for none
+	int		firstSequence;	// of the last dscores sent against an empty board
+	int		numScores;
+	int		teamScores[2];
+	int		rows[MAX_CLIENTS][SCORE_FIELDS];
+} scoreboardView_t;
+
+static scoreboardView_t	scoreboardViews[MAX_CLIENTS];
+
+/*
+==================
+G_ScoreRow
+
+The fields of one scoreboard line
+==================
+*/
+static void G_ScoreRow( int clientNum, int *row ) {
+	gclient_t	*cl;
+	int			ping, accuracy, perfect;
+
+	cl = &level.clients[clientNum];
+
+	if ( cl->pers.connected == CON_CONNECTING ) {
+		ping = -1;
+	} else {
+		ping = cl->ps.ping < 999 ? cl->ps.ping : 999;
+	}
+
+	if( cl->accuracy_shots ) {
+		accuracy = cl->accuracy_hits * 100 / cl->accuracy_shots;
+	}
+	else {
+		accuracy = 0;
+	}
+	perfect = ( cl->ps.persistant[PERS_RANK] == 0 && cl->ps.persistant[PERS_KILLED] == 0 ) ? 1 : 0;
+
+	row[0] = clientNum;
+	row[1] = cl->ps.persistant[PERS_SCORE];
+	row[2] = ping;
+	row[3] = (level.time - cl->pers.enterTime)/60000;
+	row[4] = 0;		// scoreFlags
+	row[5] = g_entities[clientNum].s.powerups;
+	row[6] = accuracy;
+	row[7] = cl->ps.persistant[PERS_IMPRESSIVE_COUNT];
+	row[8] = cl->ps.persistant[PERS_EXCELLENT_COUNT];
+	row[9] = cl->ps.persistant[PERS_GAUNTLET_FRAG_COUNT];
+	row[10] = cl->ps.persistant[PERS_DEFEND_COUNT];
+	row[11] = cl->ps.persistant[PERS_ASSIST_COUNT];
+	row[12] = perfect;
+	row[13] = cl->ps.persistant[PERS_CAPTURES];
+}
+
+/*
+==================
+G_ScoreRowString
+==================
+*/
+static void G_ScoreRowString( char *entry, int size, const int *row ) {
+	Com_sprintf (entry, size,
+		" %i %i %i %i %i %i %i %i %i %i %i %i %i %i",
+		row[0], row[1], row[2], row[3], row[4], row[5], row[6],
+		row[7], row[8], row[9], row[10], row[11], row[12], row[13] );
+}
+
 /*
 ==================
 DeathmatchScoreboardMessage
 
+A full board replaces whatever dscores the client had, pushed
+boards stay full until the client asks for a delta again
 ==================
 */
 void DeathmatchScoreboardMessage( gentity_t *ent ) {
@@ -35,58 +105,143 @@ void DeathmatchScoreboardMessage( gentity_t *ent ) {
 	char		string[1400];
 	int			stringlength;
 	int			i, j;
-	gclient_t	*cl;
-	int			numSorted, scoreFlags, accuracy, perfect;
+	int			numSorted;
+	int			row[SCORE_FIELDS];
+
+	G_ResetScoreboardView( ent - g_entities );
 
 	// send the latest information on all clients
 	string[0] = 0;
 	stringlength = 0;
-	scoreFlags = 0;
 
 	numSorted = level.numConnectedClients;
 	
 	for (i=0 ; i < numSorted ; i++) {
-		int		ping;
+		G_ScoreRow( level.sortedClients[i], row );
+		G_ScoreRowString( entry, sizeof( entry ), row );
+		j = strlen(entry);
+		if (stringlength + j > 1024)
+			break;
+		strcpy (string + stringlength, entry);
+		stringlength += j;
+	}
 
-		cl = &level.clients[level.sortedClients[i]];
+	trap_SendServerCommand( ent-g_entities, va("scores %i %i %i%s", i, 
+		level.teamScores[TEAM_RED], level.teamScores[TEAM_BLUE],
+		string ) );
+}
 
-		if ( cl->pers.connected == CON_CONNECTING ) {
-			ping = -1;
-		} else {
-			ping = cl->ps.ping < 999 ? cl->ps.ping : 999;
-		}
+/*
+==================
+DeltaScoreboardMessage
+
+"dscores <sequence> <base> <numScores> <red> <blue>" followed by
+"<index>" and the fields of every line that differs from what the
+client got in dscores <base>, base 0 means against an empty board.
+Nothing is sent when the client's board would not change.
+Clients ask for these with "score <last sequence received>".
+Boards pushed while that request was on its way only chain onto
+what the client has, so any sequence since the last base 0 one
+still counts, the client will have the latest by the time the
+answer arrives.
+==================
+*/
+void DeltaScoreboardMessage( gentity_t *ent, int acknowledged ) {
+	scoreboardView_t	*view;
+	char		entry[1024];
+	char		string[1400];
+	int			stringlength;
+	int			i, j, base;
+	int			numSorted, changed;
+	int			row[SCORE_FIELDS];
 
-		if( cl->accuracy_shots ) {
-			accuracy = cl->accuracy_hits * 100 / cl->accuracy_shots;
-		}
-		else {
-			accuracy = 0;
+	view = &scoreboardViews[ent - g_entities];
+
+	// the client lost its board or missed a message, start over
+	if ( !acknowledged || !view->sequence
+		|| acknowledged < view->firstSequence || acknowledged > view->sequence ) {
+		view->numScores = 0;
+		base = 0;
+	} else {
+		base = view->sequence;
+	}
+
+	string[0] = 0;
+	stringlength = 0;
+	changed = 0;
+
+	numSorted = level.numConnectedClients;
+
+	for (i=0 ; i < numSorted ; i++) {
+		G_ScoreRow( level.sortedClients[i], row );
+		if ( i < view->numScores && !memcmp( row, view->rows[i], sizeof( row ) ) ) {
+			continue;
 		}
-		perfect = ( cl->ps.persistant[PERS_RANK] == 0 && cl->ps.persistant[PERS_KILLED] == 0 ) ? 1 : 0;
-
-		Com_sprintf (entry, sizeof(entry),
-			" %i %i %i %i %i %i %i %i %i %i %i %i %i %i", level.sortedClients[i],
-			cl->ps.persistant[PERS_SCORE], ping, (level.time - cl->pers.enterTime)/60000,
-			scoreFlags, g_entities[level.sortedClients[i]].s.powerups, accuracy, 
-			cl->ps.persistant[PERS_IMPRESSIVE_COUNT],
-			cl->ps.persistant[PERS_EXCELLENT_COUNT],
-			cl->ps.persistant[PERS_GAUNTLET_FRAG_COUNT], 
-			cl->ps.persistant[PERS_DEFEND_COUNT], 
-			cl->ps.persistant[PERS_ASSIST_COUNT], 
-			perfect,
-			cl->ps.persistant[PERS_CAPTURES]);
+		Com_sprintf( entry, sizeof( entry ), " %i", i );
+		j = strlen( entry );
+		G_ScoreRowString( entry + j, sizeof( entry ) - j, row );
 		j = strlen(entry);
 		if (stringlength + j > 1024)
 			break;
 		strcpy (string + stringlength, entry);
 		stringlength += j;
+		memcpy( view->rows[i], row, sizeof( row ) );
+		changed++;
 	}
 
-	trap_SendServerCommand( ent-g_entities, va("scores %i %i %i%s", i, 
+	if ( base && !changed && i == view->numScores
+		&& view->teamScores[0] == level.teamScores[TEAM_RED]
+		&& view->teamScores[1] == level.teamScores[TEAM_BLUE] ) {
+		return;
+	}
+
+	view->numScores = i;
+	view->teamScores[0] = level.teamScores[TEAM_RED];
+	view->teamScores[1] = level.teamScores[TEAM_BLUE];
+	view->sequence++;
+	if ( !view->sequence ) {
+		view->sequence = 1;
+	}
+	if ( !base ) {
+		view->firstSequence = view->sequence;
+	}
+
+	trap_SendServerCommand( ent-g_entities, va("dscores %i %i %i %i %i%s", view->sequence, base, i,
 		level.teamScores[TEAM_RED], level.teamScores[TEAM_BLUE],
 		string ) );
 }
 
+/*
+==================
+G_ScoreboardMessage
+
+Pushed scoreboards go out as deltas to clients that asked for them
+before, reliable commands arrive in order so the last one sent is
+what the client will have when this one arrives
+==================
+*/
+void G_ScoreboardMessage( gentity_t *ent ) {
+	scoreboardView_t	*view;
+
+	view = &scoreboardViews[ent - g_entities];
+	if ( view->sequence ) {
+		DeltaScoreboardMessage( ent, view->sequence );
+	} else {
+		DeathmatchScoreboardMessage( ent );
+	}
+}
+
+/*
+==================
+G_ResetScoreboardView
+
+A new client has nothing to delta against
+==================
+*/
+void G_ResetScoreboardView( int clientNum ) {
+	memset( &scoreboardViews[clientNum], 0, sizeof( scoreboardViews[clientNum] ) );
+}
+
 
 /*
 ==================
@@ -96,7 +251,15 @@ Request current scoreboard information
 ==================
 */
 void Cmd_Score_f( gentity_t *ent ) {
-	DeathmatchScoreboardMessage( ent );
+	char	arg[MAX_TOKEN_CHARS];
+
+	if ( trap_Argc() < 2 ) {
+		DeathmatchScoreboardMessage( ent );
+		return;
+	}
+
+	trap_Argv( 1, arg, sizeof( arg ) );
+	DeltaScoreboardMessage( ent, atoi( arg ) );
 }
 
 
@@ -430,6 +430,7 @@ void Touch_Item (gentity_t *ent, gentity_t *other, trace_t *trace) {
 	}
 
 	G_LogPrintf( "Item: %i %s\n", other->s.number, ent->item->classname );
+	G_LogEvent( GEV_ITEM, ent->item->classname, 2, other->s.number, ent->item - bg_itemlist );
 
 	predict = other->client->pers.predictItemPickup;
 
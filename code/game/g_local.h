@@ -339,6 +339,12 @@ typedef struct {
 	int			gentitySize;
 	int			num_entities;		// current number, <= MAX_GENTITIES
 
+	// freed entities in the order they were freed, so also by freetime,
+	// see G_Spawn.  0 is the end of the queue, nothing below MAX_CLIENTS
+	// is ever in it
+	int			freeHead, freeTail;
+	int			freeNext[MAX_GENTITIES];	// -1 for the last one, 0 when not queued
+
 	int			warmupTime;			// restart match at this time
 
 	fileHandle_t	logFile;
@@ -467,6 +473,9 @@ int		G_SoundIndex( char *name );
 void	G_TeamCommand( team_t team, char *cmd );
 void	G_KillBox (gentity_t *ent);
 gentity_t *G_Find (gentity_t *from, int fieldofs, const char *match);
+void	G_InitEntityIndex( void );
+void	G_ReindexEntity( gentity_t *ent );
+void	G_FindStats( int *calls, int *compares, int *frames, qboolean reset );
 gentity_t *G_PickTarget (char *targetname);
 void	G_UseTargets (gentity_t *ent, gentity_t *activator);
 void	G_SetMovedir ( vec3_t angles, vec3_t movedir);
@@ -606,6 +615,9 @@ void G_StartKamikaze( gentity_t *ent );
 void MoveClientToIntermission (gentity_t *client);
 void G_SetStats (gentity_t *ent);
 void DeathmatchScoreboardMessage (gentity_t *client);
+void DeltaScoreboardMessage( gentity_t *ent, int acknowledged );
+void G_ScoreboardMessage( gentity_t *ent );
+void G_ResetScoreboardView( int clientNum );
 
 //
 // g_cmds.c
@@ -624,6 +636,7 @@ void SetLeader(int team, int client);
 void CheckTeamLeader( int team );
 void G_RunThink (gentity_t *ent);
 void QDECL G_LogPrintf( const char *fmt, ... );
+void QDECL G_LogEvent( gameEvent_t type, const char *text, int numArgs, ... );
 void SendScoreboardMessageToAllClients( void );
 void QDECL G_Printf( const char *fmt, ... );
 void QDECL G_Error( const char *fmt, ... );
@@ -764,6 +777,8 @@ extern	vmCvar_t	g_enableDust;
 extern	vmCvar_t	g_enableBreath;
 extern	vmCvar_t	g_singlePlayer;
 extern	vmCvar_t	g_proxMineTimeout;
+extern	vmCvar_t	g_entityIndex;
+extern	vmCvar_t	g_antilag;
 
 void	trap_Printf( const char *fmt );
 void	trap_Error( const char *fmt );
@@ -778,9 +793,11 @@ void	trap_FS_Write( const void *buffer, int len, fileHandle_t f );
 void	trap_FS_FCloseFile( fileHandle_t f );
 int		trap_FS_GetFileList( const char *path, const char *extension, char *listbuf, int bufsize );
 int		trap_FS_Seek( fileHandle_t f, long offset, int origin ); // fsOrigin_t
+void	trap_LogEvent( int type, const int *args, int numArgs, const char *text ); // gameEvent_t
 void	trap_SendConsoleCommand( int exec_when, const char *text );
 void	trap_Cvar_Register( vmCvar_t *cvar, const char *var_name, const char *value, int flags );
 void	trap_Cvar_Update( vmCvar_t *cvar );
+void	trap_Cvar_Generations( int *generations, int count );
 void	trap_Cvar_Set( const char *var_name, const char *value );
 int		trap_Cvar_VariableIntegerValue( const char *var_name );
 float	trap_Cvar_VariableValue( const char *var_name );
@@ -795,6 +812,7 @@ void	trap_SetUserinfo( int num, const char *buffer );
 void	trap_GetServerinfo( char *buffer, int bufferSize );
 void	trap_SetBrushModel( gentity_t *ent, const char *name );
 void	trap_Trace( trace_t *results, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int passEntityNum, int contentmask );
+void	trap_TraceAtTime( trace_t *results, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int passEntityNum, int contentmask, int time );
 int		trap_PointContents( const vec3_t point, int passEntityNum );
 qboolean trap_InPVS( const vec3_t p1, const vec3_t p2 );
 qboolean trap_InPVSIgnorePortals( const vec3_t p1, const vec3_t p2 );
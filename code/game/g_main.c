@@ -81,6 +81,8 @@ vmCvar_t	pmove_fixed;
 vmCvar_t	pmove_msec;
 vmCvar_t	g_rankings;
 vmCvar_t	g_listEntity;
+vmCvar_t	g_entityIndex;
+vmCvar_t	g_antilag;
 #ifdef MISSIONPACK
 vmCvar_t	g_obeliskHealth;
 vmCvar_t	g_obeliskRegenPeriod;
@@ -157,6 +159,8 @@ static cvarTable_t		gameCvarTable[] = {
 
 	{ &g_allowVote, "g_allowVote", "1", CVAR_ARCHIVE, 0, qfalse },
 	{ &g_listEntity, "g_listEntity", "0", 0, 0, qfalse },
+	{ &g_entityIndex, "g_entityIndex", "1", 0, 0, qfalse },
+	{ &g_antilag, "g_antilag", "0", CVAR_SERVERINFO | CVAR_ARCHIVE, 0, qfalse },
 
 #ifdef MISSIONPACK
 	{ &g_obeliskHealth, "g_obeliskHealth", "2500", 0, 0, qfalse },
@@ -306,6 +310,8 @@ void G_FindTeams( void ) {
 				if ( e2->targetname ) {
 					e->targetname = e2->targetname;
 					e2->targetname = NULL;
+					G_ReindexEntity( e );
+					G_ReindexEntity( e2 );
 				}
 			}
 		}
@@ -329,6 +335,9 @@ void G_RemapTeamShaders( void ) {
 }
 
 
+// kept current by the engine, see G_CVAR_GENERATIONS
+static int	cvarGenerations[MAX_CVAR_HANDLES];
+
 /*
 =================
 G_RegisterCvars
@@ -350,6 +359,8 @@ void G_RegisterCvars( void ) {
 		}
 	}
 
+	trap_Cvar_Generations( cvarGenerations, MAX_CVAR_HANDLES );
+
 	if (remapped) {
 		G_RemapTeamShaders();
 	}
@@ -375,6 +386,10 @@ void G_UpdateCvars( void ) {
 
 	for ( i = 0, cv = gameCvarTable ; i < gameCvarTableSize ; i++, cv++ ) {
 		if ( cv->vmCvar ) {
+			if ( (unsigned)cv->vmCvar->handle < MAX_CVAR_HANDLES &&
+				cvarGenerations[cv->vmCvar->handle] == cv->vmCvar->modificationCount ) {
+				continue;
+			}
 			trap_Cvar_Update( cv->vmCvar );
 
 			if ( cv->modificationCount != cv->vmCvar->modificationCount ) {
@@ -444,12 +459,14 @@ void G_InitGame( int levelTime, int randomSeed, int restart ) {
 	} else {
 		G_Printf( "Not logging to disk.\n" );
 	}
+	G_LogEvent( GEV_ROUND, NULL, 1, ROUNDEVENT_START );
 
 	G_InitWorldSession();
 
 	// initialize all entities for this game
 	memset( g_entities, 0, MAX_GENTITIES * sizeof(g_entities[0]) );
 	level.gentities = g_entities;
+	G_InitEntityIndex();
 
 	// initialize all clients for this game
 	level.maxclients = g_maxclients.integer;
@@ -750,15 +767,21 @@ CalculateRanks
 Recalculates the score ranks of all players
 This will be called on every client connect, begin, disconnect, death,
 and team change.
+
+The previous order is kept and only fixed up with an insertion sort,
+a score change usually moves one client by a place or two
 ============
 */
 void CalculateRanks( void ) {
-	int		i;
+	int		i, j, k;
 	int		rank;
 	int		score;
 	int		newScore;
+	int		previous;
+	qboolean	present[MAX_CLIENTS];
 	gclient_t	*cl;
 
+	previous = level.numConnectedClients;
 	level.follow1 = -1;
 	level.follow2 = -1;
 	level.numConnectedClients = 0;
@@ -770,7 +793,6 @@ void CalculateRanks( void ) {
 	}
 	for ( i = 0 ; i < level.maxclients ; i++ ) {
 		if ( level.clients[i].pers.connected != CON_DISCONNECTED ) {
-			level.sortedClients[level.numConnectedClients] = i;
 			level.numConnectedClients++;
 
 			if ( level.clients[i].sess.sessionTeam != TEAM_SPECTATOR ) {
@@ -796,8 +818,29 @@ void CalculateRanks( void ) {
 		}
 	}
 
-	qsort( level.sortedClients, level.numConnectedClients, 
-		sizeof(level.sortedClients[0]), SortRanks );
+	// drop the clients that left, then append the ones that joined
+	memset( present, 0, sizeof( present ) );
+	k = 0;
+	for ( i = 0 ; i < previous ; i++ ) {
+		j = level.sortedClients[i];
+		if ( j < level.maxclients && !present[j] && level.clients[j].pers.connected != CON_DISCONNECTED ) {
+			present[j] = qtrue;
+			level.sortedClients[k++] = j;
+		}
+	}
+	for ( i = 0 ; i < level.maxclients ; i++ ) {
+		if ( !present[i] && level.clients[i].pers.connected != CON_DISCONNECTED ) {
+			level.sortedClients[k++] = i;
+		}
+	}
+
+	for ( i = 1 ; i < level.numConnectedClients ; i++ ) {
+		j = level.sortedClients[i];
+		for ( k = i ; k > 0 && SortRanks( &level.sortedClients[k-1], &j ) > 0 ; k-- ) {
+			level.sortedClients[k] = level.sortedClients[k-1];
+		}
+		level.sortedClients[k] = j;
+	}
 
 	// set the rank value for all clients that are connected and not spectators
 	if ( g_gametype.integer >= GT_TEAM ) {
@@ -882,7 +925,7 @@ void SendScoreboardMessageToAllClients( void ) {
 
 	for ( i = 0 ; i < level.maxclients ; i++ ) {
 		if ( level.clients[ i ].pers.connected == CON_CONNECTED ) {
-			DeathmatchScoreboardMessage( g_entities + i );
+			G_ScoreboardMessage( g_entities + i );
 		}
 	}
 }
@@ -1106,6 +1149,32 @@ void QDECL G_LogPrintf( const char *fmt, ... ) {
 	trap_FS_Write( string, strlen( string ), level.logFile );
 }
 
+/*
+=================
+G_LogEvent
+
+Reports an event to the engine's structured event stream, the
+arguments are numArgs ints laid out as gameEvent_t describes
+=================
+*/
+void QDECL G_LogEvent( gameEvent_t type, const char *text, int numArgs, ... ) {
+	va_list		argptr;
+	int			args[GEV_MAX_ARGS];
+	int			i;
+
+	if ( numArgs > GEV_MAX_ARGS ) {
+		numArgs = GEV_MAX_ARGS;
+	}
+
+	va_start( argptr, numArgs );
+	for ( i = 0; i < numArgs; i++ ) {
+		args[i] = va_arg( argptr, int );
+	}
+	va_end( argptr );
+
+	trap_LogEvent( type, args, numArgs, text );
+}
+
 /*
 ================
 LogExit
@@ -1120,6 +1189,7 @@ void LogExit( const char *string ) {
 	qboolean won = qtrue;
 #endif
 	G_LogPrintf( "Exit: %s\n", string );
+	G_LogEvent( GEV_ROUND, string, 1, ROUNDEVENT_EXIT );
 
 	level.intermissionQueued = level.time;
 
@@ -1426,6 +1496,7 @@ void CheckTournament( void ) {
 				level.warmupTime = -1;
 				trap_SetConfigstring( CS_WARMUP, va("%i", level.warmupTime) );
 				G_LogPrintf( "Warmup:\n" );
+				G_LogEvent( GEV_ROUND, NULL, 1, ROUNDEVENT_WARMUP );
 			}
 			return;
 		}
@@ -1483,6 +1554,7 @@ void CheckTournament( void ) {
 				level.warmupTime = -1;
 				trap_SetConfigstring( CS_WARMUP, va("%i", level.warmupTime) );
 				G_LogPrintf( "Warmup:\n" );
+				G_LogEvent( GEV_ROUND, NULL, 1, ROUNDEVENT_WARMUP );
 			}
 			return; // still waiting for team members
 		}
@@ -228,6 +228,14 @@ typedef enum {
 	
 	// 1.32
 	G_FS_SEEK,
+
+	G_LOG_EVENT = 150,	// ( int type, const int *args, int numArgs, const char *text )
+	// structured counterpart of the games.log lines, see gameEvent_t
+	G_CVAR_GENERATIONS,	// ( int *generations, int count )
+	// the engine keeps generations[handle] equal to the cvar's modificationCount,
+	// so G_CVAR_UPDATE is only needed when it differs from the vmCvar_t
+	G_TRACE_AT_TIME,	// ( trace_t *results, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int passEntityNum, int contentmask, int time );
+	// G_TRACE with the clients where they were at a past server time
 #if 0 // was here for early protocol70 tests
 	G_NET_STRINGTOADR,
 	G_NET_SENDPACKET,
@@ -403,6 +411,35 @@ typedef enum {
 } gameImport_t;
 
 
+//
+// events the game reports through G_LOG_EVENT
+//
+#define	GEV_MAX_ARGS	8
+
+typedef enum {
+	GEV_KILL,		// attacker, target, meansOfDeath; text is the obituary
+	GEV_HIT,		// attacker, target, damage, meansOfDeath
+	GEV_ITEM,		// client, item index; text is the classname
+	GEV_FLAG,		// client, team, flagEvent_t
+	GEV_ROUND,		// roundEvent_t; text is the exit reason
+
+	GEV_NUM_EVENTS
+} gameEvent_t;
+
+typedef enum {
+	FLAGEVENT_TAKEN,
+	FLAGEVENT_DROPPED,		// client is ENTITYNUM_NONE, the carrier is in the kill before it
+	FLAGEVENT_RETURNED,		// client is ENTITYNUM_WORLD when it timed out
+	FLAGEVENT_CAPTURED
+} flagEvent_t;
+
+typedef enum {
+	ROUNDEVENT_WARMUP,
+	ROUNDEVENT_START,
+	ROUNDEVENT_EXIT
+} roundEvent_t;
+
+
 //
 // functions exported by the game subsystem
 //
@@ -130,7 +130,7 @@ void G_RankRunFrame()
 
 						// send current scores so the player's rank will show 
 						// up under the crosshair immediately
-						DeathmatchScoreboardMessage( ent2 );
+						G_ScoreboardMessage( ent2 );
 					}
 				}
 				break;
@@ -417,6 +417,7 @@ void G_SpawnGEntityFromSpawnVars( void ) {
 	for ( i = 0 ; i < level.numSpawnVars ; i++ ) {
 		G_ParseField( level.spawnVars[i][0], level.spawnVars[i][1], ent );
 	}
+	G_ReindexEntity( ent );
 
 	// check for "notsingle" flag
 	if ( g_gametype.integer == GT_SINGLE_PLAYER ) {
@@ -608,6 +609,7 @@ void SP_worldspawn( void ) {
 		level.warmupTime = -1;
 		trap_SetConfigstring( CS_WARMUP, va("%i", level.warmupTime) );
 		G_LogPrintf( "Warmup:\n" );
+		G_LogEvent( GEV_ROUND, NULL, 1, ROUNDEVENT_WARMUP );
 	}
 
 }
@@ -435,6 +435,81 @@ void	Svcmd_ForceTeam_f( void ) {
 	SetTeam( &g_entities[cl - level.clients], str );
 }
 
+/*
+===================
+Svcmd_SpawnBench_f
+
+spawnbench [rounds] [batch]
+
+Allocates and frees batch temp entities rounds times to time G_Spawn
+against the entities of the current map.  The frees count as startup
+frees, so the slots are reused and the map doesn't grow.
+===================
+*/
+void	Svcmd_SpawnBench_f( void ) {
+	gentity_t	*ents[256];
+	char		str[MAX_TOKEN_CHARS];
+	vec3_t		origin;
+	int			rounds, batch, i, j, start, msec, startTime, numEntities;
+
+	trap_Argv( 1, str, sizeof( str ) );
+	rounds = str[0] ? atoi( str ) : 1000;
+	trap_Argv( 2, str, sizeof( str ) );
+	batch = str[0] ? atoi( str ) : 64;
+	if ( rounds < 1 ) {
+		rounds = 1;
+	}
+	if ( batch < 1 || batch > ARRAY_LEN( ents ) ) {
+		batch = ARRAY_LEN( ents );
+	}
+
+	numEntities = level.num_entities;
+	startTime = level.startTime;
+	level.startTime = level.time;
+	VectorClear( origin );
+
+	start = trap_Milliseconds();
+	for ( i = 0 ; i < rounds ; i++ ) {
+		for ( j = 0 ; j < batch ; j++ ) {
+			ents[j] = G_TempEntity( origin, EV_NONE );
+		}
+		for ( j = 0 ; j < batch ; j++ ) {
+			G_FreeEntity( ents[j] );
+		}
+	}
+	msec = trap_Milliseconds() - start;
+
+	level.startTime = startTime;
+
+	G_Printf( "%i spawns in %i msec, %i entities before, %i after\n",
+		rounds * batch, msec, numEntities, level.num_entities );
+}
+
+/*
+===================
+Svcmd_FindStats_f
+
+findstats [reset]
+
+G_Find lookups and string compares per frame since the last reset,
+toggle g_entityIndex and reset to compare the hashed and linear search
+===================
+*/
+void	Svcmd_FindStats_f( void ) {
+	char	str[MAX_TOKEN_CHARS];
+	int		calls, compares, frames;
+
+	trap_Argv( 1, str, sizeof( str ) );
+	G_FindStats( &calls, &compares, &frames, !Q_stricmp( str, "reset" ) );
+	if ( frames < 1 ) {
+		frames = 1;
+	}
+
+	G_Printf( "g_entityIndex %i: %i finds, %i compares in %i frames, %.1f compares/frame, %.1f compares/find\n",
+		g_entityIndex.integer, calls, compares, frames, (float)compares / frames,
+		calls ? (float)compares / calls : 0.0f );
+}
+
 char	*ConcatArgs( int start );
 
 /*
@@ -458,6 +533,16 @@ qboolean	ConsoleCommand( void ) {
 		return qtrue;
 	}
 
+	if (Q_stricmp (cmd, "spawnbench") == 0) {
+		Svcmd_SpawnBench_f();
+		return qtrue;
+	}
+
+	if (Q_stricmp (cmd, "findstats") == 0) {
+		Svcmd_FindStats_f();
+		return qtrue;
+	}
+
 	if (Q_stricmp (cmd, "game_memory") == 0) {
 		Svcmd_GameMem_f();
 		return qtrue;
@@ -46,6 +46,9 @@ equ trap_SnapVector			-43
 equ trap_TraceCapsule		-44
 equ trap_EntityContactCapsule	-45
 equ trap_FS_Seek -46
+equ trap_LogEvent -151
+equ trap_Cvar_Generations -152
+equ trap_TraceAtTime -153
 
 equ	memset					-101
 equ	memcpy					-102
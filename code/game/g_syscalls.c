@@ -84,6 +84,10 @@ int trap_FS_Seek( fileHandle_t f, long offset, int origin ) {
 	return syscall( G_FS_SEEK, f, offset, origin );
 }
 
+void	trap_LogEvent( int type, const int *args, int numArgs, const char *text ) {
+	syscall( G_LOG_EVENT, type, args, numArgs, text );
+}
+
 void	trap_SendConsoleCommand( int exec_when, const char *text ) {
 	syscall( G_SEND_CONSOLE_COMMAND, exec_when, text );
 }
@@ -96,6 +100,10 @@ void	trap_Cvar_Update( vmCvar_t *cvar ) {
 	syscall( G_CVAR_UPDATE, cvar );
 }
 
+void	trap_Cvar_Generations( int *generations, int count ) {
+	syscall( G_CVAR_GENERATIONS, generations, count );
+}
+
 void trap_Cvar_Set( const char *var_name, const char *value ) {
 	syscall( G_CVAR_SET, var_name, value );
 }
@@ -154,6 +162,10 @@ void trap_TraceCapsule( trace_t *results, const vec3_t start, const vec3_t mins,
 	syscall( G_TRACECAPSULE, results, start, mins, maxs, end, passEntityNum, contentmask );
 }
 
+void trap_TraceAtTime( trace_t *results, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int passEntityNum, int contentmask, int time ) {
+	syscall( G_TRACE_AT_TIME, results, start, mins, maxs, end, passEntityNum, contentmask, time );
+}
+
 int trap_PointContents( const vec3_t point, int passEntityNum ) {
 	return syscall( G_POINT_CONTENTS, point, passEntityNum );
 }
@@ -238,12 +238,15 @@ void Team_SetFlagStatus( int team, flagStatus_t status ) {
 void Team_CheckDroppedItem( gentity_t *dropped ) {
 	if( dropped->item->giTag == PW_REDFLAG ) {
 		Team_SetFlagStatus( TEAM_RED, FLAG_DROPPED );
+		G_LogEvent( GEV_FLAG, NULL, 3, ENTITYNUM_NONE, TEAM_RED, FLAGEVENT_DROPPED );
 	}
 	else if( dropped->item->giTag == PW_BLUEFLAG ) {
 		Team_SetFlagStatus( TEAM_BLUE, FLAG_DROPPED );
+		G_LogEvent( GEV_FLAG, NULL, 3, ENTITYNUM_NONE, TEAM_BLUE, FLAGEVENT_DROPPED );
 	}
 	else if( dropped->item->giTag == PW_NEUTRALFLAG ) {
 		Team_SetFlagStatus( TEAM_FREE, FLAG_DROPPED );
+		G_LogEvent( GEV_FLAG, NULL, 3, ENTITYNUM_NONE, TEAM_FREE, FLAGEVENT_DROPPED );
 	}
 }
 
@@ -688,6 +691,7 @@ void Team_DroppedFlagThink(gentity_t *ent) {
 		team = TEAM_FREE;
 	}
 
+	G_LogEvent( GEV_FLAG, NULL, 3, ENTITYNUM_WORLD, team, FLAGEVENT_RETURNED );
 	Team_ReturnFlagSound( Team_ResetFlag( team ), team );
 	// Reset Flag will delete this entity
 }
@@ -723,6 +727,7 @@ int Team_TouchOurFlag( gentity_t *ent, gentity_t *other, int team ) {
 		AddScore(other, ent->r.currentOrigin, CTF_RECOVERY_BONUS);
 		other->client->pers.teamState.flagrecovery++;
 		other->client->pers.teamState.lastreturnedflag = level.time;
+		G_LogEvent( GEV_FLAG, NULL, 3, other->s.number, team, FLAGEVENT_RETURNED );
 		//ResetFlag will remove this entity!  We must return zero
 		Team_ReturnFlagSound(Team_ResetFlag(team), team);
 		return 0;
@@ -747,6 +752,7 @@ int Team_TouchOurFlag( gentity_t *ent, gentity_t *other, int team ) {
 #endif
 
 	cl->ps.powerups[enemy_flag] = 0;
+	G_LogEvent( GEV_FLAG, NULL, 3, other->s.number, OtherTeam( team ), FLAGEVENT_CAPTURED );
 
 	teamgame.last_flag_capture = level.time;
 	teamgame.last_capture_team = team;
@@ -844,6 +850,7 @@ int Team_TouchEnemyFlag( gentity_t *ent, gentity_t *other, int team ) {
 	}
 #endif
 
+	G_LogEvent( GEV_FLAG, NULL, 3, other->s.number, team, FLAGEVENT_TAKEN );
 	AddScore(other, ent->r.currentOrigin, CTF_FLAG_BONUS);
 	cl->pers.teamState.flagsince = level.time;
 	Team_TakeFlagSound( ent, team );
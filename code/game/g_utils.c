@@ -144,6 +144,210 @@ void G_TeamCommand( team_t team, char *cmd ) {
 }
 
 
+/*
+=============================================================================
+
+ENTITY STRING INDEX
+
+G_Find on classname and targetname goes through a hash of the field
+value instead of comparing against every entity.  Most code assigns
+those fields directly, so the index only remembers the string pointer
+an entity was filed under: entities touched by G_InitGentity,
+G_FreeEntity or spawn field parsing are rechecked on every lookup for
+the rest of the frame, and the first lookup of a frame rechecks the
+pointers of all entities.  Candidates are still compared, so a stale
+entry never returns a wrong entity, but an entity given a new name
+outside of those is missed under that name until the next frame.
+Code that renames an entity it didn't just spawn has to call
+G_ReindexEntity to be found right away.
+
+=============================================================================
+*/
+
+#define ENTITY_INDEX_FIELDS		2
+#define ENTITY_INDEX_BUCKETS	256		// power of two
+
+typedef struct {
+	int			head[ENTITY_INDEX_BUCKETS];
+	int			next[MAX_GENTITIES];		// chains are sorted by entity number
+	int			bucket[MAX_GENTITIES];		// -1 when not indexed
+	const char	*value[MAX_GENTITIES];		// pointer the entity was filed under
+} entityIndex_t;
+
+static entityIndex_t	entityIndex[ENTITY_INDEX_FIELDS];
+static int				entityIndexFields[ENTITY_INDEX_FIELDS] = { FOFS(classname), FOFS(targetname) };
+
+static int				indexPending[MAX_GENTITIES];
+static qboolean			indexIsPending[MAX_GENTITIES];
+static int				numIndexPending;
+static int				indexSyncFrame;
+
+static int				findCalls, findCompares, findStatsFrame;
+
+/*
+=============
+G_EntityIndexHash
+
+Folds case the same way Q_stricmp does
+=============
+*/
+static int G_EntityIndexHash( const char *s ) {
+	unsigned	hash;
+	int			c;
+
+	hash = 0;
+	for ( ; *s ; s++ ) {
+		c = *s;
+		if ( c >= 'a' && c <= 'z' ) {
+			c -= ( 'a' - 'A' );
+		}
+		hash = hash * 31 + c;
+	}
+	return hash & ( ENTITY_INDEX_BUCKETS - 1 );
+}
+
+/*
+=============
+G_UnindexField
+=============
+*/
+static void G_UnindexField( entityIndex_t *idx, int num ) {
+	int		*link;
+
+	if ( idx->bucket[num] < 0 ) {
+		return;
+	}
+	for ( link = &idx->head[idx->bucket[num]] ; *link != -1 ; link = &idx->next[*link] ) {
+		if ( *link == num ) {
+			*link = idx->next[num];
+			break;
+		}
+	}
+	idx->bucket[num] = -1;
+	idx->value[num] = NULL;
+}
+
+/*
+=============
+G_IndexField
+=============
+*/
+static void G_IndexField( entityIndex_t *idx, int num, const char *value ) {
+	int		*link, b;
+
+	if ( idx->bucket[num] >= 0 && idx->value[num] == value ) {
+		return;
+	}
+	G_UnindexField( idx, num );
+	if ( !value ) {
+		return;
+	}
+
+	b = G_EntityIndexHash( value );
+	for ( link = &idx->head[b] ; *link != -1 && *link < num ; link = &idx->next[*link] ) {
+	}
+	idx->next[num] = *link;
+	*link = num;
+	idx->bucket[num] = b;
+	idx->value[num] = value;
+}
+
+/*
+=============
+G_IndexEntity
+=============
+*/
+static void G_IndexEntity( gentity_t *ent ) {
+	int		f, num;
+
+	num = ent - g_entities;
+	for ( f = 0 ; f < ENTITY_INDEX_FIELDS ; f++ ) {
+		if ( ent->inuse ) {
+			G_IndexField( &entityIndex[f], num, *(char **)((byte *)ent + entityIndexFields[f]) );
+		} else {
+			G_UnindexField( &entityIndex[f], num );
+		}
+	}
+}
+
+/*
+=============
+G_InitEntityIndex
+
+Called after g_entities is cleared for a new level
+=============
+*/
+void G_InitEntityIndex( void ) {
+	memset( entityIndex, -1, sizeof( entityIndex ) );
+	memset( indexIsPending, 0, sizeof( indexIsPending ) );
+	numIndexPending = 0;
+	indexSyncFrame = -1;
+
+	findCalls = findCompares = 0;
+	findStatsFrame = level.framenum;
+}
+
+/*
+=============
+G_ReindexEntity
+
+For code that changes classname or targetname of an entity
+after its spawn function, picked up again on the next G_Find
+=============
+*/
+void G_ReindexEntity( gentity_t *ent ) {
+	int		num;
+
+	num = ent - g_entities;
+	G_IndexEntity( ent );
+	if ( !indexIsPending[num] ) {
+		indexIsPending[num] = qtrue;
+		indexPending[numIndexPending++] = num;
+	}
+}
+
+/*
+=============
+G_SyncEntityIndex
+=============
+*/
+static void G_SyncEntityIndex( void ) {
+	int		i;
+
+	if ( indexSyncFrame != level.framenum ) {
+		indexSyncFrame = level.framenum;
+		for ( i = 0 ; i < level.num_entities ; i++ ) {
+			G_IndexEntity( &g_entities[i] );
+		}
+		for ( i = 0 ; i < numIndexPending ; i++ ) {
+			indexIsPending[indexPending[i]] = qfalse;
+		}
+		numIndexPending = 0;
+		return;
+	}
+
+	for ( i = 0 ; i < numIndexPending ; i++ ) {
+		G_IndexEntity( &g_entities[indexPending[i]] );
+	}
+}
+
+/*
+=============
+G_FindStats
+
+Lookups and string compares done by G_Find since the last reset
+=============
+*/
+void G_FindStats( int *calls, int *compares, int *frames, qboolean reset ) {
+	*calls = findCalls;
+	*compares = findCompares;
+	*frames = level.framenum - findStatsFrame;
+	if ( reset ) {
+		findCalls = findCompares = 0;
+		findStatsFrame = level.framenum;
+	}
+}
+
 /*
 =============
 G_Find
@@ -158,7 +362,44 @@ NULL will be returned if the end of the list is reached.
 */
 gentity_t *G_Find (gentity_t *from, int fieldofs, const char *match)
 {
+	entityIndex_t	*idx;
 	char	*s;
+	int		f, num, start, b;
+
+	findCalls++;
+
+	for ( f = 0 ; f < ENTITY_INDEX_FIELDS ; f++ ) {
+		if ( entityIndexFields[f] == fieldofs ) {
+			break;
+		}
+	}
+
+	if ( f < ENTITY_INDEX_FIELDS && g_entityIndex.integer && match ) {
+		G_SyncEntityIndex();
+		idx = &entityIndex[f];
+		start = from ? from - g_entities : -1;
+		b = G_EntityIndexHash( match );
+
+		if ( start >= 0 && idx->bucket[start] == b ) {
+			num = idx->next[start];
+		} else {
+			for ( num = idx->head[b] ; num != -1 && num <= start ; num = idx->next[num] ) {
+			}
+		}
+
+		for ( ; num != -1 ; num = idx->next[num] ) {
+			from = &g_entities[num];
+			if (!from->inuse)
+				continue;
+			s = *(char **) ((byte *)from + fieldofs);
+			if (!s)
+				continue;
+			findCompares++;
+			if (!Q_stricmp (s, match))
+				return from;
+		}
+		return NULL;
+	}
 
 	if (!from)
 		from = g_entities;
@@ -172,6 +413,7 @@ gentity_t *G_Find (gentity_t *from, int fieldofs, const char *match)
 		s = *(char **) ((byte *)from + fieldofs);
 		if (!s)
 			continue;
+		findCompares++;
 		if (!Q_stricmp (s, match))
 			return from;
 	}
@@ -369,6 +611,78 @@ void G_InitGentity( gentity_t *e ) {
 	e->classname = "noclass";
 	e->s.number = e - g_entities;
 	e->r.ownerNum = ENTITYNUM_NONE;
+	G_ReindexEntity( e );
+}
+
+/*
+=================
+G_SpawnSlotReady
+
+The replacement policy for a freed slot
+=================
+*/
+static qboolean G_SpawnSlotReady( gentity_t *e ) {
+	// the first couple seconds of server time can involve a lot of
+	// freeing and allocating, so relax the replacement policy
+	return e->freetime <= level.startTime + 2000 || level.time - e->freetime >= 1000;
+}
+
+/*
+=================
+G_QueueFree
+=================
+*/
+static void G_QueueFree( gentity_t *e ) {
+	int		num;
+
+	num = e - g_entities;
+	if ( num < MAX_CLIENTS || num >= ENTITYNUM_MAX_NORMAL || level.freeNext[num] ) {
+		return;		// not ours to hand out, or freed twice
+	}
+
+	level.freeNext[num] = -1;
+	if ( level.freeTail ) {
+		level.freeNext[level.freeTail] = num;
+	} else {
+		level.freeHead = num;
+	}
+	level.freeTail = num;
+}
+
+/*
+=================
+G_DequeueFree
+
+Returns the oldest free slot, when force is qfalse only if it may be reused
+=================
+*/
+static gentity_t *G_DequeueFree( qboolean force ) {
+	gentity_t	*e;
+	int			num;
+
+	while ( level.freeHead ) {
+		num = level.freeHead;
+		e = &g_entities[num];
+
+		// queue order is freetime order, if the oldest one has
+		// to wait all the others do too
+		if ( !e->inuse && !force && !G_SpawnSlotReady( e ) ) {
+			return NULL;
+		}
+
+		level.freeHead = level.freeNext[num] > 0 ? level.freeNext[num] : 0;
+		if ( !level.freeHead ) {
+			level.freeTail = 0;
+		}
+		level.freeNext[num] = 0;
+
+		// taken by something that doesn't go through G_Spawn
+		if ( e->inuse ) {
+			continue;
+		}
+		return e;
+	}
+	return NULL;
 }
 
 /*
@@ -377,60 +691,53 @@ G_Spawn
 
 Either finds a free entity, or allocates a new one.
 
-  The slots from 0 to MAX_CLIENTS-1 are always reserved for clients, and will
+  The slots numbered below MAX_CLIENTS are always reserved for clients, and will
 never be used by anything else.
 
 Try to avoid reusing an entity that was recently freed, because it
 can cause the client to think the entity morphed into something else
 instead of being removed and recreated, which can cause interpolated
 angles and bad trails.
+
+Freed slots wait in a queue, so this doesn't have to look at every entity.
 =================
 */
 gentity_t *G_Spawn( void ) {
-	int			i, force;
+	int			i;
 	gentity_t	*e;
 
-	e = NULL;	// shut up warning
-	i = 0;		// shut up warning
-	for ( force = 0 ; force < 2 ; force++ ) {
-		// if we go through all entities and can't find one to free,
-		// override the normal minimum times before use
-		e = &g_entities[MAX_CLIENTS];
-		for ( i = MAX_CLIENTS ; i<level.num_entities ; i++, e++) {
-			if ( e->inuse ) {
-				continue;
-			}
+	// reuse the oldest slot that has been free long enough
+	e = G_DequeueFree( qfalse );
+	if ( e ) {
+		G_InitGentity( e );
+		return e;
+	}
 
-			// the first couple seconds of server time can involve a lot of
-			// freeing and allocating, so relax the replacement policy
-			if ( !force && e->freetime > level.startTime + 2000 && level.time - e->freetime < 1000 ) {
-				continue;
-			}
+	if ( level.num_entities < ENTITYNUM_MAX_NORMAL ) {
+		// open up a new slot
+		e = &g_entities[level.num_entities];
+		level.num_entities++;
 
-			// reuse this slot
-			G_InitGentity( e );
-			return e;
-		}
-		if ( i != MAX_GENTITIES ) {
-			break;
-		}
-	}
-	if ( i == ENTITYNUM_MAX_NORMAL ) {
-		for (i = 0; i < MAX_GENTITIES; i++) {
-			G_Printf("%4i: %s\n", i, g_entities[i].classname);
-		}
-		G_Error( "G_Spawn: no free entities" );
+		// let the server system know that there are more entities
+		trap_LocateGameData( level.gentities, level.num_entities, sizeof( gentity_t ), 
+			&level.clients[0].ps, sizeof( level.clients[0] ) );
+
+		G_InitGentity( e );
+		return e;
 	}
-	
-	// open up a new slot
-	level.num_entities++;
 
-	// let the server system know that there are more entities
-	trap_LocateGameData( level.gentities, level.num_entities, sizeof( gentity_t ), 
-		&level.clients[0].ps, sizeof( level.clients[0] ) );
+	// if we can't open a new one, override the normal minimum times before use
+	e = G_DequeueFree( qtrue );
+	if ( e ) {
+		G_InitGentity( e );
+		return e;
+	}
 
-	G_InitGentity( e );
-	return e;
+	for (i = 0; i < MAX_GENTITIES; i++) {
+		G_Printf("%4i: %s\n", i, g_entities[i].classname);
+	}
+	G_Error( "G_Spawn: no free entities" );
+	return NULL;
 }
 
 /*
@@ -439,16 +746,13 @@ G_EntitiesFree
 =================
 */
 qboolean G_EntitiesFree( void ) {
-	int			i;
-	gentity_t	*e;
+	int		num;
 
-	e = &g_entities[MAX_CLIENTS];
-	for ( i = MAX_CLIENTS; i < level.num_entities; i++, e++) {
-		if ( e->inuse ) {
-			continue;
+	for ( num = level.freeHead; num > 0; num = level.freeNext[num] ) {
+		if ( !g_entities[num].inuse ) {
+			// slot available
+			return qtrue;
 		}
-		// slot available
-		return qtrue;
 	}
 	return qfalse;
 }
@@ -472,6 +776,9 @@ void G_FreeEntity( gentity_t *ed ) {
 	ed->classname = "freed";
 	ed->freetime = level.time;
 	ed->inuse = qfalse;
+
+	G_ReindexEntity( ed );
+	G_QueueFree( ed );
 }
 
 /*
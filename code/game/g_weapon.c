@@ -57,6 +57,29 @@ GAUNTLET
 ======================================================================
 */
 
+/*
+================
+G_ShotTrace
+
+With g_antilag set, other clients are where the shooter saw them,
+up to g_antilag msec back
+================
+*/
+static void G_ShotTrace( gentity_t *ent, trace_t *tr, const vec3_t start, const vec3_t end, int passent ) {
+	int		time;
+
+	if ( !g_antilag.integer || !ent->client || ( ent->r.svFlags & SVF_BOT ) ) {
+		trap_Trace( tr, start, NULL, NULL, end, passent, MASK_SHOT );
+		return;
+	}
+
+	time = ent->client->pers.cmd.serverTime;
+	if ( time < level.time - g_antilag.integer ) {
+		time = level.time - g_antilag.integer;
+	}
+	trap_TraceAtTime( tr, start, NULL, NULL, end, passent, MASK_SHOT, time );
+}
+
 void Weapon_Gauntlet( gentity_t *ent ) {
 
 }
@@ -80,7 +103,7 @@ qboolean CheckGauntletAttack( gentity_t *ent ) {
 
 	VectorMA (muzzle, 32, forward, end);
 
-	trap_Trace (&tr, muzzle, NULL, NULL, end, ent->s.number, MASK_SHOT);
+	G_ShotTrace( ent, &tr, muzzle, end, ent->s.number );
 	if ( tr.surfaceFlags & SURF_NOIMPACT ) {
 		return qfalse;
 	}
@@ -180,7 +203,7 @@ void Bullet_Fire (gentity_t *ent, float spread, int damage ) {
 	passent = ent->s.number;
 	for (i = 0; i < 10; i++) {
 
-		trap_Trace (&tr, muzzle, NULL, NULL, end, passent, MASK_SHOT);
+		G_ShotTrace( ent, &tr, muzzle, end, passent );
 		if ( tr.surfaceFlags & SURF_NOIMPACT ) {
 			return;
 		}
@@ -275,7 +298,7 @@ qboolean ShotgunPellet( vec3_t start, vec3_t end, gentity_t *ent ) {
 	VectorCopy( start, tr_start );
 	VectorCopy( end, tr_end );
 	for (i = 0; i < 10; i++) {
-		trap_Trace (&tr, tr_start, NULL, NULL, tr_end, passent, MASK_SHOT);
+		G_ShotTrace( ent, &tr, tr_start, tr_end, passent );
 		traceEnt = &g_entities[ tr.entityNum ];
 
 		// send bullet impact
@@ -462,7 +485,7 @@ void weapon_railgun_fire (gentity_t *ent) {
 	hits = 0;
 	passent = ent->s.number;
 	do {
-		trap_Trace (&trace, muzzle, NULL, NULL, end, passent, MASK_SHOT );
+		G_ShotTrace( ent, &trace, muzzle, end, passent );
 		if ( trace.entityNum >= ENTITYNUM_MAX_NORMAL ) {
 			break;
 		}
@@ -624,7 +647,7 @@ void Weapon_LightningFire( gentity_t *ent ) {
 	for (i = 0; i < 10; i++) {
 		VectorMA( muzzle, LIGHTNING_RANGE, forward, end );
 
-		trap_Trace( &tr, muzzle, NULL, NULL, end, passent, MASK_SHOT );
+		G_ShotTrace( ent, &tr, muzzle, end, passent );
 
 #ifdef MISSIONPACK
 		// if not the first trace (the lightning bounced of an invulnerability sphere)
@@ -25,11 +25,14 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 
 cvar_t *cl_shownet;
 
+void CL_DemoAnalyze_f( void );
+
 void CL_Shutdown( char *finalmsg ) {
 }
 
 void CL_Init( void ) {
 	cl_shownet = Cvar_Get ("cl_shownet", "0", CVAR_TEMP );
+	Cmd_AddCommand ("demoanalyze", CL_DemoAnalyze_f);
 }
 
 void CL_MouseEvent( int dx, int dy, int time ) {
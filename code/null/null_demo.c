@@ -0,0 +1,509 @@
+/*
+===========================================================================
+Copyright (C) 1999-2005 Id Software, Inc.
+
+This file is part of Quake III Arena source code.
+
+Quake III Arena source code is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the License,
+or (at your option) any later version.
+
+Quake III Arena source code is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Quake III Arena source code; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+===========================================================================
+*/
+// null_demo.c -- headless demo analysis for the dedicated build
+//
+// demoanalyze <demo> [demo ...] parses demos with the gamestate, entity
+// and demo block readers the client uses, without a renderer, sound or
+// cgame, and writes one JSON record per line for the gamestate, every
+// server command and every snapshot to <demo>.ndjson.  Run e.g. "ioq3ded +demoanalyze a.urtdemo +quit" in
+// as many processes as there are cores to work through a pile of demos.
+
+#include "../qcommon/q_shared.h"
+#include "../qcommon/qcommon.h"
+#include "../json-c/json.h"
+
+#define DA_MAX_PARSE_ENTITIES	2048
+
+typedef struct {
+	qboolean		valid;
+	int				serverTime;
+	int				messageNum;
+	playerState_t	ps;
+	int				numEntities;
+	int				parseEntitiesNum;
+} daSnapshot_t;
+
+static struct {
+	fileHandle_t	demo;
+	fileHandle_t	out;
+	qboolean		newFormat;		// NEWDEMOEXT, trailing length after each message
+	qboolean		compressed;		// DEMOZ_EXT, messages packed into blocks
+	demozReader_t	dz;
+
+	int				serverMessageSequence;
+	int				serverCommandSequence;
+
+	gameState_t		gameState;
+	daSnapshot_t	snap;
+	daSnapshot_t	snapshots[PACKET_BACKUP];
+	parseEntities_t	pe;
+	entityState_t	baselines[MAX_GENTITIES];
+	entityState_t	parseEntities[DA_MAX_PARSE_ENTITIES];
+
+	int				numSnapshots;
+	int				numCommands;
+} da;
+
+/*
+==================
+DA_WriteRecord
+==================
+*/
+static void DA_WriteRecord( struct json_object *rec ) {
+	const char	*s;
+
+	s = json_object_to_json_string( rec );
+	FS_Write( s, strlen( s ), da.out );
+	FS_Write( "\n", 1, da.out );
+	json_object_put( rec );
+}
+
+/*
+==================
+DA_Vector
+==================
+*/
+static struct json_object *DA_Vector( const vec3_t v, qboolean snapped ) {
+	struct json_object	*a;
+	int					i;
+
+	a = json_object_new_array();
+	for ( i = 0; i < 3; i++ ) {
+		if ( snapped ) {
+			json_object_array_add( a, json_object_new_int( (int)v[i] ) );
+		} else {
+			json_object_array_add( a, json_object_new_double( v[i] ) );
+		}
+	}
+	return a;
+}
+
+/*
+==================
+DA_WriteSnapshot
+==================
+*/
+static void DA_WriteSnapshot( const daSnapshot_t *snap ) {
+	struct json_object	*rec, *ps, *ents, *ent, *stats;
+	const entityState_t	*es;
+	int					i;
+
+	ps = json_object_new_object();
+	json_object_object_add( ps, "client", json_object_new_int( snap->ps.clientNum ) );
+	json_object_object_add( ps, "pm_type", json_object_new_int( snap->ps.pm_type ) );
+	json_object_object_add( ps, "origin", DA_Vector( snap->ps.origin, qtrue ) );
+	json_object_object_add( ps, "velocity", DA_Vector( snap->ps.velocity, qtrue ) );
+	json_object_object_add( ps, "angles", DA_Vector( snap->ps.viewangles, qfalse ) );
+	json_object_object_add( ps, "weapon", json_object_new_int( snap->ps.weapon ) );
+	json_object_object_add( ps, "eFlags", json_object_new_int( snap->ps.eFlags ) );
+	stats = json_object_new_array();
+	for ( i = 0; i < MAX_STATS; i++ ) {
+		json_object_array_add( stats, json_object_new_int( snap->ps.stats[i] ) );
+	}
+	json_object_object_add( ps, "stats", stats );
+
+	ents = json_object_new_array();
+	for ( i = 0; i < snap->numEntities; i++ ) {
+		es = &da.parseEntities[( snap->parseEntitiesNum + i ) & da.pe.mask];
+		ent = json_object_new_object();
+		json_object_object_add( ent, "num", json_object_new_int( es->number ) );
+		json_object_object_add( ent, "type", json_object_new_int( es->eType ) );
+		json_object_object_add( ent, "origin", DA_Vector( es->pos.trBase, qtrue ) );
+		json_object_object_add( ent, "angles", DA_Vector( es->apos.trBase, qfalse ) );
+		json_object_object_add( ent, "weapon", json_object_new_int( es->weapon ) );
+		json_object_object_add( ent, "client", json_object_new_int( es->clientNum ) );
+		json_object_object_add( ent, "event", json_object_new_int( es->event ) );
+		json_object_array_add( ents, ent );
+	}
+
+	rec = json_object_new_object();
+	json_object_object_add( rec, "type", json_object_new_string( "snapshot" ) );
+	json_object_object_add( rec, "time", json_object_new_int( snap->serverTime ) );
+	json_object_object_add( rec, "msg", json_object_new_int( snap->messageNum ) );
+	json_object_object_add( rec, "ps", ps );
+	json_object_object_add( rec, "entities", ents );
+	DA_WriteRecord( rec );
+}
+
+/*
+==================
+DA_ParseGamestate
+==================
+*/
+static qboolean DA_ParseGamestate( msg_t *msg ) {
+	struct json_object	*rec, *cs;
+	const char			*error;
+	char				key[8];
+	int					i, clientNum;
+
+	// a gamestate starts over like CL_ClearState
+	Com_Memset( &da.gameState, 0, sizeof( da.gameState ) );
+	Com_Memset( &da.snap, 0, sizeof( da.snap ) );
+	Com_Memset( da.snapshots, 0, sizeof( da.snapshots ) );
+	Com_Memset( da.baselines, 0, sizeof( da.baselines ) );
+	da.pe.num = 0;
+
+	da.serverCommandSequence = MSG_ReadLong( msg );
+
+	error = MSG_ReadGamestate( msg, &da.gameState, da.baselines );
+	if ( error ) {
+		Com_Printf( "DA_ParseGamestate: %s\n", error );
+		return qfalse;
+	}
+
+	clientNum = MSG_ReadLong( msg );
+	MSG_ReadLong( msg );	// checksum feed
+
+	cs = json_object_new_object();
+	for ( i = 0; i < MAX_CONFIGSTRINGS; i++ ) {
+		if ( !da.gameState.stringOffsets[i] ) {
+			continue;
+		}
+		Com_sprintf( key, sizeof( key ), "%i", i );
+		json_object_object_add( cs, key,
+			json_object_new_string( da.gameState.stringData + da.gameState.stringOffsets[i] ) );
+	}
+
+	rec = json_object_new_object();
+	json_object_object_add( rec, "type", json_object_new_string( "gamestate" ) );
+	json_object_object_add( rec, "client", json_object_new_int( clientNum ) );
+	json_object_object_add( rec, "commandSequence", json_object_new_int( da.serverCommandSequence ) );
+	json_object_object_add( rec, "configstrings", cs );
+	DA_WriteRecord( rec );
+	return qtrue;
+}
+
+/*
+==================
+DA_ParseCommandString
+==================
+*/
+static void DA_ParseCommandString( msg_t *msg ) {
+	struct json_object	*rec;
+	char				*s;
+	int					seq;
+
+	seq = MSG_ReadLong( msg );
+	s = MSG_ReadString( msg );
+
+	// see if we have already executed this command
+	if ( seq <= da.serverCommandSequence ) {
+		return;
+	}
+	da.serverCommandSequence = seq;
+	da.numCommands++;
+
+	rec = json_object_new_object();
+	json_object_object_add( rec, "type", json_object_new_string( "command" ) );
+	json_object_object_add( rec, "time", json_object_new_int( da.snap.serverTime ) );
+	json_object_object_add( rec, "seq", json_object_new_int( seq ) );
+	json_object_object_add( rec, "cmd", json_object_new_string( s ) );
+	DA_WriteRecord( rec );
+}
+
+/*
+==================
+DA_ParseSnapshot
+
+Like CL_ParseSnapshot, minus the ping and pause bookkeeping
+==================
+*/
+static qboolean DA_ParseSnapshot( msg_t *msg ) {
+	daSnapshot_t	newSnap, *old;
+	byte			areamask[MAX_MAP_AREA_BYTES];
+	const char		*error;
+	int				deltaNum, len, oldMessageNum;
+
+	Com_Memset( &newSnap, 0, sizeof( newSnap ) );
+	newSnap.serverTime = MSG_ReadLong( msg );
+	newSnap.messageNum = da.serverMessageSequence;
+
+	deltaNum = MSG_ReadByte( msg );
+	MSG_ReadByte( msg );	// snapFlags
+
+	if ( !deltaNum ) {
+		newSnap.valid = qtrue;
+		old = NULL;
+	} else {
+		deltaNum = newSnap.messageNum - deltaNum;
+		old = &da.snapshots[deltaNum & PACKET_MASK];
+		// still parse against it to stay in step with the message
+		newSnap.valid = old->valid && old->messageNum == deltaNum
+			&& da.pe.num - old->parseEntitiesNum <= DA_MAX_PARSE_ENTITIES - 128;
+	}
+
+	len = MSG_ReadByte( msg );
+	if ( len > sizeof( areamask ) ) {
+		Com_Printf( "DA_ParseSnapshot: invalid size %d for areamask\n", len );
+		return qfalse;
+	}
+	MSG_ReadData( msg, areamask, len );
+
+	MSG_ReadDeltaPlayerstate( msg, old ? &old->ps : NULL, &newSnap.ps );
+
+	newSnap.parseEntitiesNum = da.pe.num;
+	error = MSG_ReadPacketEntities( msg, &da.pe, old ? old->parseEntitiesNum : 0,
+		old ? old->numEntities : 0, &newSnap.numEntities );
+	if ( error ) {
+		Com_Printf( "DA_ParseSnapshot: %s\n", error );
+		return qfalse;
+	}
+
+	if ( !newSnap.valid ) {
+		return qtrue;
+	}
+
+	// clear the valid flags of any snapshots between the last
+	// received and this one
+	oldMessageNum = da.snap.messageNum + 1;
+	if ( newSnap.messageNum - oldMessageNum >= PACKET_BACKUP ) {
+		oldMessageNum = newSnap.messageNum - ( PACKET_BACKUP - 1 );
+	}
+	for ( ; oldMessageNum < newSnap.messageNum; oldMessageNum++ ) {
+		da.snapshots[oldMessageNum & PACKET_MASK].valid = qfalse;
+	}
+
+	da.snap = newSnap;
+	da.snapshots[newSnap.messageNum & PACKET_MASK] = newSnap;
+	da.numSnapshots++;
+
+	DA_WriteSnapshot( &newSnap );
+	return qtrue;
+}
+
+/*
+==================
+DA_ParseServerMessage
+==================
+*/
+static qboolean DA_ParseServerMessage( msg_t *msg ) {
+	int		cmd;
+
+	MSG_Bitstream( msg );
+	MSG_ReadLong( msg );	// reliable acknowledge
+
+	while ( 1 ) {
+		if ( msg->readcount > msg->cursize ) {
+			Com_Printf( "DA_ParseServerMessage: read past end of server message\n" );
+			return qfalse;
+		}
+
+		cmd = MSG_ReadByte( msg );
+
+		if ( cmd == svc_EOF && MSG_LookaheadByte( msg ) == svc_extension ) {
+			MSG_ReadByte( msg );
+			cmd = MSG_ReadByte( msg );
+			if ( cmd == -1 ) {
+				cmd = svc_EOF;
+			}
+		}
+
+		if ( cmd == svc_EOF ) {
+			return qtrue;
+		}
+
+		switch ( cmd ) {
+		case svc_nop:
+			break;
+		case svc_serverCommand:
+			DA_ParseCommandString( msg );
+			break;
+		case svc_gamestate:
+			if ( !DA_ParseGamestate( msg ) ) {
+				return qfalse;
+			}
+			break;
+		case svc_snapshot:
+			if ( !DA_ParseSnapshot( msg ) ) {
+				return qfalse;
+			}
+			break;
+		default:
+			// downloads and voip come last and hold nothing to analyze
+			return qtrue;
+		}
+	}
+}
+
+/*
+==================
+DA_ReadDemoMessage
+
+Next message of the demo, like CL_ReadDemoMessage
+==================
+*/
+static qboolean DA_ReadDemoMessage( msg_t *buf ) {
+	int		s, len;
+
+	if ( da.compressed ) {
+		return DemoZ_ReadMessage( &da.dz, buf, &da.serverMessageSequence );
+	}
+
+	if ( FS_Read( &s, 4, da.demo ) != 4 ) {
+		return qfalse;
+	}
+	if ( FS_Read( &len, 4, da.demo ) != 4 ) {
+		return qfalse;
+	}
+	buf->cursize = LittleLong( len );
+	if ( buf->cursize == -1 || ( da.newFormat && !buf->cursize ) ) {
+		return qfalse;
+	}
+	if ( buf->cursize < 0 || buf->cursize > buf->maxsize ) {
+		Com_Printf( "DA_ReadDemoMessage: demoMsglen > MAX_MSGLEN\n" );
+		return qfalse;
+	}
+	if ( FS_Read( buf->data, buf->cursize, da.demo ) != buf->cursize ) {
+		Com_Printf( "Demo file was truncated.\n" );
+		return qfalse;
+	}
+	if ( da.newFormat ) {
+		if ( FS_Read( &len, 4, da.demo ) != 4 || LittleLong( len ) != buf->cursize ) {
+			return qfalse;
+		}
+	}
+
+	da.serverMessageSequence = LittleLong( s );
+	buf->readcount = 0;
+	buf->bit = 0;
+	return qtrue;
+}
+
+/*
+==================
+DA_ReadHeader
+==================
+*/
+static qboolean DA_ReadHeader( const char *path, int size ) {
+	char	modversion[MAX_STRING_CHARS];
+	int		v, len, trailer[2];
+
+	if ( da.compressed ) {
+		return DemoZ_Open( &da.dz, da.demo, size, path );
+	}
+	if ( !da.newFormat ) {
+		return qtrue;
+	}
+
+	if ( FS_Read( &len, 4, da.demo ) != 4 ) {
+		return qfalse;
+	}
+	len = LittleLong( len );
+	if ( len < 0 || len >= sizeof( modversion ) || FS_Read( modversion, len, da.demo ) != len ) {
+		return qfalse;
+	}
+	modversion[len] = '\0';
+	if ( FS_Read( &v, 4, da.demo ) != 4 ) {
+		return qfalse;
+	}
+	Com_Printf( "Demo protocol: %d   Modversion: %s\n", LittleLong( v ), modversion );
+
+	// two zero words follow the new format header
+	return FS_Read( trailer, 8, da.demo ) == 8 && !trailer[0] && !trailer[1];
+}
+
+/*
+==================
+DA_AnalyzeDemo
+==================
+*/
+static void DA_AnalyzeDemo( const char *name ) {
+	static byte	bufData[MAX_MSGLEN];
+	char		path[MAX_OSPATH];
+	const char	*ext;
+	msg_t		buf;
+	int			size, start, msec, count;
+
+	Com_Memset( &da, 0, sizeof( da ) );
+
+	Com_sprintf( path, sizeof( path ), "demos/%s", name );
+	size = FS_FOpenFileRead( path, &da.demo, qtrue );
+	if ( !da.demo ) {
+		Q_strncpyz( path, name, sizeof( path ) );
+		size = FS_FOpenFileRead( path, &da.demo, qtrue );
+	}
+	if ( !da.demo ) {
+		Com_Printf( "Couldn't open %s\n", name );
+		return;
+	}
+
+	da.pe.entities = da.parseEntities;
+	da.pe.mask = DA_MAX_PARSE_ENTITIES - 1;
+	da.pe.baselines = da.baselines;
+
+	ext = COM_GetExtension( path );
+	da.newFormat = !Q_stricmp( ext, NEWDEMOEXT );
+	da.compressed = !Q_stricmp( ext, DEMOZ_EXT );
+
+	if ( !DA_ReadHeader( path, size ) ) {
+		Com_Printf( "%s has a bad demo header.\n", path );
+		FS_FCloseFile( da.demo );
+		DemoZ_Free( &da.dz );
+		return;
+	}
+
+	Q_strcat( path, sizeof( path ), ".ndjson" );
+	da.out = FS_FOpenFileWrite( path );
+	if ( !da.out ) {
+		Com_Printf( "Couldn't write %s\n", path );
+		FS_FCloseFile( da.demo );
+		DemoZ_Free( &da.dz );
+		return;
+	}
+
+	start = Sys_Milliseconds();
+	for ( count = 0; ; count++ ) {
+		MSG_Init( &buf, bufData, sizeof( bufData ) );
+		if ( !DA_ReadDemoMessage( &buf ) || !DA_ParseServerMessage( &buf ) ) {
+			break;
+		}
+	}
+	msec = Sys_Milliseconds() - start;
+
+	FS_FCloseFile( da.out );
+	FS_FCloseFile( da.demo );
+	DemoZ_Free( &da.dz );
+
+	Com_Printf( "%s: %i messages, %i snapshots, %i commands in %i msec (%.0f snapshots/sec)\n",
+		path, count, da.numSnapshots, da.numCommands, msec,
+		msec ? da.numSnapshots * 1000.0f / msec : 0.0f );
+}
+
+/*
+==================
+CL_DemoAnalyze_f
+==================
+*/
+void CL_DemoAnalyze_f( void ) {
+	char	name[MAX_OSPATH];
+	int		i;
+
+	if ( Cmd_Argc() < 2 ) {
+		Com_Printf( "demoanalyze <demo> [demo ...]\n" );
+		return;
+	}
+
+	for ( i = 1; i < Cmd_Argc(); i++ ) {
+		Q_strncpyz( name, Cmd_Argv( i ), sizeof( name ) );
+		DA_AnalyzeDemo( name );
+	}
+}
@@ -466,9 +466,15 @@ void CMod_LoadVisibility( lump_t *l ) {
 	buf = cmod_base + l->fileofs;
 
 	cm.vised = qtrue;
-	cm.visibility = Hunk_Alloc( len, h_high );
 	cm.numClusters = LittleLong( ((int *)buf)[0] );
 	cm.clusterBytes = LittleLong( ((int *)buf)[1] );
+
+	// the vis data is only ever read, so a shared map is used in place
+	if ( cm.shared ) {
+		cm.visibility = buf + VIS_HEADER;
+		return;
+	}
+	cm.visibility = Hunk_Alloc( len, h_high );
 	Com_Memcpy (cm.visibility, buf + VIS_HEADER, len - VIS_HEADER );
 }
 
@@ -559,6 +565,20 @@ unsigned CM_Checksum(dheader_t *header) {
 	return LittleLong(Com_BlockChecksum(checksums, 11 * 4));
 }
 
+/*
+==================
+CM_ReleaseShared
+==================
+*/
+static void CM_ReleaseShared( void ) {
+#ifndef BSPC
+	if ( cm.shared ) {
+		FS_UnmapShared( cm.shared, cm.sharedLength );
+		cm.shared = NULL;
+	}
+#endif
+}
+
 /*
 ==================
 CM_LoadMap
@@ -593,6 +613,7 @@ void CM_LoadMap( const char *name, qboolean clientload, int *checksum ) {
 	}
 
 	// free old stuff
+	CM_ReleaseShared();
 	Com_Memset( &cm, 0, sizeof( cm ) );
 	CM_ClearLevelPatches();
 
@@ -609,7 +630,14 @@ void CM_LoadMap( const char *name, qboolean clientload, int *checksum ) {
 	// load the file
 	//
 #ifndef BSPC
-	length = FS_ReadFile( name, &buf.v );
+	// servers sharing fs_sharedCache map one copy of the file
+	buf.v = FS_MapShared( name, &length );
+	if ( buf.v ) {
+		cm.shared = buf.v;
+		cm.sharedLength = length;
+	} else {
+		length = FS_ReadFile( name, &buf.v );
+	}
 #else
 	length = LoadQuakeFile((quakefile_t *) name, &buf.v);
 #endif
@@ -648,7 +676,9 @@ void CM_LoadMap( const char *name, qboolean clientload, int *checksum ) {
 	CMod_LoadPatches( &header.lumps[LUMP_SURFACES], &header.lumps[LUMP_DRAWVERTS] );
 
 	// we are NOT freeing the file, because it is cached for the ref
-	FS_FreeFile (buf.v);
+	if ( !cm.shared ) {
+		FS_FreeFile (buf.v);
+	}
 
 	CM_InitBoxHull ();
 
@@ -666,6 +696,7 @@ CM_ClearMap
 ==================
 */
 void CM_ClearMap( void ) {
+	CM_ReleaseShared();
 	Com_Memset( &cm, 0, sizeof( cm ) );
 	CM_ClearLevelPatches();
 }
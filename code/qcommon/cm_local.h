@@ -126,6 +126,9 @@ typedef struct {
 
 	int			floodvalid;
 	int			checkcount;					// incremented on each trace
+
+	byte		*shared;					// FS_MapShared bsp, visibility points into it
+	int			sharedLength;
 } clipMap_t;
 
 
@@ -353,11 +353,14 @@ void Cmd_Echo_f (void)
 typedef struct cmd_function_s
 {
 	struct cmd_function_s	*next;
+	struct cmd_function_s	*hashNext;
 	char					*name;
 	xcommand_t				function;
 	completionFunc_t	complete;
 } cmd_function_t;
 
+#define	CMD_HASH_SIZE	512		// must be a power of two
+
 
 static	int			cmd_argc;
 static	char		*cmd_argv[MAX_STRING_TOKENS];		// points into cmd_tokenized
@@ -365,6 +368,77 @@ static	char		cmd_tokenized[BIG_INFO_STRING+MAX_STRING_TOKENS];	// will have 0 by
 static	char		cmd_cmd[BIG_INFO_STRING]; // the original command we received (no token processing)
 
 static	cmd_function_t	*cmd_functions;		// possible commands to execute
+static	cmd_function_t	*cmd_hashTable[CMD_HASH_SIZE];
+
+// where Cmd_ExecuteString found its handler, for cmdstats
+typedef enum {
+	CMDSTAT_COMMAND,
+	CMDSTAT_CVAR,
+	CMDSTAT_CGAME,
+	CMDSTAT_GAME,
+	CMDSTAT_UI,
+	CMDSTAT_FORWARD,
+	CMDSTAT_NUM
+} cmdStat_t;
+
+static const char *cmdStatNames[CMDSTAT_NUM] = {
+	"command",
+	"cvar",
+	"cgame",
+	"game",
+	"ui",
+	"forwarded"
+};
+
+static struct {
+	int					count[CMDSTAT_NUM];
+	unsigned long long	usec[CMDSTAT_NUM];
+	unsigned long long	maxUsec[CMDSTAT_NUM];
+} cmdStats;
+
+/*
+============
+Cmd_HashValue
+
+Case insensitive, same as the cvar hash
+============
+*/
+static int Cmd_HashValue( const char *name ) {
+	int		i;
+	long	hash;
+
+	hash = 0;
+	for ( i = 0 ; name[i] ; i++ ) {
+		hash += (long)tolower( name[i] ) * ( i + 119 );
+	}
+	return hash & ( CMD_HASH_SIZE - 1 );
+}
+
+/*
+============
+Cmd_JoinArgs
+
+Concatenates argv(arg) to argv(argc()-1) separated by spaces in a
+single pass, truncating at bufferLength
+============
+*/
+static void Cmd_JoinArgs( int arg, char *buffer, int bufferLength ) {
+	char	*out, *end;
+	char	*in;
+	int		i;
+
+	out = buffer;
+	end = buffer + bufferLength - 1;
+	for ( i = arg ; i < cmd_argc && out < end ; i++ ) {
+		for ( in = cmd_argv[i] ; *in && out < end ; ) {
+			*out++ = *in++;
+		}
+		if ( i != cmd_argc-1 && out < end ) {
+			*out++ = ' ';
+		}
+	}
+	*out = 0;
+}
 
 /*
 ============
@@ -409,15 +483,8 @@ Returns a single string containing argv(1) to argv(argc()-1)
 */
 char	*Cmd_Args( void ) {
 	static	char		cmd_args[MAX_STRING_CHARS];
-	int		i;
 
-	cmd_args[0] = 0;
-	for ( i = 1 ; i < cmd_argc ; i++ ) {
-		strcat( cmd_args, cmd_argv[i] );
-		if ( i != cmd_argc-1 ) {
-			strcat( cmd_args, " " );
-		}
-	}
+	Cmd_JoinArgs( 1, cmd_args, sizeof( cmd_args ) );
 
 	return cmd_args;
 }
@@ -431,17 +498,10 @@ Returns a single string containing argv(arg) to argv(argc()-1)
 */
 char *Cmd_ArgsFrom( int arg ) {
 	static	char		cmd_args[BIG_INFO_STRING];
-	int		i;
 
-	cmd_args[0] = 0;
 	if (arg < 0)
 		arg = 0;
-	for ( i = arg ; i < cmd_argc ; i++ ) {
-		strcat( cmd_args, cmd_argv[i] );
-		if ( i != cmd_argc-1 ) {
-			strcat( cmd_args, " " );
-		}
-	}
+	Cmd_JoinArgs( arg, cmd_args, sizeof( cmd_args ) );
 
 	return cmd_args;
 }
@@ -516,7 +576,10 @@ static void Cmd_TokenizeString2( const char *text_in, qboolean ignoreQuotes ) {
 		return;
 	}
 	
-	Q_strncpyz( cmd_cmd, text_in, sizeof(cmd_cmd) );
+	// re-tokenizing Cmd_Cmd() must not copy the string onto itself
+	if ( text_in != cmd_cmd ) {
+		Q_strncpyz( cmd_cmd, text_in, sizeof(cmd_cmd) );
+	}
 
 	text = text_in;
 	textOut = cmd_tokenized;
@@ -627,9 +690,11 @@ Cmd_AddCommand
 */
 void	Cmd_AddCommand( const char *cmd_name, xcommand_t function ) {
 	cmd_function_t	*cmd;
+	int				hash;
 	
 	// fail if the command already exists
-	for ( cmd = cmd_functions ; cmd ; cmd=cmd->next ) {
+	hash = Cmd_HashValue( cmd_name );
+	for ( cmd = cmd_hashTable[hash] ; cmd ; cmd=cmd->hashNext ) {
 		if ( !strcmp( cmd_name, cmd->name ) ) {
 			// allow completion-only commands to be silently doubled
 			if ( function != NULL ) {
@@ -646,6 +711,8 @@ void	Cmd_AddCommand( const char *cmd_name, xcommand_t function ) {
 	cmd->complete = NULL;
 	cmd->next = cmd_functions;
 	cmd_functions = cmd;
+	cmd->hashNext = cmd_hashTable[hash];
+	cmd_hashTable[hash] = cmd;
 }
 
 /*
@@ -656,7 +723,7 @@ Cmd_SetCommandCompletionFunc
 void Cmd_SetCommandCompletionFunc( const char *command, completionFunc_t complete ) {
 	cmd_function_t	*cmd;
 
-	for( cmd = cmd_functions; cmd; cmd = cmd->next ) {
+	for( cmd = cmd_hashTable[Cmd_HashValue( command )]; cmd; cmd = cmd->hashNext ) {
 		if( !Q_stricmp( command, cmd->name ) ) {
 			cmd->complete = complete;
 		}
@@ -671,7 +738,7 @@ Cmd_RemoveCommand
 void	Cmd_RemoveCommand( const char *cmd_name ) {
 	cmd_function_t	*cmd, **back;
 
-	back = &cmd_functions;
+	back = &cmd_hashTable[Cmd_HashValue( cmd_name )];
 	while( 1 ) {
 		cmd = *back;
 		if ( !cmd ) {
@@ -679,14 +746,19 @@ void	Cmd_RemoveCommand( const char *cmd_name ) {
 			return;
 		}
 		if ( !strcmp( cmd_name, cmd->name ) ) {
+			*back = cmd->hashNext;
+
+			for ( back = &cmd_functions ; *back != cmd ; back = &(*back)->next ) {
+			}
 			*back = cmd->next;
+
 			if (cmd->name) {
 				Z_Free(cmd->name);
 			}
 			Z_Free (cmd);
 			return;
 		}
-		back = &cmd->next;
+		back = &cmd->hashNext;
 	}
 }
 
@@ -712,7 +784,7 @@ Cmd_CompleteArgument
 void Cmd_CompleteArgument( const char *command, char *args, int argNum ) {
 	cmd_function_t	*cmd;
 
-	for( cmd = cmd_functions; cmd; cmd = cmd->next ) {
+	for( cmd = cmd_hashTable[Cmd_HashValue( command )]; cmd; cmd = cmd->hashNext ) {
 		if( !Q_stricmp( command, cmd->name ) && cmd->complete ) {
 			cmd->complete( args, argNum );
 		}
@@ -728,58 +800,101 @@ A complete command line has been parsed, so try to execute it
 ============
 */
 void	Cmd_ExecuteString( const char *text ) {	
-	cmd_function_t	*cmd, **prev;
+	cmd_function_t	*cmd;
+	cmdStat_t		stat;
+	unsigned long long	start, usec;
+
+	start = Sys_Microseconds();
 
-	// execute the command line
+	// execute the command line, everything below works off this
+	// single tokenization
 	Cmd_TokenizeString( text );		
 	if ( !Cmd_Argc() ) {
 		return;		// no tokens
 	}
 
 	// check registered command functions	
-	for ( prev = &cmd_functions ; *prev ; prev = &cmd->next ) {
-		cmd = *prev;
+	for ( cmd = cmd_hashTable[Cmd_HashValue( cmd_argv[0] )] ; cmd ; cmd = cmd->hashNext ) {
 		if ( !Q_stricmp( cmd_argv[0],cmd->name ) ) {
-			// rearrange the links so that the command will be
-			// near the head of the list next time it is used
-			*prev = cmd->next;
-			cmd->next = cmd_functions;
-			cmd_functions = cmd;
-
-			// perform the action
-			if ( !cmd->function ) {
-				// let the cgame or game handle it
-				break;
-			} else {
-				cmd->function ();
-			}
-			return;
+			break;
 		}
 	}
-	
-	// check cvars
-	if ( Cvar_Command() ) {
-		return;
+
+	if ( cmd && cmd->function ) {
+		// perform the action
+		cmd->function ();
+		stat = CMDSTAT_COMMAND;
+	}
+	// a completion-only command lets the cgame or game handle it
+	else if ( Cvar_Command() ) {
+		// check cvars
+		stat = CMDSTAT_CVAR;
+	}
+	else if ( com_cl_running && com_cl_running->integer && CL_GameCommand() ) {
+		// check client game commands
+		stat = CMDSTAT_CGAME;
+	}
+	else if ( com_sv_running && com_sv_running->integer && SV_GameCommand() ) {
+		// check server game commands
+		stat = CMDSTAT_GAME;
+	}
+	else if ( com_cl_running && com_cl_running->integer && UI_GameCommand() ) {
+		// check ui commands
+		stat = CMDSTAT_UI;
+	}
+	else {
+		// send it as a server command if we are connected
+		// this will usually result in a chat message
+		CL_ForwardCommandToServer ( text );
+		stat = CMDSTAT_FORWARD;
 	}
 
-	// check client game commands
-	if ( com_cl_running && com_cl_running->integer && CL_GameCommand() ) {
-		return;
+	usec = Sys_Microseconds() - start;
+	cmdStats.count[stat]++;
+	cmdStats.usec[stat] += usec;
+	if ( usec > cmdStats.maxUsec[stat] ) {
+		cmdStats.maxUsec[stat] = usec;
 	}
+}
 
-	// check server game commands
-	if ( com_sv_running && com_sv_running->integer && SV_GameCommand() ) {
+/*
+============
+Cmd_Stats_f
+
+Where console, rcon and config commands ended up and what they cost
+============
+*/
+static void Cmd_Stats_f( void ) {
+	int		i, chains, longest, length;
+	cmd_function_t	*cmd;
+
+	if ( Cmd_Argc() > 1 && !Q_stricmp( Cmd_Argv( 1 ), "reset" ) ) {
+		Com_Memset( &cmdStats, 0, sizeof( cmdStats ) );
 		return;
 	}
 
-	// check ui commands
-	if ( com_cl_running && com_cl_running->integer && UI_GameCommand() ) {
-		return;
+	for ( i = 0 ; i < CMDSTAT_NUM ; i++ ) {
+		if ( !cmdStats.count[i] ) {
+			continue;
+		}
+		Com_Printf( "%-10s %8i calls %8.2f usec avg %8llu max\n", cmdStatNames[i], cmdStats.count[i],
+			(double)cmdStats.usec[i] / cmdStats.count[i], cmdStats.maxUsec[i] );
 	}
 
-	// send it as a server command if we are connected
-	// this will usually result in a chat message
-	CL_ForwardCommandToServer ( text );
+	chains = longest = 0;
+	for ( i = 0 ; i < CMD_HASH_SIZE ; i++ ) {
+		length = 0;
+		for ( cmd = cmd_hashTable[i] ; cmd ; cmd = cmd->hashNext ) {
+			length++;
+		}
+		if ( length ) {
+			chains++;
+		}
+		if ( length > longest ) {
+			longest = length;
+		}
+	}
+	Com_Printf( "%i of %i hash chains used, longest %i\n", chains, CMD_HASH_SIZE, longest );
 }
 
 /*
@@ -827,6 +942,7 @@ Cmd_Init
 */
 void Cmd_Init (void) {
 	Cmd_AddCommand ("cmdlist",Cmd_List_f);
+	Cmd_AddCommand ("cmdstats",Cmd_Stats_f);
 	Cmd_AddCommand ("exec",Cmd_Exec_f);
 	Cmd_SetCommandCompletionFunc( "exec", Cmd_CompleteCfgName );
 	Cmd_AddCommand ("vstr",Cmd_Vstr_f);
@@ -34,7 +34,6 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include "../ioq3-urt/ioq3-urt.h"
 
 extern cvar_t *com_quiet;
-extern unsigned long long Sys_Microseconds(void);
 
 int demo_protocols[] =
 { 66, 67, 68, 0 };
@@ -60,7 +59,6 @@ fileHandle_t    com_journalFile;                        // events are written he
 fileHandle_t    com_journalDataFile;            // config files are written here
 
 cvar_t  *com_speeds;
-cvar_t  *com_speeds2;
 cvar_t  *com_developer;
 cvar_t  *com_dedicated;
 cvar_t  *com_timescale;
@@ -214,6 +212,10 @@ void QDECL Com_Printf( const char *fmt, ... ) {
                                         // data even if we are crashing
                                         FS_ForceFlush(logfile);
                                 }
+
+                                // hand it to the writer thread, logfile 2 still
+                                // gets flushed as soon as the writer catches up
+                                AsyncLog_Open( logfile, com_logfile->integer > 1 );
                         }
                         else
                         {
@@ -224,7 +226,7 @@ void QDECL Com_Printf( const char *fmt, ... ) {
       opening_qconsole = qfalse;
                 }
                 if ( logfile && FS_Initialized()) {
-                        FS_Write(msg, strlen(msg), logfile);
+                        AsyncLog_Write(logfile, msg, strlen(msg));
                 }
         }
 
@@ -1093,7 +1095,7 @@ void Z_LogZoneHeap( memzone_t *zone, char *name ) {
                 return;
         size = allocSize = numBlocks = 0;
         Com_sprintf(buf, sizeof(buf), "\r\n================\r\n%s log\r\n================\r\n", name);
-        FS_Write(buf, strlen(buf), logfile);
+        AsyncLog_Write(logfile, buf, strlen(buf));
         for (block = zone->blocklist.next ; block->next != &zone->blocklist; block = block->next) {
                 if (block->tag) {
 #ifdef ZONE_DEBUG
@@ -1109,7 +1111,7 @@ void Z_LogZoneHeap( memzone_t *zone, char *name ) {
                         }
                         dump[j] = '\0';
                         Com_sprintf(buf, sizeof(buf), "size = %8d: %s, line: %d (%s) [%s]\r\n", block->d.allocSize, block->d.file, block->d.line, block->d.label, dump);
-                        FS_Write(buf, strlen(buf), logfile);
+                        AsyncLog_Write(logfile, buf, strlen(buf));
                         allocSize += block->d.allocSize;
 #endif
                         size += block->size;
@@ -1123,9 +1125,9 @@ void Z_LogZoneHeap( memzone_t *zone, char *name ) {
         allocSize = numBlocks * sizeof(memblock_t); // + 32 bit alignment
 #endif
         Com_sprintf(buf, sizeof(buf), "%d %s memory in %d blocks\r\n", size, name, numBlocks);
-        FS_Write(buf, strlen(buf), logfile);
+        AsyncLog_Write(logfile, buf, strlen(buf));
         Com_sprintf(buf, sizeof(buf), "%d %s memory overhead\r\n", size - allocSize, name);
-        FS_Write(buf, strlen(buf), logfile);
+        AsyncLog_Write(logfile, buf, strlen(buf));
 }
 
 /*
@@ -1452,22 +1454,22 @@ void Hunk_Log( void) {
         size = 0;
         numBlocks = 0;
         Com_sprintf(buf, sizeof(buf), "\r\n================\r\nHunk log\r\n================\r\n");
-        FS_Write(buf, strlen(buf), logfile);
+        AsyncLog_Write(logfile, buf, strlen(buf));
         for (block = hunkblocks ; block; block = block->next) {
 #ifdef HUNK_DEBUG
                 Com_sprintf(buf, sizeof(buf), "%p: [%X] size = %8d: %s, line: %d (%s)\r\n",
                  ((char*)block)+sizeof(hunkblock_t),  *(unsigned int*)(((char*)block)+sizeof(hunkblock_t)+block->size-sizeof(unsigned int)),
                  block->size, block->file, block->line, block->label);
 
-                FS_Write(buf, strlen(buf), logfile);
+                AsyncLog_Write(logfile, buf, strlen(buf));
 #endif
                 size += block->size;
                 numBlocks++;
         }
         Com_sprintf(buf, sizeof(buf), "%d Hunk memory\r\n", size);
-        FS_Write(buf, strlen(buf), logfile);
+        AsyncLog_Write(logfile, buf, strlen(buf));
         Com_sprintf(buf, sizeof(buf), "%d hunk blocks\r\n", numBlocks);
-        FS_Write(buf, strlen(buf), logfile);
+        AsyncLog_Write(logfile, buf, strlen(buf));
 }
 
 /*
@@ -1488,7 +1490,7 @@ void Hunk_SmallLog( void) {
         size = 0;
         numBlocks = 0;
         Com_sprintf(buf, sizeof(buf), "\r\n================\r\nHunk Small log\r\n================\r\n");
-        FS_Write(buf, strlen(buf), logfile);
+        AsyncLog_Write(logfile, buf, strlen(buf));
         for (block = hunkblocks; block; block = block->next) {
                 if (block->printed) {
                         continue;
@@ -1507,15 +1509,15 @@ void Hunk_SmallLog( void) {
                 }
 #ifdef HUNK_DEBUG
                 Com_sprintf(buf, sizeof(buf), "size = %8d: %s, line: %d (%s)\r\n", locsize, block->file, block->line, block->label);
-                FS_Write(buf, strlen(buf), logfile);
+                AsyncLog_Write(logfile, buf, strlen(buf));
 #endif
                 size += block->size;
                 numBlocks++;
         }
         Com_sprintf(buf, sizeof(buf), "%d Hunk memory\r\n", size);
-        FS_Write(buf, strlen(buf), logfile);
+        AsyncLog_Write(logfile, buf, strlen(buf));
         Com_sprintf(buf, sizeof(buf), "%d hunk blocks\r\n", numBlocks);
-        FS_Write(buf, strlen(buf), logfile);
+        AsyncLog_Write(logfile, buf, strlen(buf));
 }
 
 /*
@@ -1918,6 +1920,11 @@ EVENTS AND JOURNALING
 
 In addition to these events, .cfg files are also copied to the
 journaled file
+
+Inbound packets are SE_PACKET events with their arrival time, so a
+journal recorded on a dedicated server holds the whole packet stream.
+Replaying it with "+set journal 3" and the original command line turns
+it into a server benchmark, see Com_BenchmarkReport.
 ===================================================================
 */
 
@@ -1926,6 +1933,130 @@ static int com_pushedEventsHead = 0;
 static int com_pushedEventsTail = 0;
 static sysEvent_t       com_pushedEvents[MAX_PUSHED_EVENTS];
 
+typedef struct {
+        int             packet;                 // usec spent in SV_PacketEvent since the last frame
+        int             game;
+        int             snapshot;
+} benchFrame_t;
+
+static benchFrame_t     *com_benchFrames;
+static int              com_benchNumFrames;
+static int              com_benchMaxFrames;
+static int              com_benchPackets;
+static unsigned long long       com_benchPacketUsec;
+static unsigned long long       com_benchStart;
+static int              com_benchFirstTime;
+static int              com_benchLastTime;
+
+/*
+=================
+Com_BenchmarkFrame
+
+Called by SV_Frame for every frame that ran the game during a
+journal 3 replay
+=================
+*/
+void Com_BenchmarkFrame( int gameUsec, int snapshotUsec ) {
+        benchFrame_t    *frame;
+
+        if ( com_benchNumFrames == com_benchMaxFrames ) {
+                com_benchMaxFrames = com_benchMaxFrames ? com_benchMaxFrames * 2 : 4096;
+                com_benchFrames = realloc( com_benchFrames, com_benchMaxFrames * sizeof( *com_benchFrames ) );
+                if ( !com_benchFrames ) {
+                        Com_Error( ERR_FATAL, "Com_BenchmarkFrame: out of memory" );
+                }
+        }
+
+        frame = &com_benchFrames[com_benchNumFrames++];
+        frame->packet = com_benchPacketUsec;
+        frame->game = gameUsec;
+        frame->snapshot = snapshotUsec;
+        com_benchPacketUsec = 0;
+}
+
+static int QDECL Com_BenchmarkCompare( const void *a, const void *b ) {
+        return *(const int *)a - *(const int *)b;
+}
+
+/*
+=================
+Com_BenchmarkPrintRow
+=================
+*/
+static void Com_BenchmarkPrintRow( const char *name, int *usec, int count ) {
+        unsigned long long      sum;
+        int                     i;
+
+        sum = 0;
+        for ( i = 0; i < count; i++ ) {
+                sum += usec[i];
+        }
+        qsort( usec, count, sizeof( int ), Com_BenchmarkCompare );
+
+        Com_Printf( "%-10s %8i %8i %8i %8i\n", name, usec[count / 2], usec[count * 99 / 100],
+                usec[count - 1], (int)( sum / count ) );
+}
+
+/*
+=================
+Com_BenchmarkReport
+
+Prints p50/p99/max per stage over every replayed frame and writes
+the raw numbers to journalbench.csv
+=================
+*/
+static void Com_BenchmarkReport( void ) {
+        fileHandle_t    f;
+        int             *usec;
+        int             i, wall, recorded;
+
+        wall = ( Sys_Microseconds() - com_benchStart ) / 1000;
+        recorded = com_benchLastTime - com_benchFirstTime;
+
+        Com_Printf( "-------- journal benchmark --------\n" );
+        Com_Printf( "%i frames, %i packets, %i msec of play replayed in %i msec", com_benchNumFrames, com_benchPackets, recorded, wall );
+        if ( wall > 0 ) {
+                Com_Printf( " (%.1fx realtime)", (float)recorded / wall );
+        }
+        Com_Printf( "\n" );
+        if ( !com_benchNumFrames ) {
+                return;
+        }
+
+        f = FS_FOpenFileWrite( "journalbench.csv" );
+        if ( f ) {
+                FS_Printf( f, "frame,packet_usec,game_usec,snapshot_usec\n" );
+                for ( i = 0; i < com_benchNumFrames; i++ ) {
+                        FS_Printf( f, "%i,%i,%i,%i\n", i, com_benchFrames[i].packet,
+                                com_benchFrames[i].game, com_benchFrames[i].snapshot );
+                }
+                FS_FCloseFile( f );
+        }
+
+        // sort each column on its own
+        usec = Z_Malloc( com_benchNumFrames * sizeof( int ) );
+        Com_Printf( "usec            p50      p99      max     mean\n" );
+        for ( i = 0; i < com_benchNumFrames; i++ ) {
+                usec[i] = com_benchFrames[i].packet;
+        }
+        Com_BenchmarkPrintRow( "packets", usec, com_benchNumFrames );
+        for ( i = 0; i < com_benchNumFrames; i++ ) {
+                usec[i] = com_benchFrames[i].game;
+        }
+        Com_BenchmarkPrintRow( "game", usec, com_benchNumFrames );
+        for ( i = 0; i < com_benchNumFrames; i++ ) {
+                usec[i] = com_benchFrames[i].snapshot;
+        }
+        Com_BenchmarkPrintRow( "snapshots", usec, com_benchNumFrames );
+        for ( i = 0; i < com_benchNumFrames; i++ ) {
+                usec[i] = com_benchFrames[i].packet + com_benchFrames[i].game + com_benchFrames[i].snapshot;
+        }
+        Com_BenchmarkPrintRow( "total", usec, com_benchNumFrames );
+        Z_Free( usec );
+
+        Com_Printf( "per-frame numbers written to journalbench.csv\n" );
+}
+
 /*
 =================
 Com_InitJournaling
@@ -1942,7 +2073,7 @@ void Com_InitJournaling( void ) {
                 Com_Printf( "Journaling events\n");
                 com_journalFile = FS_FOpenFileWrite( "journal.dat" );
                 com_journalDataFile = FS_FOpenFileWrite( "journaldata.dat" );
-        } else if ( com_journal->integer == 2 ) {
+        } else if ( com_journal->integer == 2 || com_journal->integer == JOURNAL_BENCHMARK ) {
                 Com_Printf( "Replaying journaled events\n");
                 FS_FOpenFileRead( "journal.dat", &com_journalFile, qtrue );
                 FS_FOpenFileRead( "journaldata.dat", &com_journalDataFile, qtrue );
@@ -1964,112 +2095,395 @@ EVENT LOOP
 ========================================================================
 */
 
-#define MAX_QUEUED_EVENTS  256
-#define MASK_QUEUED_EVENTS ( MAX_QUEUED_EVENTS - 1 )
+/*
+
+System events go through three single producer, single consumer rings:
+input events, console lines and network packets.  Each slot is a fixed
+size record, so nothing is allocated per event, and head and tail are
+only ever written by one side, so a producer on another thread needs no
+lock.  A full ring drops the new event instead of an old one.
+
+Unless journaling, Com_EventLoop drains the rings in batches, input first,
+then console, then network, and dispatches straight from the slots.  The
+journal code still deals in sysEvent_t with allocated data, those are
+built from the rings one at a time by Com_GetSystemEvent.
+
+Every event is stamped on arrival and the time it waited is recorded
+under the event_latency perf scope.  Packets are always stamped, with
+Sys_Microseconds, the netchan keeps a per connection average of the
+delay, see com_packetArrival.
+
+*/
+
+#define MAX_INPUT_EVENTS        256
+#define MAX_CONSOLE_EVENTS      16
+#define MAX_PACKET_EVENTS       64
+
+typedef struct {
+        volatile int    head;           // only written by the producer
+        volatile int    tail;           // only written by the consumer
+        int             dropped;        // producer side
+        int             reported;       // consumer side
+} eventRing_t;
+
+typedef struct {
+        perfTime_t      arrival;
+        int             time;
+        sysEventType_t  type;
+        int             value, value2;
+} inputEvent_t;
+
+typedef struct {
+        perfTime_t      arrival;
+        int             time;
+        char            text[MAX_STRING_CHARS];
+} consoleEvent_t;
+
+typedef struct {
+        perfTime_t      arrival;
+        int             time;
+        netadr_t        from;
+        int             length;
+        byte            data[MAX_MSGLEN];
+} packetEvent_t;
+
+static eventRing_t      inputRing, consoleRing, packetRing;
+
+// arrival of the packet being dispatched, 0 for loopback and journaled ones
+unsigned long long      com_packetArrival;
+static inputEvent_t     inputEvents[MAX_INPUT_EVENTS];
+static consoleEvent_t   consoleEvents[MAX_CONSOLE_EVENTS];
+static packetEvent_t    packetEvents[MAX_PACKET_EVENTS];
+
+// the receive thread waits on this while the packet ring is full,
+// so datagrams stay in the socket buffer instead of being dropped
+static void             *packetSpace;
+static volatile int     packetSpaceWaiting;
+
+/*
+================
+Com_RingReserve
+
+Producer side, returns the slot to fill or -1 when the ring is full
+================
+*/
+static int Com_RingReserve( eventRing_t *ring, int size )
+{
+        if ( ring->head - ring->tail >= size )
+        {
+                ring->dropped++;
+                return -1;
+        }
+        return ring->head & ( size - 1 );
+}
+
+/*
+================
+Com_RingCommit
+
+Producer side, publishes the slot Com_RingReserve returned
+================
+*/
+static void Com_RingCommit( eventRing_t *ring )
+{
+        Sys_MemoryBarrier();
+        ring->head++;
+}
+
+/*
+================
+Com_RingPending
+
+Consumer side, number of slots that can be read from tail on
+================
+*/
+static int Com_RingPending( eventRing_t *ring )
+{
+        int     pending;
+
+        pending = ring->head - ring->tail;
+        Sys_MemoryBarrier();
+
+        if ( ring->dropped != ring->reported )
+        {
+                Com_DPrintf( "WARNING: %i system events dropped\n", ring->dropped - ring->reported );
+                ring->reported = ring->dropped;
+        }
+        return pending;
+}
+
+/*
+================
+Com_RingRelease
+
+Consumer side, gives the tail slot back once everything needed is copied out
+================
+*/
+static void Com_RingRelease( eventRing_t *ring )
+{
+        Sys_MemoryBarrier();
+        ring->tail++;
+}
+
+/*
+================
+Com_ReleasePacketSlot
 
-static sysEvent_t  eventQueue[ MAX_QUEUED_EVENTS ];
-static int         eventHead = 0;
-static int         eventTail = 0;
-static byte        sys_packetReceived[ MAX_MSGLEN ];
+Consumer side of the packet ring, wakes a receive thread waiting for room
+================
+*/
+static void Com_ReleasePacketSlot( void )
+{
+        Com_RingRelease( &packetRing );
+        Sys_MemoryBarrier();
+
+        if ( packetSpaceWaiting )
+        {
+                packetSpaceWaiting = 0;
+                Sys_SemaphorePost( packetSpace );
+        }
+}
+
+/*
+================
+Com_WaitPacketSpace
+
+Producer side, returns qtrue once the packet ring has a free slot
+or qfalse if there still is none after msec
+================
+*/
+qboolean Com_WaitPacketSpace( int msec )
+{
+        if ( packetRing.head - packetRing.tail < MAX_PACKET_EVENTS )
+        {
+                return qtrue;
+        }
+
+        if ( !packetSpace )
+        {
+                Sys_ThreadSleep( msec );
+                return packetRing.head - packetRing.tail < MAX_PACKET_EVENTS;
+        }
+
+        // set the flag before looking again, so a release in between
+        // either is seen here or posts the semaphore
+        packetSpaceWaiting = 1;
+        Sys_MemoryBarrier();
+        if ( packetRing.head - packetRing.tail >= MAX_PACKET_EVENTS )
+        {
+                Sys_SemaphoreWait( packetSpace, msec );
+        }
+        packetSpaceWaiting = 0;
+
+        return packetRing.head - packetRing.tail < MAX_PACKET_EVENTS;
+}
 
 /*
 ================
 Com_QueueEvent
 
-A time of 0 will get the current time
-Ptr should either be null, or point to a block of data that can
-be freed by the game later.
+A time of 0 will get the current time.
+Ptr should either be null, or point to a Z_Malloc'd block, which is
+copied into the rings and freed here.
 ================
 */
 void Com_QueueEvent( int time, sysEventType_t type, int value, int value2, int ptrLength, void *ptr )
 {
-        sysEvent_t  *ev;
+        inputEvent_t    *ev;
+        int             slot;
 
-        ev = &eventQueue[ eventHead & MASK_QUEUED_EVENTS ];
-
-        if ( eventHead - eventTail >= MAX_QUEUED_EVENTS )
+        if ( type == SE_CONSOLE || type == SE_PACKET )
         {
-                Com_Printf("Com_QueueEvent: overflow\n");
-                // we are discarding an event, but don't leak memory
-                if ( ev->evPtr )
+                if ( type == SE_CONSOLE )
                 {
-                        Z_Free( ev->evPtr );
+                        Com_QueueConsoleEvent( (char *)ptr );
                 }
-                eventTail++;
+                else if ( ptrLength >= sizeof( netadr_t ) )
+                {
+                        Com_QueuePacketEvent( (netadr_t *)ptr, (byte *)ptr + sizeof( netadr_t ), ptrLength - sizeof( netadr_t ) );
+                }
+                if ( ptr )
+                {
+                        Z_Free( ptr );
+                }
+                return;
         }
 
-        eventHead++;
+        slot = Com_RingReserve( &inputRing, MAX_INPUT_EVENTS );
+        if ( slot < 0 )
+        {
+                return;
+        }
 
         if ( time == 0 )
         {
                 time = Sys_Milliseconds();
         }
 
-        ev->evTime = time;
-        ev->evType = type;
-        ev->evValue = value;
-        ev->evValue2 = value2;
-        ev->evPtrLength = ptrLength;
-        ev->evPtr = ptr;
+        ev = &inputEvents[slot];
+        ev->arrival = Perf_Begin();
+        ev->time = time;
+        ev->type = type;
+        ev->value = value;
+        ev->value2 = value2;
+
+        Com_RingCommit( &inputRing );
 }
 
 /*
 ================
-Com_GetSystemEvent
+Com_QueueConsoleEvent
+================
+*/
+void Com_QueueConsoleEvent( const char *text )
+{
+        consoleEvent_t  *ev;
+        int             slot;
+
+        slot = Com_RingReserve( &consoleRing, MAX_CONSOLE_EVENTS );
+        if ( slot < 0 )
+        {
+                return;
+        }
 
+        ev = &consoleEvents[slot];
+        ev->arrival = Perf_Begin();
+        ev->time = Sys_Milliseconds();
+        Q_strncpyz( ev->text, text, sizeof( ev->text ) );
+
+        Com_RingCommit( &consoleRing );
+}
+
+/*
+================
+Com_QueuePacketEvent
 ================
 */
-sysEvent_t Com_GetSystemEvent( void )
+void Com_QueuePacketEvent( const netadr_t *from, const byte *data, int length )
 {
-        sysEvent_t  ev;
-        char        *s;
-        msg_t       netmsg;
-        netadr_t    adr;
+        packetEvent_t   *ev;
+        int             slot;
+
+        if ( (unsigned)length > MAX_MSGLEN )
+        {
+                return;
+        }
 
-        // return if we have data
-        if ( eventHead > eventTail )
+        slot = Com_RingReserve( &packetRing, MAX_PACKET_EVENTS );
+        if ( slot < 0 )
         {
-                eventTail++;
-                return eventQueue[ ( eventTail - 1 ) & MASK_QUEUED_EVENTS ];
+                return;
         }
 
-        // check for console commands
+        ev = &packetEvents[slot];
+        ev->arrival = Sys_Microseconds();
+        ev->time = Sys_Milliseconds();
+        ev->from = *from;
+        ev->length = length;
+        Com_Memcpy( ev->data, data, length );
+
+        Com_RingCommit( &packetRing );
+}
+
+/*
+================
+Com_PollSystemEvents
+
+Moves console input and every waiting packet into the rings,
+packets are received straight into their slot
+================
+*/
+static void Com_PollSystemEvents( void )
+{
+        packetEvent_t   *ev;
+        msg_t           netmsg;
+        char            *s;
+        int             slot;
+
         s = Sys_ConsoleInput();
         if ( s )
         {
-                char  *b;
-                int   len;
-
-                len = strlen( s ) + 1;
-                b = Z_Malloc( len );
-                strcpy( b, s );
-                Com_QueueEvent( 0, SE_CONSOLE, 0, 0, len, b );
+                Com_QueueConsoleEvent( s );
         }
 
-        // check for network packets
-        MSG_Init( &netmsg, sys_packetReceived, sizeof( sys_packetReceived ) );
-        if ( Sys_GetPacket ( &adr, &netmsg ) )
+        while ( packetRing.head - packetRing.tail < MAX_PACKET_EVENTS )
         {
-                netadr_t  *buf;
-                int       len;
+                slot = packetRing.head & ( MAX_PACKET_EVENTS - 1 );
+                ev = &packetEvents[slot];
 
-                // copy out to a seperate buffer for qeueing
-                len = sizeof( netadr_t ) + netmsg.cursize;
-                buf = Z_Malloc( len );
-                *buf = adr;
-                memcpy( buf+1, netmsg.data, netmsg.cursize );
-                Com_QueueEvent( 0, SE_PACKET, 0, 0, len, buf );
+                MSG_Init( &netmsg, ev->data, sizeof( ev->data ) );
+                if ( !Sys_GetPacket( &ev->from, &netmsg ) )
+                {
+                        break;
+                }
+                ev->arrival = Sys_Microseconds();
+                ev->time = Sys_Milliseconds();
+                ev->length = netmsg.cursize;
+
+                Com_RingCommit( &packetRing );
         }
+}
+
+/*
+================
+Com_GetSystemEvent
 
-        // return if we have data
-        if ( eventHead > eventTail )
+One event from the rings as a sysEvent_t, for the journal code
+================
+*/
+sysEvent_t Com_GetSystemEvent( void )
+{
+        sysEvent_t      ev;
+        inputEvent_t    *in;
+        consoleEvent_t  *con;
+        packetEvent_t   *pkt;
+        netadr_t        *buf;
+
+        Com_PollSystemEvents();
+
+        memset( &ev, 0, sizeof( ev ) );
+
+        if ( Com_RingPending( &inputRing ) )
+        {
+                in = &inputEvents[inputRing.tail & ( MAX_INPUT_EVENTS - 1 )];
+                Perf_End( PERF_EVENT_LATENCY, in->arrival );
+                ev.evTime = in->time;
+                ev.evType = in->type;
+                ev.evValue = in->value;
+                ev.evValue2 = in->value2;
+                Com_RingRelease( &inputRing );
+                return ev;
+        }
+
+        if ( Com_RingPending( &consoleRing ) )
         {
-                eventTail++;
-                return eventQueue[ ( eventTail - 1 ) & MASK_QUEUED_EVENTS ];
+                con = &consoleEvents[consoleRing.tail & ( MAX_CONSOLE_EVENTS - 1 )];
+                Perf_End( PERF_EVENT_LATENCY, con->arrival );
+                ev.evTime = con->time;
+                ev.evType = SE_CONSOLE;
+                ev.evPtrLength = strlen( con->text ) + 1;
+                ev.evPtr = Z_Malloc( ev.evPtrLength );
+                Com_Memcpy( ev.evPtr, con->text, ev.evPtrLength );
+                Com_RingRelease( &consoleRing );
+                return ev;
+        }
+
+        if ( Com_RingPending( &packetRing ) )
+        {
+                pkt = &packetEvents[packetRing.tail & ( MAX_PACKET_EVENTS - 1 )];
+                Perf_End( PERF_EVENT_LATENCY, pkt->arrival );
+                ev.evTime = pkt->time;
+                ev.evType = SE_PACKET;
+                ev.evPtrLength = sizeof( netadr_t ) + pkt->length;
+                buf = Z_Malloc( ev.evPtrLength );
+                *buf = pkt->from;
+                Com_Memcpy( buf + 1, pkt->data, pkt->length );
+                ev.evPtr = buf;
+                Com_ReleasePacketSlot();
+                return ev;
         }
 
         // create an empty event to return
-        memset( &ev, 0, sizeof( ev ) );
         ev.evTime = Sys_Milliseconds();
 
         return ev;
@@ -2085,9 +2499,13 @@ sysEvent_t      Com_GetRealEvent( void ) {
         sysEvent_t      ev;
 
         // either get an event from the system or the journal file
-        if ( com_journal->integer == 2 ) {
+        if ( com_journal->integer == 2 || com_journal->integer == JOURNAL_BENCHMARK ) {
                 r = FS_Read( &ev, sizeof(ev), com_journalFile );
                 if ( r != sizeof(ev) ) {
+                        if ( com_journal->integer == JOURNAL_BENCHMARK ) {
+                                Com_BenchmarkReport();
+                                Com_Quit_f();
+                        }
                         Com_Error( ERR_FATAL, "Error reading from journal file" );
                 }
                 if ( ev.evPtrLength ) {
@@ -2097,6 +2515,13 @@ sysEvent_t      Com_GetRealEvent( void ) {
                                 Com_Error( ERR_FATAL, "Error reading from journal file" );
                         }
                 }
+                if ( com_journal->integer == JOURNAL_BENCHMARK ) {
+                        if ( !com_benchStart ) {
+                                com_benchStart = Sys_Microseconds();
+                                com_benchFirstTime = ev.evTime;
+                        }
+                        com_benchLastTime = ev.evTime;
+                }
         } else {
                 ev = Com_GetSystemEvent();
 
@@ -2186,6 +2611,7 @@ Com_RunAndTimeServerPacket
 */
 void Com_RunAndTimeServerPacket( netadr_t *evFrom, msg_t *buf ) {
         int             t1, t2, msec;
+        unsigned long long      start;
 
         t1 = 0;
 
@@ -2193,7 +2619,14 @@ void Com_RunAndTimeServerPacket( netadr_t *evFrom, msg_t *buf ) {
                 t1 = Sys_Milliseconds ();
         }
 
-        SV_PacketEvent( *evFrom, buf );
+        if ( com_journal->integer == JOURNAL_BENCHMARK ) {
+                start = Sys_Microseconds();
+                SV_PacketEvent( *evFrom, buf );
+                com_benchPacketUsec += Sys_Microseconds() - start;
+                com_benchPackets++;
+        } else {
+                SV_PacketEvent( *evFrom, buf );
+        }
 
         if ( com_speeds->integer ) {
                 t2 = Sys_Milliseconds ();
@@ -2204,6 +2637,109 @@ void Com_RunAndTimeServerPacket( netadr_t *evFrom, msg_t *buf ) {
         }
 }
 
+/*
+=================
+Com_PacketEvent
+=================
+*/
+static void Com_PacketEvent( netadr_t *evFrom, msg_t *buf ) {
+        // this cvar allows simulation of connections that
+        // drop a lot of packets.  Note that loopback connections
+        // don't go through here at all.
+        if ( com_dropsim->value > 0 ) {
+                static int seed;
+
+                if ( Q_random( &seed ) < com_dropsim->value ) {
+                        return;         // drop this packet
+                }
+        }
+
+        if ( com_sv_running->integer ) {
+                Com_RunAndTimeServerPacket( evFrom, buf );
+        } else {
+                CL_PacketEvent( *evFrom, buf );
+        }
+}
+
+/*
+=================
+Com_DispatchRings
+
+Runs everything in the event rings, returns the number of events
+=================
+*/
+static int Com_DispatchRings( msg_t *buf ) {
+        inputEvent_t    in;
+        consoleEvent_t  *con;
+        packetEvent_t   *pkt;
+        netadr_t        evFrom;
+        perfTime_t      arrival;
+        char            text[MAX_STRING_CHARS];
+        int             i, count, handled;
+
+        handled = 0;
+
+        // slots are released before dispatching, so an error
+        // thrown from a handler doesn't run the event again
+        count = Com_RingPending( &inputRing );
+        for ( i = 0 ; i < count ; i++ ) {
+                in = inputEvents[inputRing.tail & ( MAX_INPUT_EVENTS - 1 )];
+                Com_RingRelease( &inputRing );
+                Perf_End( PERF_EVENT_LATENCY, in.arrival );
+
+                switch ( in.type ) {
+                case SE_KEY:
+                        CL_KeyEvent( in.value, in.value2, in.time );
+                        break;
+                case SE_CHAR:
+                        CL_CharEvent( in.value );
+                        break;
+                case SE_MOUSE:
+                        CL_MouseEvent( in.value, in.value2, in.time );
+                        break;
+                case SE_JOYSTICK_AXIS:
+                        CL_JoystickEvent( in.value, in.value2, in.time );
+                        break;
+                default:
+                        break;
+                }
+        }
+        handled += count;
+
+        count = Com_RingPending( &consoleRing );
+        for ( i = 0 ; i < count ; i++ ) {
+                con = &consoleEvents[consoleRing.tail & ( MAX_CONSOLE_EVENTS - 1 )];
+                Perf_End( PERF_EVENT_LATENCY, con->arrival );
+                Q_strncpyz( text, con->text, sizeof( text ) );
+                Com_RingRelease( &consoleRing );
+
+                Cbuf_AddText( text );
+                Cbuf_AddText( "\n" );
+        }
+        handled += count;
+
+        count = Com_RingPending( &packetRing );
+        for ( i = 0 ; i < count ; i++ ) {
+                pkt = &packetEvents[packetRing.tail & ( MAX_PACKET_EVENTS - 1 )];
+                Perf_End( PERF_EVENT_LATENCY, pkt->arrival );
+
+                // channel messages need room for fragment reassembly,
+                // and the slot may be refilled once it is released
+                evFrom = pkt->from;
+                arrival = pkt->arrival;
+                buf->cursize = pkt->length;
+                Com_Memcpy( buf->data, pkt->data, buf->cursize );
+                Com_ReleasePacketSlot();
+
+                com_packetArrival = arrival;
+                Com_PacketEvent( &evFrom, buf );
+                com_packetArrival = 0;
+        }
+        handled += count;
+
+        return handled;
+}
+
 /*
 =================
 Com_EventLoop
@@ -2216,18 +2752,38 @@ int Com_EventLoop( void ) {
         netadr_t        evFrom;
         byte            bufData[MAX_MSGLEN];
         msg_t           buf;
+        perfTime_t      perfStart;
+        int             handled, dispatched;
 
         MSG_Init( &buf, bufData, sizeof( bufData ) );
 
+        perfStart = Perf_Begin();
+        handled = 0;
+
         while ( 1 ) {
                 NET_FlushPacketQueue();
-                ev = Com_GetEvent();
+
+                if ( com_journal->integer || com_pushedEventsHead > com_pushedEventsTail ) {
+                        ev = Com_GetEvent();
+                } else {
+                        // nothing to record, run the rings until the sockets
+                        // and the receive thread have nothing more for them
+                        do {
+                                Com_PollSystemEvents();
+                                dispatched = Com_DispatchRings( &buf );
+                                handled += dispatched;
+                        } while ( dispatched );
+
+                        Com_Memset( &ev, 0, sizeof( ev ) );
+                        ev.evTime = Sys_Milliseconds();
+                }
 
                 // if no more events are available
                 if ( ev.evType == SE_NONE ) {
                         // manually send packet events for the loopback channel
                         while ( NET_GetLoopPacket( NS_CLIENT, &evFrom, &buf ) ) {
                                 CL_PacketEvent( evFrom, &buf );
+                                handled++;
                         }
 
                         while ( NET_GetLoopPacket( NS_SERVER, &evFrom, &buf ) ) {
@@ -2235,11 +2791,19 @@ int Com_EventLoop( void ) {
                                 if ( com_sv_running->integer ) {
                                         Com_RunAndTimeServerPacket( &evFrom, &buf );
                                 }
+                                handled++;
                         }
 
+                        // the frame limiter spins on empty calls, keep them
+                        // out of the histogram
+                        if ( handled ) {
+                                Perf_End( PERF_EVENTS, perfStart );
+                        }
                         return ev.evTime;
                 }
 
+                handled++;
+
 
                 switch ( ev.evType ) {
                 default:
@@ -2264,17 +2828,6 @@ int Com_EventLoop( void ) {
                         Cbuf_AddText( "\n" );
                         break;
                 case SE_PACKET:
-                        // this cvar allows simulation of connections that
-                        // drop a lot of packets.  Note that loopback connections
-                        // don't go through here at all.
-                        if ( com_dropsim->value > 0 ) {
-                                static int seed;
-
-                                if ( Q_random( &seed ) < com_dropsim->value ) {
-                                        break;          // drop this packet
-                                }
-                        }
-
                         evFrom = *(netadr_t *)ev.evPtr;
                         buf.cursize = ev.evPtrLength - sizeof( evFrom );
 
@@ -2287,11 +2840,7 @@ int Com_EventLoop( void ) {
                                 continue;
                         }
                         Com_Memcpy( buf.data, (byte *)((netadr_t *)ev.evPtr + 1), buf.cursize );
-                        if ( com_sv_running->integer ) {
-                                Com_RunAndTimeServerPacket( &evFrom, &buf );
-                        } else {
-                                CL_PacketEvent( evFrom, &buf );
-                        }
+                        Com_PacketEvent( &evFrom, &buf );
                         break;
                 }
 
@@ -2314,6 +2863,11 @@ Can be used for profiling, but will be journaled accurately
 int Com_Milliseconds (void) {
         sysEvent_t      ev;
 
+        // only the journal needs the clock to come from the event stream
+        if ( !com_journal->integer ) {
+                return Sys_Milliseconds();
+        }
+
         // get events and push them until we get a null event with the current time
         do {
 
@@ -2663,8 +3217,13 @@ void Com_Init( char *commandLine ) {
         }
 
         // Clear queues
-        Com_Memset( &eventQueue[ 0 ], 0, MAX_QUEUED_EVENTS * sizeof( sysEvent_t ) );
-        Com_Memset( &sys_packetReceived[ 0 ], 0, MAX_MSGLEN * sizeof( byte ) );
+        Com_Memset( &inputRing, 0, sizeof( inputRing ) );
+        Com_Memset( &consoleRing, 0, sizeof( consoleRing ) );
+        Com_Memset( &packetRing, 0, sizeof( packetRing ) );
+        if ( !packetSpace )
+        {
+                packetSpace = Sys_CreateSemaphore( 0 );
+        }
 
         // initialize the weak pseudo-random number generator for use later.
         Com_InitRand();
@@ -2747,13 +3306,14 @@ void Com_Init( char *commandLine ) {
         com_developer = Cvar_Get ("developer", "0", CVAR_TEMP );
         com_logfile = Cvar_Get ("logfile", "0", CVAR_TEMP );
         com_logfileName = Cvar_Get("logfileName", "qconsole.log", CVAR_ARCHIVE);
+        AsyncLog_Init();
 
         com_timescale = Cvar_Get ("timescale", "1", CVAR_CHEAT | CVAR_SYSTEMINFO );
         com_fixedtime = Cvar_Get ("fixedtime", "0", CVAR_CHEAT);
         com_showtrace = Cvar_Get ("com_showtrace", "0", CVAR_CHEAT);
         com_dropsim = Cvar_Get ("com_dropsim", "0", CVAR_CHEAT);
         com_speeds = Cvar_Get ("com_speeds", "0", 0);
-        com_speeds2 = Cvar_Get ("com_speeds2", "0", 0);
+        Perf_Init();
         com_timedemo = Cvar_Get ("timedemo", "0", CVAR_CHEAT);
         com_cameraMode = Cvar_Get ("com_cameraMode", "0", CVAR_CHEAT);
 
@@ -2816,9 +3376,8 @@ void Com_Init( char *commandLine ) {
         SV_Init();
 
         com_dedicated->modified = qfalse;
-#ifndef DEDICATED
+        // the dedicated build gets the null client, which only adds demoanalyze
         CL_Init();
-#endif
 
         // set com_frameTime so that if a map is started on the
         // command line it will still be able to count on com_frameTime
@@ -3016,6 +3575,8 @@ void Com_Frame( void ) {
 
         unsigned long long                      musec, minMusec;
         static unsigned long long       mulastTime, com_muframeTime;
+        qboolean        microGranularity;
+        perfTime_t      perfStart;
 
         if ( setjmp (abortframe) ) {
                 return;                 // an ERR_DROP was thrown
@@ -3080,12 +3641,16 @@ void Com_Frame( void ) {
         msec = minMsec;
         musec = minMusec;
 
+        // journaled frames must be paced by journaled time alone, or a
+        // replay would pull a different number of events per frame
+        microGranularity = clu.sys_microGranularity->integer && !com_journal->integer;
+
         do {
 
                 // The existing Sys_Sleep implementations aren't really
                 // precise enough to be of use beyond 100fps
                 // FIXME: implement a more precise sleep (RDTSC or something)
-                if(!clu.sys_microGranularity->integer ) {
+                if(!microGranularity ) {
                         int timeRemaining = minMsec - msec;
                         if( timeRemaining >= 10 )
                                 Sys_Sleep(timeRemaining);       /*      ioq3-urt: Notice sleeping is only for CPU easing and it does not do the
@@ -3102,7 +3667,7 @@ void Com_Frame( void ) {
 
                 clu.Sys_MicroGranularityCheck();
 
-                if (clu.sys_microGranularity->integer) { //we go through the previous stuff anyway since they are still needed elsewhere.
+                if (microGranularity) { //we go through the previous stuff anyway since they are still needed elsewhere.
                         long long mutimeRemaining = minMusec - musec;
 
                         if (    mutimeRemaining >= 10000)
@@ -3116,7 +3681,10 @@ void Com_Frame( void ) {
                         musec = com_muframeTime - mulastTime;
                 }
 
-        } while ((clu.sys_microGranularity->integer && musec < minMusec) || (!clu.sys_microGranularity->integer &&  msec < minMsec));
+        } while ((microGranularity && musec < minMusec) || (!microGranularity &&  msec < minMsec));
+
+        // the frame proper starts once we are done waiting for it
+        perfStart = Perf_Begin();
 
         Cbuf_Execute ();
 
@@ -3209,6 +3777,9 @@ void Com_Frame( void ) {
                                          com_frameNumber, all, sv, ev, cl, time_game, time_frontend, time_backend );
         }
 
+        Perf_End( PERF_FRAME, perfStart );
+        Perf_Frame();
+
         //
         // trace optimization tracking
         //
@@ -3237,6 +3808,8 @@ Com_Shutdown
 =================
 */
 void Com_Shutdown (void) {
+        AsyncLog_Shutdown();
+
         if (logfile) {
                 FS_FCloseFile (logfile);
                 logfile = 0;
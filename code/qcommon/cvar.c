@@ -28,12 +28,21 @@ cvar_t          *cvar_vars = NULL;
 cvar_t          *cvar_cheats;
 int                     cvar_modifiedFlags;
 
-#define MAX_CVARS       2048
+#define MAX_CVARS       MAX_CVAR_HANDLES
 cvar_t          cvar_indexes[MAX_CVARS];
 int                     cvar_numIndexes;
 
-#define FILE_HASH_SIZE          256
-static  cvar_t  *hashTable[FILE_HASH_SIZE];
+// the hash grows with the number of cvars, up to one bucket per cvar
+#define MIN_HASH_SIZE           256
+static  cvar_t  *hashTable[MAX_CVARS];
+static  int     cvar_hashSize = MIN_HASH_SIZE;
+static  int     cvar_count;
+
+// modificationCount mirrors in module memory, see Cvar_SetGenerations
+static struct {
+        int     *table;
+        int     count;
+} cvar_generations[CVAR_GEN_MAX];
 
 cvar_t *Cvar_Set2( const char *var_name, const char *value, qboolean force);
 
@@ -54,10 +63,69 @@ static long generateHashValue( const char *fname ) {
                 hash+=(long)(letter)*(i+119);
                 i++;
         }
-        hash &= (FILE_HASH_SIZE-1);
+        hash &= (cvar_hashSize-1);
         return hash;
 }
 
+/*
+============
+Cvar_LinkHash
+============
+*/
+static void Cvar_LinkHash( cvar_t *var ) {
+        long hash;
+
+        hash = generateHashValue(var->name);
+        var->hashIndex = hash;
+
+        var->hashNext = hashTable[hash];
+        if(hashTable[hash])
+                hashTable[hash]->hashPrev = var;
+
+        var->hashPrev = NULL;
+        hashTable[hash] = var;
+}
+
+/*
+============
+Cvar_GrowHash
+
+Doubles the bucket count when there are more cvars than buckets
+============
+*/
+static void Cvar_GrowHash( void ) {
+        cvar_t  *var;
+
+        if ( cvar_count <= cvar_hashSize || cvar_hashSize >= MAX_CVARS ) {
+                return;
+        }
+
+        cvar_hashSize *= 2;
+        Com_Memset( hashTable, 0, cvar_hashSize * sizeof( hashTable[0] ) );
+        for ( var = cvar_vars ; var ; var = var->next ) {
+                Cvar_LinkHash( var );
+        }
+}
+
+/*
+============
+Cvar_Modified
+
+Called whenever modificationCount changes, so modules that registered a
+generation table see it without a Cvar_Update trap
+============
+*/
+static void Cvar_Modified( cvar_t *var ) {
+        int     i, index;
+
+        index = var - cvar_indexes;
+        for ( i = 0 ; i < CVAR_GEN_MAX ; i++ ) {
+                if ( index < cvar_generations[i].count ) {
+                        cvar_generations[i].table[index] = var->modificationCount;
+                }
+        }
+}
+
 /*
 ============
 Cvar_ValidateString
@@ -306,7 +374,6 @@ The flags will be or'ed in if the variable exists.
 */
 cvar_t *Cvar_Get( const char *var_name, const char *var_value, int flags ) {
         cvar_t  *var;
-        long    hash;
         int     index;
 
         if ( !var_name || ! var_value ) {
@@ -438,15 +505,11 @@ cvar_t *Cvar_Get( const char *var_name, const char *var_value, int flags ) {
         // note what types of cvars have been modified (userinfo, archive, serverinfo, systeminfo)
         cvar_modifiedFlags |= var->flags;
 
-        hash = generateHashValue(var_name);
-        var->hashIndex = hash;
-
-        var->hashNext = hashTable[hash];
-        if(hashTable[hash])
-                hashTable[hash]->hashPrev = var;
+        Cvar_LinkHash( var );
+        cvar_count++;
+        Cvar_GrowHash();
 
-        var->hashPrev = NULL;
-        hashTable[hash] = var;
+        Cvar_Modified( var );
 
         return var;
 }
@@ -586,6 +649,7 @@ cvar_t *Cvar_Set2( const char *var_name, const char *value, qboolean force ) {
                         var->latchedString = CopyString(value);
                         var->modified = qtrue;
                         var->modificationCount++;
+                        Cvar_Modified( var );
                         return var;
                 }
 
@@ -617,6 +681,8 @@ cvar_t *Cvar_Set2( const char *var_name, const char *value, qboolean force ) {
         var->value = atof (var->string);
         var->integer = atoi (var->string);
 
+        Cvar_Modified( var );
+
         return var;
 }
 
@@ -1019,6 +1085,7 @@ cvar_t *Cvar_Unset(cvar_t *cv)
                 cv->hashNext->hashPrev = cv->hashPrev;
 
         Com_Memset(cv, '\0', sizeof(*cv));
+        cvar_count--;
 
         return next;
 }
@@ -1238,6 +1305,37 @@ void    Cvar_Update( vmCvar_t *vmCvar ) {
         vmCvar->integer = cv->integer;
 }
 
+/*
+=====================
+Cvar_SetGenerations
+
+A module hands over an array it indexes by cvar handle, each entry is kept
+equal to that cvar's modificationCount, so the module only needs to call
+Cvar_Update when it differs from its vmCvar_t.  NULL table unregisters,
+which has to happen before the module's memory goes away.
+=====================
+*/
+void Cvar_SetGenerations( int module, int *table, int count ) {
+        int     i;
+
+        if ( (unsigned)module >= CVAR_GEN_MAX ) {
+                return;
+        }
+        if ( !table || count < 0 ) {
+                count = 0;
+        }
+        if ( count > MAX_CVARS ) {
+                count = MAX_CVARS;
+        }
+
+        cvar_generations[module].table = table;
+        cvar_generations[module].count = count;
+
+        for ( i = 0 ; i < count ; i++ ) {
+                table[i] = cvar_indexes[i].name ? cvar_indexes[i].modificationCount : 0;
+        }
+}
+
 /*
 ==================
 Cvar_CompleteCvarName
@@ -0,0 +1,348 @@
+/*
+===========================================================================
+Copyright (C) 1999-2005 Id Software, Inc.
+
+This file is part of Quake III Arena source code.
+
+Quake III Arena source code is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the License,
+or (at your option) any later version.
+
+Quake III Arena source code is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Quake III Arena source code; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+===========================================================================
+*/
+// demoz.c -- reading the compressed, seekable demo container
+//
+// Shared by demo playback in the client and demoanalyze in the
+// dedicated build, see DEMOZ_MAGIC for the layout.
+
+#include "q_shared.h"
+#include "qcommon.h"
+
+#ifdef USE_LOCAL_HEADERS
+  #include "../zlib/zlib.h"
+#else
+  #include <zlib.h>
+#endif
+
+/*
+=================
+DemoZ_LoadBlock
+
+Inflate block n.  The gamestate at the start of a keyframe block is
+only replayed when asked for, otherwise reading continues straight
+into its messages.
+=================
+*/
+qboolean DemoZ_LoadBlock( demozReader_t *dz, int n, qboolean gamestate ) {
+	int			header[4];
+	int			rawSize, packedSize, gamestateSize, len;
+	byte		*packed;
+	z_stream	zs;
+	int			err;
+
+	if ( n < 0 || n >= dz->numBlocks ) {
+		return qfalse;
+	}
+
+	FS_Seek( dz->file, dz->index[n].offset, FS_SEEK_SET );
+	if ( FS_Read( header, sizeof( header ), dz->file ) != sizeof( header ) ) {
+		Com_Printf( "Demo file was truncated.\n" );
+		return qfalse;
+	}
+	rawSize = LittleLong( header[0] );
+	packedSize = LittleLong( header[1] );
+	gamestateSize = LittleLong( header[3] );
+	if ( rawSize <= 0 || rawSize > DEMOZ_MAX_BLOCK || packedSize <= 0 || packedSize > rawSize
+		|| gamestateSize < 0 || gamestateSize > rawSize ) {
+		Com_Printf( "Demo block %i is corrupt.\n", n );
+		return qfalse;
+	}
+
+	if ( packedSize == rawSize ) {
+		// stored, deflate didn't gain anything
+		if ( FS_Read( dz->block, rawSize, dz->file ) != rawSize ) {
+			Com_Printf( "Demo file was truncated.\n" );
+			return qfalse;
+		}
+	} else {
+		packed = Z_Malloc( packedSize );
+		if ( FS_Read( packed, packedSize, dz->file ) != packedSize ) {
+			Z_Free( packed );
+			Com_Printf( "Demo file was truncated.\n" );
+			return qfalse;
+		}
+
+		Com_Memset( &zs, 0, sizeof( zs ) );
+		zs.next_in = packed;
+		zs.avail_in = packedSize;
+		zs.next_out = dz->block;
+		zs.avail_out = rawSize;
+		err = inflateInit( &zs );
+		if ( err == Z_OK ) {
+			err = inflate( &zs, Z_FINISH );
+			inflateEnd( &zs );
+		}
+		Z_Free( packed );
+
+		if ( err != Z_STREAM_END || zs.total_out != rawSize ) {
+			Com_Printf( "Demo block %i is corrupt.\n", n );
+			return qfalse;
+		}
+	}
+
+	// the gamestate has to be exactly the first record
+	if ( gamestateSize ) {
+		if ( gamestateSize < 8 ) {
+			Com_Printf( "Demo block %i is corrupt.\n", n );
+			return qfalse;
+		}
+		Com_Memcpy( &len, dz->block + 4, 4 );
+		if ( 8 + LittleLong( len ) != gamestateSize ) {
+			Com_Printf( "Demo block %i is corrupt.\n", n );
+			return qfalse;
+		}
+	}
+
+	dz->blockSize = rawSize;
+	dz->blockPos = gamestate ? 0 : gamestateSize;
+	dz->blockNum = n + 1;
+	return qtrue;
+}
+
+/*
+=================
+DemoZ_ReadMessage
+
+Next <sequence><length><message> record, loading blocks as needed
+=================
+*/
+qboolean DemoZ_ReadMessage( demozReader_t *dz, msg_t *buf, int *sequence ) {
+	int			s;
+	byte		*p;
+
+	while ( dz->blockPos >= dz->blockSize ) {
+		if ( !DemoZ_LoadBlock( dz, dz->blockNum, qfalse ) ) {
+			return qfalse;
+		}
+	}
+
+	if ( dz->blockPos + 8 > dz->blockSize ) {
+		Com_Printf( "Demo file was truncated.\n" );
+		return qfalse;
+	}
+	p = dz->block + dz->blockPos;
+	Com_Memcpy( &s, p, 4 );
+	*sequence = LittleLong( s );
+	Com_Memcpy( &s, p + 4, 4 );
+	buf->cursize = LittleLong( s );
+
+	if ( buf->cursize <= 0 || buf->cursize > buf->maxsize
+		|| dz->blockPos + 8 + buf->cursize > dz->blockSize ) {
+		Com_Printf( "Demo file was truncated.\n" );
+		return qfalse;
+	}
+	Com_Memcpy( buf->data, p + 8, buf->cursize );
+	dz->blockPos += 8 + buf->cursize;
+	buf->readcount = 0;
+	buf->bit = 0;
+	return qtrue;
+}
+
+/*
+=================
+DemoZ_ValidIndex
+
+Every block has to start past the header and before end
+=================
+*/
+static qboolean DemoZ_ValidIndex( const demozIndex_t *index, int pos, int end ) {
+	return index->offset >= pos && index->offset < end
+		&& index->gamestateSize >= 0 && index->gamestateSize <= DEMOZ_MAX_BLOCK;
+}
+
+/*
+=================
+DemoZ_ReadIndex
+
+Read the block index from the trailer.  A demo that was cut short
+has none, so walk the block headers from pos instead.
+=================
+*/
+static qboolean DemoZ_ReadIndex( demozReader_t *dz, int pos, int size ) {
+	int				header[4], trailer[2];
+	int				v, len, count, i, maxBlocks;
+	demozIndex_t	*index;
+
+	count = 0;
+	v = size;
+
+	// try the index at the end first
+	if ( size >= pos + 12 ) {
+		FS_Seek( dz->file, size - 8, FS_SEEK_SET );
+		if ( FS_Read( trailer, 8, dz->file ) == 8 && LittleLong( trailer[1] ) == DEMOZ_INDEX_MAGIC ) {
+			v = LittleLong( trailer[0] );
+			if ( v >= pos && v <= size - 12 ) {
+				FS_Seek( dz->file, v, FS_SEEK_SET );
+				if ( FS_Read( &count, 4, dz->file ) == 4 ) {
+					count = LittleLong( count );
+					// the count is checked before it's multiplied by anything
+					if ( count <= 0 || count > ( size - v - 12 ) / 12 || v + 4 + count * 12 + 8 != size ) {
+						count = 0;
+					}
+				}
+			}
+		}
+	}
+
+	if ( count > 0 ) {
+		dz->index = Z_Malloc( count * sizeof( demozIndex_t ) );
+		for ( i = 0; i < count; i++ ) {
+			if ( FS_Read( header, 12, dz->file ) != 12 ) {
+				break;
+			}
+			dz->index[i].offset = LittleLong( header[0] );
+			dz->index[i].serverTime = LittleLong( header[1] );
+			dz->index[i].gamestateSize = LittleLong( header[2] );
+			if ( !DemoZ_ValidIndex( &dz->index[i], pos, v ) ) {
+				break;
+			}
+		}
+		if ( i == count ) {
+			dz->numBlocks = count;
+			return qtrue;
+		}
+		// don't trust any of it, find the blocks the slow way
+		Com_Printf( "Demo index is corrupt.\n" );
+		Z_Free( dz->index );
+		dz->index = NULL;
+	}
+
+	maxBlocks = 0;
+	while ( pos + 16 <= size ) {
+		FS_Seek( dz->file, pos, FS_SEEK_SET );
+		if ( FS_Read( header, 16, dz->file ) != 16 ) {
+			break;
+		}
+		len = LittleLong( header[1] );
+		if ( len <= 0 || len > DEMOZ_MAX_BLOCK || len > size - pos - 16 ) {
+			break;
+		}
+
+		if ( dz->numBlocks == maxBlocks ) {
+			maxBlocks = maxBlocks ? maxBlocks * 2 : 64;
+			index = Z_Malloc( maxBlocks * sizeof( demozIndex_t ) );
+			if ( dz->index ) {
+				Com_Memcpy( index, dz->index, dz->numBlocks * sizeof( demozIndex_t ) );
+				Z_Free( dz->index );
+			}
+			dz->index = index;
+		}
+		index = &dz->index[dz->numBlocks];
+		index->offset = pos;
+		index->serverTime = LittleLong( header[2] );
+		index->gamestateSize = LittleLong( header[3] );
+		if ( !DemoZ_ValidIndex( index, pos, size ) ) {
+			break;
+		}
+		dz->numBlocks++;
+
+		pos += 16 + len;
+	}
+	Com_Printf( "Demo has no index, found %i blocks.\n", dz->numBlocks );
+	return qtrue;
+}
+
+/*
+=================
+DemoZ_Open
+
+Read the header and block index of the size bytes long demo in f and
+load the first block.  f stays owned by the caller.
+=================
+*/
+qboolean DemoZ_Open( demozReader_t *dz, fileHandle_t f, int size, const char *name ) {
+	int			v, len;
+	char		modversion[MAX_STRING_CHARS];
+
+	Com_Memset( dz, 0, sizeof( *dz ) );
+	dz->file = f;
+
+	if ( FS_Read( &v, 4, f ) != 4 || LittleLong( v ) != DEMOZ_MAGIC ) {
+		Com_Printf( "%s is not a seekable demo.\n", name );
+		return qfalse;
+	}
+	if ( FS_Read( &v, 4, f ) != 4 || LittleLong( v ) != DEMOZ_VERSION ) {
+		Com_Printf( "%s has an unsupported demo version.\n", name );
+		return qfalse;
+	}
+	if ( FS_Read( &v, 4, f ) != 4 ) {
+		return qfalse;
+	}
+	dz->keyframeMsec = LittleLong( v );
+	if ( dz->keyframeMsec <= 0 ) {
+		return qfalse;
+	}
+
+	if ( FS_Read( &len, 4, f ) != 4 ) {
+		return qfalse;
+	}
+	len = LittleLong( len );
+	if ( len < 0 || len >= sizeof( modversion ) || FS_Read( modversion, len, f ) != len ) {
+		return qfalse;
+	}
+	modversion[len] = '\0';
+
+	if ( FS_Read( &v, 4, f ) != 4 ) {
+		return qfalse;
+	}
+	Com_Printf( "Demo protocol: %d   Modversion: %s\n", LittleLong( v ), modversion );
+
+	if ( !DemoZ_ReadIndex( dz, 4 * 5 + len, size ) ) {
+		DemoZ_Free( dz );
+		return qfalse;
+	}
+
+	if ( !dz->numBlocks || !dz->index[0].gamestateSize ) {
+		Com_Printf( "%s has no gamestate.\n", name );
+		DemoZ_Free( dz );
+		return qfalse;
+	}
+
+	dz->block = Z_Malloc( DEMOZ_MAX_BLOCK );
+	if ( !DemoZ_LoadBlock( dz, 0, qtrue ) ) {
+		DemoZ_Free( dz );
+		return qfalse;
+	}
+	return qtrue;
+}
+
+/*
+=================
+DemoZ_Free
+
+Releases the index and block buffer, not the file
+=================
+*/
+void DemoZ_Free( demozReader_t *dz ) {
+	if ( dz->index ) {
+		Z_Free( dz->index );
+		dz->index = NULL;
+	}
+	if ( dz->block ) {
+		Z_Free( dz->block );
+		dz->block = NULL;
+	}
+	dz->numBlocks = 0;
+	dz->blockNum = 0;
+	dz->blockSize = 0;
+	dz->blockPos = 0;
+}
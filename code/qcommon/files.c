@@ -247,6 +247,7 @@ static  cvar_t          *fs_apppath;
 static  cvar_t      *fs_basepath;
 static  cvar_t      *fs_basegame;
 static  cvar_t      *fs_gamedirvar;
+static  cvar_t      *fs_sharedCache;
 static  searchpath_t    *fs_searchpaths;
 static  int         fs_readCount;           // total bytes read
 static  int         fs_loadCount;           // total files read
@@ -405,6 +406,21 @@ static FILE *FS_FileForHandle( fileHandle_t f ) {
     return fsh[f].handleFiles.file.o;
 }
 
+/*
+================
+FS_StdioHandle
+
+Like FS_FileForHandle, but never errors out, the async log writer
+calls it for handles that may be anything
+================
+*/
+FILE *FS_StdioHandle( fileHandle_t f ) {
+    if ( f <= 0 || f >= MAX_FILE_HANDLES || fsh[f].zipFile == qtrue ) {
+        return NULL;
+    }
+    return fsh[f].handleFiles.file.o;
+}
+
 void    FS_ForceFlush( fileHandle_t f ) {
     FILE *file;
 
@@ -862,6 +878,9 @@ void FS_FCloseFile( fileHandle_t f ) {
         Com_Error( ERR_FATAL, "Filesystem call made without initialization\n" );
     }
 
+    // let the log writer finish with it first
+    AsyncLog_Close( f );
+
     if (fsh[f].zipFile == qtrue) {
         unzCloseCurrentFile( fsh[f].handleFiles.file.z );
         if ( fsh[f].handleFiles.unique ) {
@@ -1573,7 +1592,7 @@ int FS_ReadFile( const char *qpath, void **buffer ) {
     // it from the journal file
     if ( strstr( qpath, ".cfg" ) ) {
         isConfig = qtrue;
-        if ( com_journal && com_journal->integer == 2 ) {
+        if ( com_journal && ( com_journal->integer == 2 || com_journal->integer == JOURNAL_BENCHMARK ) ) {
             int     r;
 
             Com_DPrintf( "Loading %s from journal file.\n", qpath );
@@ -1684,6 +1703,130 @@ void FS_FreeFile( void *buffer ) {
     }
 }
 
+/*
+=============
+FS_MapShared
+
+Maps a pk3 file read-only from fs_sharedCache, extracting it there first
+if no other process has yet.  Cache files are named after the pk3
+checksum, so every server running the same paks maps the same pages
+instead of inflating its own copy.
+
+Returns NULL when the cache is off, the file isn't in a pk3 or anything
+fails, callers then go through FS_ReadFile as usual.
+=============
+*/
+void *FS_MapShared( const char *qpath, int *length ) {
+    searchpath_t    *search;
+    pack_t          *pak;
+    fileInPack_t    *pakFile;
+    char            ospath[MAX_OSPATH];
+    char            tmppath[MAX_OSPATH];
+    char            name[MAX_QPATH];
+    char            *s;
+    FILE            *f;
+    void            *buf, *data;
+    long            hash;
+    int             len, mapped;
+
+    if ( !fs_searchpaths ) {
+        Com_Error( ERR_FATAL, "Filesystem call made without initialization\n" );
+    }
+    if ( !fs_sharedCache || !fs_sharedCache->string[0] || !qpath || !qpath[0] ) {
+        return NULL;
+    }
+
+    // find the file the way FS_FOpenFileRead would
+    pak = NULL;
+    pakFile = NULL;
+    for ( search = fs_searchpaths ; search && !pakFile ; search = search->next ) {
+        if ( search->dir ) {
+            // a loose file shadows the paks, those aren't shared
+            f = fopen( FS_BuildOSPath( search->dir->path, search->dir->gamedir, qpath ), "rb" );
+            if ( f ) {
+                fclose( f );
+                return NULL;
+            }
+            continue;
+        }
+        if ( !search->pack || !FS_PakIsPure( search->pack ) ) {
+            continue;
+        }
+        hash = FS_HashFileName( qpath, search->pack->hashSize );
+        for ( pakFile = search->pack->hashTable[hash] ; pakFile ; pakFile = pakFile->next ) {
+            if ( !FS_FilenameCompare( pakFile->name, qpath ) ) {
+                pak = search->pack;
+                break;
+            }
+        }
+    }
+    if ( !pakFile ) {
+        return NULL;
+    }
+
+    Q_strncpyz( name, qpath, sizeof( name ) );
+    for ( s = name ; *s ; s++ ) {
+        if ( *s == '/' || *s == '\\' || *s == ':' ) {
+            *s = '_';
+        }
+    }
+    Com_sprintf( ospath, sizeof( ospath ), "%s%c%08x-%s", fs_sharedCache->string, PATH_SEP, pak->checksum, name );
+
+    data = Sys_MapFile( ospath, &mapped );
+    if ( data && mapped == pakFile->len ) {
+        *length = mapped;
+        return data;
+    }
+    if ( data ) {
+        Sys_UnmapFile( data, mapped );
+    }
+
+    // first one here, extract it under a private name and rename it
+    // into place so nobody maps a half written file
+    len = FS_ReadFile( qpath, &buf );
+    if ( !buf ) {
+        return NULL;
+    }
+
+    Sys_Mkdir( fs_sharedCache->string );
+    Com_sprintf( tmppath, sizeof( tmppath ), "%s.%i", ospath, Sys_PID() );
+    f = fopen( tmppath, "wb" );
+    if ( !f ) {
+        Com_Printf( "WARNING: FS_MapShared: couldn't write %s\n", tmppath );
+        FS_FreeFile( buf );
+        return NULL;
+    }
+    mapped = fwrite( buf, 1, len, f );
+    fclose( f );
+    FS_FreeFile( buf );
+
+    if ( mapped != len || rename( tmppath, ospath ) ) {
+        remove( tmppath );
+    }
+
+    data = Sys_MapFile( ospath, &mapped );
+    if ( !data ) {
+        return NULL;
+    }
+    if ( mapped != pakFile->len ) {
+        Sys_UnmapFile( data, mapped );
+        return NULL;
+    }
+
+    Com_DPrintf( "FS_MapShared: extracted %s to %s\n", qpath, ospath );
+    *length = mapped;
+    return data;
+}
+
+/*
+=============
+FS_UnmapShared
+=============
+*/
+void FS_UnmapShared( void *data, int length ) {
+    Sys_UnmapFile( data, length );
+}
+
 /*
 ============
 FS_WriteFile
@@ -2851,6 +2994,7 @@ static void FS_Startup( const char *gameName )
     fs_packFiles = 0;
 
     fs_debug = Cvar_Get( "fs_debug", "0", 0 );
+    fs_sharedCache = Cvar_Get( "fs_sharedCache", "", CVAR_INIT );
     fs_basepath = Cvar_Get ("fs_basepath", Sys_DefaultInstallPath(), CVAR_INIT );
     fs_basegame = Cvar_Get ("fs_basegame", "", CVAR_INIT );
     homePath = Sys_DefaultHomePath();
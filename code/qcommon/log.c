@@ -0,0 +1,432 @@
+/*
+===========================================================================
+Copyright (C) 1999-2005 Id Software, Inc.
+
+This file is part of Quake III Arena source code.
+
+Quake III Arena source code is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the License,
+or (at your option) any later version.
+
+Quake III Arena source code is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Quake III Arena source code; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+===========================================================================
+*/
+// log.c -- asynchronous log writer
+
+#include "q_shared.h"
+#include "qcommon.h"
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+/*
+
+Log lines (qconsole.log and the game's append-mode files) are copied into
+a fixed ring of slots and written out by a background thread, so a burst
+of prints never stalls the frame on disk I/O.
+
+Any thread may produce: a writer claims a run of consecutive slots with a
+single compare-and-swap on head, fills them and publishes each one by
+bumping its sequence.  The writer thread consumes strictly in ticket order,
+so a line spread over several slots always comes out in one piece.  When
+the ring is full the line is dropped and counted, the frame never waits.
+An idle writer sleeps on a semaphore until a line comes in or the next
+timed flush is due.
+
+*/
+
+#define LOG_SLOTS			4096		// must be a power of two
+#define LOG_SLOT_TEXT		248
+#define LOG_MAX_FILES		64			// same as MAX_FILE_HANDLES
+
+typedef struct {
+	volatile unsigned	sequence;		// ticket + 1 once published, ticket + LOG_SLOTS once free again
+	short				file;
+	short				length;
+	char				text[LOG_SLOT_TEXT];
+} logSlot_t;
+
+typedef struct {
+	FILE		*file;
+	qboolean	flushLines;				// com_logfile 2, FS_APPEND_SYNC
+	qboolean	dirty;
+} logFile_t;
+
+static struct {
+	logSlot_t			slots[LOG_SLOTS];
+	volatile unsigned	head;			// next ticket to hand out
+	volatile unsigned	tail;			// next ticket to write, only moved by the writer
+
+	logFile_t			files[LOG_MAX_FILES];
+
+	void				*thread;
+	qboolean			running;
+	volatile qboolean	quit;
+	void				*wake;			// posted when a line is queued while the writer sleeps
+	volatile int		sleeping;
+
+	volatile unsigned long long	queued;
+	volatile unsigned long long	dropped;
+	volatile unsigned long long	written;
+	volatile unsigned long long	flushes;
+	volatile unsigned long long	syncs;
+} logRing;
+
+cvar_t	*com_logAsync;
+cvar_t	*com_logFlushMsec;
+cvar_t	*com_logFsync;
+
+/*
+================
+Log_SyncFile
+================
+*/
+static void Log_SyncFile( FILE *file ) {
+#ifdef _WIN32
+	_commit( _fileno( file ) );
+#else
+	fsync( fileno( file ) );
+#endif
+}
+
+/*
+================
+Log_Drain
+
+Writes every published slot, returns the number of bytes written
+================
+*/
+static int Log_Drain( void ) {
+	logSlot_t	*slot;
+	logFile_t	*lf;
+	int			bytes;
+
+	bytes = 0;
+	for ( ;; ) {
+		slot = &logRing.slots[logRing.tail & ( LOG_SLOTS - 1 )];
+		if ( slot->sequence != logRing.tail + 1 ) {
+			break;
+		}
+		Sys_MemoryBarrier();
+
+		lf = &logRing.files[slot->file];
+		if ( lf->file ) {
+			fwrite( slot->text, 1, slot->length, lf->file );
+			lf->dirty = qtrue;
+		}
+		bytes += slot->length;
+
+		Sys_MemoryBarrier();
+		slot->sequence = logRing.tail + LOG_SLOTS;
+		logRing.tail++;
+	}
+
+	if ( bytes ) {
+		logRing.written += bytes;
+	}
+	return bytes;
+}
+
+/*
+================
+Log_Flush
+
+Applies the durability policy to everything written since the last call:
+streams that asked for it are flushed (and optionally fsync'd) right away,
+the rest every com_logFlushMsec.  Returns qtrue if a timed flush is still due.
+================
+*/
+static qboolean Log_Flush( qboolean timed ) {
+	logFile_t	*lf;
+	int			i;
+	qboolean	pending;
+
+	pending = qfalse;
+	for ( i = 1; i < LOG_MAX_FILES; i++ ) {
+		lf = &logRing.files[i];
+		if ( !lf->file || !lf->dirty ) {
+			continue;
+		}
+		if ( !lf->flushLines && !timed ) {
+			pending = qtrue;
+			continue;
+		}
+		fflush( lf->file );
+		logRing.flushes++;
+		if ( lf->flushLines && com_logFsync->integer ) {
+			Log_SyncFile( lf->file );
+			logRing.syncs++;
+		}
+		lf->dirty = qfalse;
+	}
+	return pending;
+}
+
+/*
+================
+Log_Wait
+
+Sleeps until a line is published at the tail, the writer is told to
+quit or msec (-1 for no limit) runs out
+================
+*/
+static void Log_Wait( int msec ) {
+	logSlot_t	*slot;
+
+	if ( !logRing.wake ) {
+		Sys_ThreadSleep( 1 );
+		return;
+	}
+
+	// set the flag before looking again, so a line published in
+	// between either is seen here or posts the semaphore
+	logRing.sleeping = 1;
+	Sys_MemoryBarrier();
+	slot = &logRing.slots[logRing.tail & ( LOG_SLOTS - 1 )];
+	if ( slot->sequence != logRing.tail + 1 && !logRing.quit ) {
+		Sys_SemaphoreWait( logRing.wake, msec );
+	}
+	logRing.sleeping = 0;
+}
+
+/*
+================
+Log_Thread
+================
+*/
+static void Log_Thread( void *arg ) {
+	int			lastFlush, now, wait;
+	qboolean	pending;
+
+	lastFlush = Sys_Milliseconds();
+	while ( !logRing.quit ) {
+		Log_Drain();
+
+		now = Sys_Milliseconds();
+		if ( com_logFlushMsec->integer > 0 && now - lastFlush >= com_logFlushMsec->integer ) {
+			pending = Log_Flush( qtrue );
+			lastFlush = now;
+		} else {
+			pending = Log_Flush( qfalse );
+		}
+
+		// only wake up for the timed flush if something waits for it
+		wait = -1;
+		if ( pending && com_logFlushMsec->integer > 0 ) {
+			wait = lastFlush + com_logFlushMsec->integer - now;
+			if ( wait < 0 ) {
+				wait = 0;
+			}
+		}
+		Log_Wait( wait );
+	}
+
+	Log_Drain();
+	Log_Flush( qtrue );
+}
+
+/*
+================
+AsyncLog_Write
+
+Queues data for f if it was registered with AsyncLog_Open, otherwise
+writes it straight through
+================
+*/
+void AsyncLog_Write( fileHandle_t f, const void *data, int length ) {
+	logSlot_t	*slot;
+	unsigned	head;
+	int			count, chunk, i, diff;
+
+	if ( !logRing.running || f <= 0 || f >= LOG_MAX_FILES || !logRing.files[f].file ) {
+		FS_Write( data, length, f );
+		return;
+	}
+
+	count = ( length + LOG_SLOT_TEXT - 1 ) / LOG_SLOT_TEXT;
+	if ( !count ) {
+		return;
+	}
+	if ( count > LOG_SLOTS / 2 ) {
+		Sys_AtomicAdd( &logRing.dropped, length );
+		return;
+	}
+
+	// claim count consecutive slots, the last one being free means
+	// all of them are since the writer frees in order
+	for ( ;; ) {
+		head = logRing.head;
+		slot = &logRing.slots[( head + count - 1 ) & ( LOG_SLOTS - 1 )];
+		diff = (int)( slot->sequence - ( head + count - 1 ) );
+		if ( diff < 0 ) {
+			Sys_AtomicAdd( &logRing.dropped, length );
+			return;
+		}
+		if ( diff == 0 && Sys_AtomicCompareSwap( &logRing.head, head, head + count ) ) {
+			break;
+		}
+	}
+
+	for ( i = 0; i < count; i++ ) {
+		slot = &logRing.slots[( head + i ) & ( LOG_SLOTS - 1 )];
+		chunk = length - i * LOG_SLOT_TEXT;
+		if ( chunk > LOG_SLOT_TEXT ) {
+			chunk = LOG_SLOT_TEXT;
+		}
+		Com_Memcpy( slot->text, (const char *)data + i * LOG_SLOT_TEXT, chunk );
+		slot->file = f;
+		slot->length = chunk;
+
+		Sys_MemoryBarrier();
+		slot->sequence = head + i + 1;
+	}
+
+	Sys_AtomicAdd( &logRing.queued, length );
+
+	Sys_MemoryBarrier();
+	if ( logRing.sleeping ) {
+		logRing.sleeping = 0;
+		Sys_SemaphorePost( logRing.wake );
+	}
+}
+
+/*
+================
+AsyncLog_Open
+
+Routes writes to f through the writer thread.  flushLines streams are
+flushed as soon as the writer has caught up with them.
+================
+*/
+void AsyncLog_Open( fileHandle_t f, qboolean flushLines ) {
+	FILE	*file;
+
+	if ( f <= 0 || f >= LOG_MAX_FILES ) {
+		return;
+	}
+	file = FS_StdioHandle( f );
+	if ( !file ) {
+		return;
+	}
+
+	logRing.files[f].flushLines = flushLines;
+	logRing.files[f].dirty = qfalse;
+	Sys_MemoryBarrier();
+	logRing.files[f].file = file;
+}
+
+/*
+================
+AsyncLog_Close
+
+Waits for everything queued for f to hit the file, called by
+FS_FCloseFile before the handle goes away
+================
+*/
+void AsyncLog_Close( fileHandle_t f ) {
+	unsigned	head;
+
+	if ( f <= 0 || f >= LOG_MAX_FILES || !logRing.files[f].file ) {
+		return;
+	}
+
+	if ( logRing.running ) {
+		head = logRing.head;
+		while ( (int)( logRing.tail - head ) < 0 ) {
+			Sys_ThreadSleep( 1 );
+		}
+	}
+
+	logRing.files[f].file = NULL;
+	Sys_MemoryBarrier();
+	logRing.files[f].flushLines = qfalse;
+	logRing.files[f].dirty = qfalse;
+}
+
+/*
+================
+Log_Stats_f
+================
+*/
+static void Log_Stats_f( void ) {
+	Com_Printf( "writer thread: %s\n", logRing.running ? "running" : "off" );
+	Com_Printf( "%llu bytes queued, %llu dropped, %llu written\n", logRing.queued, logRing.dropped, logRing.written );
+	Com_Printf( "%u slots pending of %i\n", logRing.head - logRing.tail, LOG_SLOTS );
+	Com_Printf( "%llu flushes, %llu fsyncs\n", logRing.flushes, logRing.syncs );
+}
+
+/*
+================
+AsyncLog_Init
+================
+*/
+void AsyncLog_Init( void ) {
+	int		i;
+
+	com_logAsync = Cvar_Get( "com_logAsync", "1", CVAR_ARCHIVE | CVAR_LATCH );
+	com_logFlushMsec = Cvar_Get( "com_logFlushMsec", "1000", CVAR_ARCHIVE );
+	com_logFsync = Cvar_Get( "com_logFsync", "0", CVAR_ARCHIVE );
+	Cmd_AddCommand( "logstats", Log_Stats_f );
+
+	for ( i = 0; i < LOG_SLOTS; i++ ) {
+		logRing.slots[i].sequence = i;
+	}
+	logRing.head = logRing.tail = 0;
+
+	if ( !com_logAsync->integer ) {
+		return;
+	}
+
+	logRing.quit = qfalse;
+	logRing.sleeping = 0;
+	logRing.wake = Sys_CreateSemaphore( 0 );
+	logRing.thread = Sys_CreateThread( Log_Thread, NULL );
+	if ( !logRing.thread ) {
+		Com_Printf( "WARNING: couldn't start the log writer thread, logging synchronously\n" );
+		if ( logRing.wake ) {
+			Sys_DestroySemaphore( logRing.wake );
+			logRing.wake = NULL;
+		}
+		return;
+	}
+	logRing.running = qtrue;
+}
+
+/*
+================
+AsyncLog_Shutdown
+
+Lets the writer empty the ring and stops it, later writes go straight
+to the files again
+================
+*/
+void AsyncLog_Shutdown( void ) {
+	if ( !logRing.running ) {
+		return;
+	}
+
+	logRing.quit = qtrue;
+	Sys_MemoryBarrier();
+	if ( logRing.wake ) {
+		Sys_SemaphorePost( logRing.wake );
+	}
+	Sys_JoinThread( logRing.thread );
+	logRing.thread = NULL;
+	logRing.running = qfalse;
+
+	if ( logRing.wake ) {
+		Sys_DestroySemaphore( logRing.wake );
+		logRing.wake = NULL;
+	}
+}
@@ -1484,6 +1484,176 @@ void MSG_ReadDeltaPlayerstate (msg_t *msg, playerState_t *from, playerState_t *t
 	}
 }
 
+/*
+============================================================================
+
+gamestate and packet entities parsing
+
+============================================================================
+*/
+
+/*
+==================
+MSG_ReadGamestate
+
+Reads the configstrings and baselines of a gamestate up to svc_EOF
+==================
+*/
+const char *MSG_ReadGamestate( msg_t *msg, gameState_t *gameState, entityState_t *baselines ) {
+	entityState_t	nullstate;
+	char			*s;
+	int				cmd, i, len;
+
+	gameState->dataCount = 1;	// leave a 0 at the beginning for uninitialized configstrings
+	while ( 1 ) {
+		cmd = MSG_ReadByte( msg );
+
+		if ( cmd == svc_EOF ) {
+			return NULL;
+		}
+
+		if ( cmd == svc_configstring ) {
+			i = MSG_ReadShort( msg );
+			if ( i < 0 || i >= MAX_CONFIGSTRINGS ) {
+				return "configstring > MAX_CONFIGSTRINGS";
+			}
+			s = MSG_ReadBigString( msg );
+			len = strlen( s );
+			if ( len + 1 + gameState->dataCount > MAX_GAMESTATE_CHARS ) {
+				return "MAX_GAMESTATE_CHARS exceeded";
+			}
+
+			// append it to the gameState string buffer
+			gameState->stringOffsets[i] = gameState->dataCount;
+			Com_Memcpy( gameState->stringData + gameState->dataCount, s, len + 1 );
+			gameState->dataCount += len + 1;
+		} else if ( cmd == svc_baseline ) {
+			i = MSG_ReadBits( msg, GENTITYNUM_BITS );
+			if ( i < 0 || i >= MAX_GENTITIES ) {
+				return va( "Baseline number out of range: %i", i );
+			}
+			Com_Memset( &nullstate, 0, sizeof( nullstate ) );
+			MSG_ReadDeltaEntity( msg, &nullstate, &baselines[i], i );
+		} else {
+			return va( "bad command byte 0x%02X", cmd );
+		}
+	}
+}
+
+/*
+==================
+MSG_DeltaEntity
+
+Parses deltas from the given base and adds the resulting entity
+to the ring, returns qfalse if it was delta removed
+==================
+*/
+static qboolean MSG_DeltaEntity( msg_t *msg, parseEntities_t *pe, int newnum, entityState_t *old,
+												 qboolean unchanged ) {
+	entityState_t	*state;
+
+	// save the parsed entity state into the big circular buffer so
+	// it can be used as the source for a later delta
+	state = &pe->entities[pe->num & pe->mask];
+
+	if ( unchanged ) {
+		*state = *old;
+	} else {
+		MSG_ReadDeltaEntity( msg, old, state, newnum );
+	}
+
+	if ( state->number == ( MAX_GENTITIES - 1 ) ) {
+		return qfalse;		// entity was delta removed
+	}
+	pe->num++;
+	return qtrue;
+}
+
+/*
+==================
+MSG_OldEntity
+
+Entity oldindex of the oldCount ones starting at oldFirst, 99999 past the end
+==================
+*/
+static int MSG_OldEntity( parseEntities_t *pe, int oldFirst, int oldCount, int oldindex,
+												 entityState_t **oldstate ) {
+	if ( oldindex >= oldCount ) {
+		return 99999;
+	}
+	*oldstate = &pe->entities[( oldFirst + oldindex ) & pe->mask];
+	return ( *oldstate )->number;
+}
+
+/*
+==================
+MSG_ReadPacketEntities
+
+Reads the entities of a snapshot delta compressed against the oldCount
+ones starting at oldFirst in the ring (0 for a non-delta snapshot),
+appending them to the ring and counting them in numEntities
+==================
+*/
+const char *MSG_ReadPacketEntities( msg_t *msg, parseEntities_t *pe, int oldFirst, int oldCount,
+												 int *numEntities ) {
+	entityState_t	*oldstate;
+	int				newnum, oldindex, oldnum;
+
+	*numEntities = 0;
+
+	// delta from the entities present in the old frame
+	oldindex = 0;
+	oldstate = NULL;
+	oldnum = MSG_OldEntity( pe, oldFirst, oldCount, oldindex, &oldstate );
+
+	while ( 1 ) {
+		// read the entity index number
+		newnum = MSG_ReadBits( msg, GENTITYNUM_BITS );
+
+		if ( newnum == ( MAX_GENTITIES - 1 ) ) {
+			break;
+		}
+
+		if ( msg->readcount > msg->cursize ) {
+			return "end of message";
+		}
+
+		while ( oldnum < newnum ) {
+			// one or more entities from the old packet are unchanged
+			if ( cl_shownet->integer == 3 ) {
+				Com_Printf( "%3i:  unchanged: %i\n", msg->readcount, oldnum );
+			}
+			*numEntities += MSG_DeltaEntity( msg, pe, oldnum, oldstate, qtrue );
+			oldnum = MSG_OldEntity( pe, oldFirst, oldCount, ++oldindex, &oldstate );
+		}
+
+		if ( oldnum == newnum ) {
+			// delta from previous state
+			if ( cl_shownet->integer == 3 ) {
+				Com_Printf( "%3i:  delta: %i\n", msg->readcount, newnum );
+			}
+			*numEntities += MSG_DeltaEntity( msg, pe, newnum, oldstate, qfalse );
+			oldnum = MSG_OldEntity( pe, oldFirst, oldCount, ++oldindex, &oldstate );
+		} else {
+			// delta from baseline
+			if ( cl_shownet->integer == 3 ) {
+				Com_Printf( "%3i:  baseline: %i\n", msg->readcount, newnum );
+			}
+			*numEntities += MSG_DeltaEntity( msg, pe, newnum, &pe->baselines[newnum], qfalse );
+		}
+	}
+
+	// any remaining entities in the old frame are copied over
+	while ( oldnum != 99999 ) {
+		if ( cl_shownet->integer == 3 ) {
+			Com_Printf( "%3i:  unchanged: %i\n", msg->readcount, oldnum );
+		}
+		*numEntities += MSG_DeltaEntity( msg, pe, oldnum, oldstate, qtrue );
+		oldnum = MSG_OldEntity( pe, oldFirst, oldCount, ++oldindex, &oldstate );
+	}
+	return NULL;
+}
+
 int msg_hData[256] = {
 250315,			// 0
 41193,			// 1
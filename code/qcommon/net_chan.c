@@ -63,6 +63,42 @@ static char *netsrcString[2] = {
 	"server"
 };
 
+// payload copies that still happen between a message being encoded
+// and its datagram leaving, see Netchan_Stats_f
+netchanStats_t	netchanStats;
+
+/*
+===============
+Netchan_CountCopy
+===============
+*/
+void Netchan_CountCopy( int length ) {
+	netchanStats.copies++;
+	netchanStats.copiedBytes += length;
+}
+
+/*
+===============
+Netchan_Stats_f
+===============
+*/
+static void Netchan_Stats_f( void ) {
+	if ( Cmd_Argc() > 1 && !Q_stricmp( Cmd_Argv( 1 ), "reset" ) ) {
+		Com_Memset( &netchanStats, 0, sizeof( netchanStats ) );
+		return;
+	}
+
+	Com_Printf( "%llu packets, %llu bytes sent\n", netchanStats.packets, netchanStats.sentBytes );
+	Com_Printf( "%llu messages encoded in place\n", netchanStats.inPlace );
+	Com_Printf( "%llu copies, %llu bytes copied", netchanStats.copies, netchanStats.copiedBytes );
+	if ( netchanStats.sentBytes ) {
+		Com_Printf( " (%.2f per byte sent)", (double)netchanStats.copiedBytes / netchanStats.sentBytes );
+	}
+	Com_Printf( "\n" );
+	Com_Printf( "%llu sequenced packets received, %llu dropped, %llu out of order\n",
+		netchanStats.received, netchanStats.dropped, netchanStats.outOfOrder );
+}
+
 /*
 ===============
 Netchan_Init
@@ -74,6 +110,7 @@ void Netchan_Init( int port ) {
 	showpackets = Cvar_Get ("showpackets", "0", CVAR_TEMP );
 	showdrop = Cvar_Get ("showdrop", "0", CVAR_TEMP );
 	qport = Cvar_Get ("net_qport", va("%i", port), CVAR_INIT );
+	Cmd_AddCommand( "netchanstats", Netchan_Stats_f );
 }
 
 /*
@@ -187,22 +224,33 @@ static void Netchan_UnScramblePacket( msg_t *buf ) {
 
 /*
 =================
-Netchan_TransmitNextFragment
+Netchan_WriteHeader
 
-Send one fragment of the current message
+Writes the packet header into the headroom that precedes data, so the
+payload never has to be copied behind a header.  Returns the start of
+the packet; *length is grown by the size of the header.
 =================
 */
-void Netchan_TransmitNextFragment( netchan_t *chan ) {
+static byte *Netchan_WriteHeader( netchan_t *chan, byte *data, int *length, int sequence, qboolean fragment ) {
 	msg_t		send;
-	byte		send_buf[MAX_PACKETLEN];
-	int			fragmentLength;
-	int			outgoingSequence;
+	int			headerLength;
+
+	headerLength = 4;
+	if ( chan->sock == NS_CLIENT ) {
+		headerLength += 2;
+	}
+#ifdef LEGACY_PROTOCOL
+	if(!chan->compat)
+#endif
+		headerLength += 4;
+	if ( fragment ) {
+		headerLength += 4;
+	}
 
 	// write the packet header
-	MSG_InitOOB (&send, send_buf, sizeof(send_buf));				// <-- only do the oob here
+	MSG_InitOOB (&send, data - headerLength, headerLength);		// <-- only do the oob here
 
-	outgoingSequence = chan->outgoingSequence | FRAGMENT_BIT;
-	MSG_WriteLong(&send, outgoingSequence);
+	MSG_WriteLong( &send, sequence );
 
 	// send the qport if we are a client
 	if ( chan->sock == NS_CLIENT ) {
@@ -214,27 +262,49 @@ void Netchan_TransmitNextFragment( netchan_t *chan ) {
 #endif
 		MSG_WriteLong(&send, NETCHAN_GENCHECKSUM(chan->challenge, chan->outgoingSequence));
 
+	if ( fragment ) {
+		MSG_WriteShort( &send, chan->unsentFragmentStart );
+		MSG_WriteShort( &send, *length );
+	}
+
+	*length += headerLength;
+	return send.data;
+}
+
+/*
+=================
+Netchan_TransmitNextFragment
+
+Send one fragment of the current message.  The header is written over
+the tail of the previous fragment, which has already gone out.
+=================
+*/
+void Netchan_TransmitNextFragment( netchan_t *chan ) {
+	byte		*packet;
+	int			packetLength;
+	int			fragmentLength;
+
 	// copy the reliable message to the packet first
 	fragmentLength = FRAGMENT_SIZE;
 	if ( chan->unsentFragmentStart  + fragmentLength > chan->unsentLength ) {
 		fragmentLength = chan->unsentLength - chan->unsentFragmentStart;
 	}
 
-	MSG_WriteShort( &send, chan->unsentFragmentStart );
-	MSG_WriteShort( &send, fragmentLength );
-	MSG_WriteData( &send, chan->unsentBuffer + chan->unsentFragmentStart, fragmentLength );
+	packetLength = fragmentLength;
+	packet = Netchan_WriteHeader( chan, chan->unsentBuffer + NETCHAN_HEADER_SPACE + chan->unsentFragmentStart,
+		&packetLength, chan->outgoingSequence | FRAGMENT_BIT, qtrue );
 
 	// send the datagram
-	NET_SendPacket( chan->sock, send.cursize, send.data, chan->remoteAddress );
+	NET_SendPacket( chan->sock, packetLength, packet, chan->remoteAddress );
 
 	// Store send time and size of this packet for rate control
 	chan->lastSentTime = Sys_Milliseconds();
-	chan->lastSentSize = send.cursize;
+	chan->lastSentSize = packetLength;
 
 	if ( showpackets->integer ) {
 		Com_Printf ("%s send %4i : s=%i fragment=%i,%i\n"
 			, netsrcString[ chan->sock ]
-			, send.cursize
+			, packetLength
 			, chan->outgoingSequence
 			, chan->unsentFragmentStart, fragmentLength);
 	}
@@ -252,6 +322,24 @@ void Netchan_TransmitNextFragment( netchan_t *chan ) {
 }
 
 
+/*
+===============
+Netchan_Arena
+
+Returns the channel's own output buffer, with NETCHAN_HEADER_SPACE
+bytes of headroom in front of it, so a message can be encoded straight
+into it and sent without any copy.  NULL while the buffer still holds
+fragments of the previous message.
+================
+*/
+byte *Netchan_Arena( netchan_t *chan ) {
+	if ( chan->unsentFragments ) {
+		return NULL;
+	}
+	return chan->unsentBuffer + NETCHAN_HEADER_SPACE;
+}
+
+
 /*
 ===============
 Netchan_Transmit
@@ -261,19 +349,28 @@ A 0 length will still generate a packet.
 ================
 */
 void Netchan_Transmit( netchan_t *chan, int length, const byte *data ) {
-	msg_t		send;
-	byte		send_buf[MAX_PACKETLEN];
+	byte		*arena;
+	byte		*packet;
+	int			packetLength;
 
 	if ( length > MAX_MSGLEN ) {
 		Com_Error( ERR_DROP, "Netchan_Transmit: length = %i", length );
 	}
 	chan->unsentFragmentStart = 0;
 
+	// messages that were not encoded in place take the one remaining copy
+	arena = chan->unsentBuffer + NETCHAN_HEADER_SPACE;
+	if ( data != arena ) {
+		Com_Memcpy( arena, data, length );
+		Netchan_CountCopy( length );
+	} else {
+		netchanStats.inPlace++;
+	}
+
 	// fragment large reliable messages
 	if ( length >= FRAGMENT_SIZE ) {
 		chan->unsentFragments = qtrue;
 		chan->unsentLength = length;
-		Com_Memcpy( chan->unsentBuffer, data, length );
 
 		// only send the first fragment now
 		Netchan_TransmitNextFragment( chan );
@@ -281,36 +378,22 @@ void Netchan_Transmit( netchan_t *chan, int length, const byte *data ) {
 		return;
 	}
 
-	// write the packet header
-	MSG_InitOOB (&send, send_buf, sizeof(send_buf));
-
-	MSG_WriteLong( &send, chan->outgoingSequence );
-//	chan->outgoingSequence++;
-
-	// send the qport if we are a client
-	if ( chan->sock == NS_CLIENT ) 
-		MSG_WriteShort( &send, qport->integer );
-
-#ifdef LEGACY_PROTOCOL
-	if(!chan->compat)
-#endif
-		MSG_WriteLong(&send, NETCHAN_GENCHECKSUM(chan->challenge, chan->outgoingSequence));
+	packetLength = length;
+	packet = Netchan_WriteHeader( chan, arena, &packetLength, chan->outgoingSequence, qfalse );
 
 	chan->outgoingSequence++;
 
-	MSG_WriteData( &send, data, length );
-
 	// send the datagram
-	NET_SendPacket( chan->sock, send.cursize, send.data, chan->remoteAddress );
+	NET_SendPacket( chan->sock, packetLength, packet, chan->remoteAddress );
 
 	// Store send time and size of this packet for rate control
 	chan->lastSentTime = Sys_Milliseconds();
-	chan->lastSentSize = send.cursize;
+	chan->lastSentSize = packetLength;
 
 	if ( showpackets->integer ) {
 		Com_Printf( "%s send %4i : s=%i ack=%i\n"
 			, netsrcString[ chan->sock ]
-			, send.cursize
+			, packetLength
 			, chan->outgoingSequence - 1
 			, chan->incomingSequence );
 	}
@@ -373,6 +456,11 @@ qboolean Netchan_Process( netchan_t *chan, msg_t *msg ) {
 		fragmentLength = 0;
 	}
 
+	// time from arrival to here, averaged over about eight packets
+	if ( com_packetArrival ) {
+		chan->queueDelay += ( (int)( Sys_Microseconds() - com_packetArrival ) - chan->queueDelay ) / 8;
+	}
+
 	if ( showpackets->integer ) {
 		if ( fragmented ) {
 			Com_Printf( "%s recv %4i : s=%i fragment=%i,%i\n"
@@ -398,6 +486,7 @@ qboolean Netchan_Process( netchan_t *chan, msg_t *msg ) {
 				,  sequence
 				, chan->incomingSequence );
 		}
+		netchanStats.outOfOrder++;
 		return qfalse;
 	}
 
@@ -406,6 +495,7 @@ qboolean Netchan_Process( netchan_t *chan, msg_t *msg ) {
 	//
 	chan->dropped = sequence - (chan->incomingSequence+1);
 	if ( chan->dropped > 0 ) {
+		netchanStats.dropped += chan->dropped;
 		if ( showdrop->integer || showpackets->integer ) {
 			Com_Printf( "%s:Dropped %i packets at %i\n"
 			, NET_AdrToString( chan->remoteAddress )
@@ -482,6 +572,7 @@ qboolean Netchan_Process( netchan_t *chan, msg_t *msg ) {
 		// TTimo
 		// clients were not acking fragmented messages
 		chan->incomingSequence = sequence;
+		netchanStats.received++;
 		
 		return qtrue;
 	}
@@ -490,6 +581,7 @@ qboolean Netchan_Process( netchan_t *chan, msg_t *msg ) {
 	// the message can now be read from the current message pointer
 	//
 	chan->incomingSequence = sequence;
+	netchanStats.received++;
 
 	return qtrue;
 }
@@ -560,6 +652,7 @@ void NET_SendLoopPacket (netsrc_t sock, int length, const void *data, netadr_t t
 
 	Com_Memcpy (loop->msgs[i].data, data, length);
 	loop->msgs[i].datalen = length;
+	Netchan_CountCopy( length );
 }
 
 //=============================================================================
@@ -569,7 +662,7 @@ typedef struct packetQueue_s {
         int length;
         byte *data;
         netadr_t to;
-        int release;
+        unsigned long long release;     // Sys_Microseconds
 } packetQueue_t;
 
 packetQueue_t *packetQueue = NULL;
@@ -585,9 +678,10 @@ static void NET_QueuePacket( int length, const void *data, netadr_t to,
 	new = S_Malloc(sizeof(packetQueue_t));
 	new->data = S_Malloc(length);
 	Com_Memcpy(new->data, data, length);
+	Netchan_CountCopy( length );
 	new->length = length;
 	new->to = to;
-	new->release = Sys_Milliseconds() + (int)((float)offset / com_timescale->value);	
+	new->release = Sys_Microseconds() + (unsigned long long)( offset * 1000.0f / com_timescale->value );
 	new->next = NULL;
 
 	if(!packetQueue) {
@@ -606,10 +700,10 @@ static void NET_QueuePacket( int length, const void *data, netadr_t to,
 void NET_FlushPacketQueue(void)
 {
 	packetQueue_t *last;
-	int now;
+	unsigned long long now;
 
 	while(packetQueue) {
-		now = Sys_Milliseconds();
+		now = Sys_Microseconds();
 		if(packetQueue->release >= now)
 			break;
 		Sys_SendPacket(packetQueue->length, packetQueue->data,
@@ -623,11 +717,19 @@ void NET_FlushPacketQueue(void)
 
 void NET_SendPacket( netsrc_t sock, int length, const void *data, netadr_t to ) {
 
+	netchanStats.packets++;
+	netchanStats.sentBytes += length;
+
 	// sequenced packets are shown in netchan, so just show oob
 	if ( showpackets->integer && *(int *)data == -1 )	{
 		Com_Printf ("send packet %4i\n", length);
 	}
 
+	// a benchmark replay talks to nobody
+	if ( com_journal->integer == JOURNAL_BENCHMARK ) {
+		return;
+	}
+
 	if ( to.type == NA_LOOPBACK ) {
 		NET_SendLoopPacket (sock, length, data, to);
 		return;
@@ -117,6 +117,12 @@ static SOCKET   ip6_socket = INVALID_SOCKET;
 static SOCKET   socks_socket = INVALID_SOCKET;
 static SOCKET   multicast6_socket = INVALID_SOCKET;
 
+// optional receive thread, see NET_ReceiveThread
+static cvar_t   *net_recvThread;
+static void     *net_recvThreadHandle;
+static volatile qboolean        net_recvThreadQuit;
+static SOCKET   wake_socket = INVALID_SOCKET;
+
 // Keep track of currently joined multicast group.
 static struct ipv6_mreq curgroup;
 // And the currently bound address.
@@ -536,7 +542,16 @@ Never called by the game logic, just the system event queing
 int     recvfromCount;
 #endif
 
-qboolean Sys_GetPacket( netadr_t *net_from, msg_t *net_message ) {
+/*
+==================
+NET_RecvFrom
+
+Reads one datagram from s.  Returns 1 for a packet, 0 when there is
+nothing to read and -1 for one that was thrown away.  The receive
+thread passes verbose qfalse, it can't print.
+==================
+*/
+static int NET_RecvFrom( SOCKET s, netadr_t *net_from, msg_t *net_message, qboolean verbose ) {
         int     ret;
         struct sockaddr_storage from;
         socklen_t       fromlen;
@@ -546,108 +561,247 @@ qboolean Sys_GetPacket( netadr_t *net_from, msg_t *net_message ) {
         recvfromCount++;                // performance check
 #endif
 
-        if(ip_socket != INVALID_SOCKET)
+        fromlen = sizeof(from);
+        ret = recvfrom( s, (void *)net_message->data, net_message->maxsize, 0, (struct sockaddr *) &from, &fromlen );
+
+        if (ret == SOCKET_ERROR)
         {
-                fromlen = sizeof(from);
-                ret = recvfrom( ip_socket, (void *)net_message->data, net_message->maxsize, 0, (struct sockaddr *) &from, &fromlen );
+                err = socketError;
 
-                if (ret == SOCKET_ERROR)
-                {
-                        err = socketError;
+                if( verbose && err != EAGAIN && err != ECONNRESET )
+                        Com_Printf( "NET_GetPacket: %s\n", NET_ErrorString() );
+                return 0;
+        }
 
-                        if( err != EAGAIN && err != ECONNRESET )
-                                Com_Printf( "NET_GetPacket: %s\n", NET_ErrorString() );
+        if ( s == ip_socket )
+        {
+                memset( ((struct sockaddr_in *)&from)->sin_zero, 0, 8 );
+        }
+
+        if ( s == ip_socket && usingSocks && memcmp( &from, &socksRelayAddr, fromlen ) == 0 ) {
+                if ( ret < 10 || net_message->data[0] != 0 || net_message->data[1] != 0 || net_message->data[2] != 0 || net_message->data[3] != 1 ) {
+                        return -1;
                 }
-                else
-                {
+                net_from->type = NA_IP;
+                net_from->ip[0] = net_message->data[4];
+                net_from->ip[1] = net_message->data[5];
+                net_from->ip[2] = net_message->data[6];
+                net_from->ip[3] = net_message->data[7];
+                net_from->port = *(short *)&net_message->data[8];
+                net_message->readcount = 10;
+        }
+        else {
+                SockadrToNetadr( (struct sockaddr *) &from, net_from );
+                net_message->readcount = 0;
+        }
 
-                        memset( ((struct sockaddr_in *)&from)->sin_zero, 0, 8 );
+        if( ret == net_message->maxsize ) {
+                if ( verbose )
+                        Com_Printf( "Oversize packet from %s\n", NET_AdrToString (*net_from) );
+                return -1;
+        }
 
-                        if ( usingSocks && memcmp( &from, &socksRelayAddr, fromlen ) == 0 ) {
-                                if ( ret < 10 || net_message->data[0] != 0 || net_message->data[1] != 0 || net_message->data[2] != 0 || net_message->data[3] != 1 ) {
-                                        return qfalse;
-                                }
-                                net_from->type = NA_IP;
-                                net_from->ip[0] = net_message->data[4];
-                                net_from->ip[1] = net_message->data[5];
-                                net_from->ip[2] = net_message->data[6];
-                                net_from->ip[3] = net_message->data[7];
-                                net_from->port = *(short *)&net_message->data[8];
-                                net_message->readcount = 10;
-                        }
-                        else {
-                                SockadrToNetadr( (struct sockaddr *) &from, net_from );
-                                net_message->readcount = 0;
-                        }
+        net_message->cursize = ret;
+        return 1;
+}
 
-                        if( ret == net_message->maxsize ) {
-                                Com_Printf( "Oversize packet from %s\n", NET_AdrToString (*net_from) );
-                                return qfalse;
-                        }
+/*
+==================
+Sys_GetPacket
 
-                        net_message->cursize = ret;
-                        return qtrue;
-                }
+Never returns anything while the receive thread owns the sockets
+==================
+*/
+qboolean Sys_GetPacket( netadr_t *net_from, msg_t *net_message ) {
+        int     ret;
+
+        if ( net_recvThreadHandle )
+                return qfalse;
+
+        if(ip_socket != INVALID_SOCKET)
+        {
+                ret = NET_RecvFrom( ip_socket, net_from, net_message, qtrue );
+                if ( ret )
+                        return ret > 0;
         }
 
         if(ip6_socket != INVALID_SOCKET)
         {
-                fromlen = sizeof(from);
-                ret = recvfrom(ip6_socket, (void *)net_message->data, net_message->maxsize, 0, (struct sockaddr *) &from, &fromlen);
+                ret = NET_RecvFrom( ip6_socket, net_from, net_message, qtrue );
+                if ( ret )
+                        return ret > 0;
+        }
 
-                if (ret == SOCKET_ERROR)
-                {
-                        err = socketError;
+        if(multicast6_socket != INVALID_SOCKET && multicast6_socket != ip6_socket)
+        {
+                ret = NET_RecvFrom( multicast6_socket, net_from, net_message, qtrue );
+                if ( ret )
+                        return ret > 0;
+        }
+
+        return qfalse;
+}
+
+/*
+==================
+NET_ReceiveThread
 
-                        if( err != EAGAIN && err != ECONNRESET )
-                                Com_Printf( "NET_GetPacket: %s\n", NET_ErrorString() );
+Blocks on the sockets and queues every datagram with its arrival time,
+then pokes wake_socket so NET_Sleep returns. Nothing is read while the
+packet ring is full, the kernel keeps those datagrams meanwhile
+==================
+*/
+static void NET_ReceiveThread( void *arg ) {
+        static byte     data[MAX_MSGLEN];
+        struct timeval  timeout;
+        fd_set          fdset;
+        SOCKET          sockets[3];
+        netadr_t        from;
+        msg_t           msg;
+        int             i, numSockets, highestfd, received, ret;
+        char            wake = 0;
+
+        numSockets = 0;
+        if ( ip_socket != INVALID_SOCKET )
+                sockets[numSockets++] = ip_socket;
+        if ( ip6_socket != INVALID_SOCKET )
+                sockets[numSockets++] = ip6_socket;
+        if ( multicast6_socket != INVALID_SOCKET && multicast6_socket != ip6_socket )
+                sockets[numSockets++] = multicast6_socket;
+
+        while ( !net_recvThreadQuit ) {
+                FD_ZERO( &fdset );
+                highestfd = -1;
+                for ( i = 0 ; i < numSockets ; i++ ) {
+                        FD_SET( sockets[i], &fdset );
+                        if ( (int)sockets[i] > highestfd )
+                                highestfd = sockets[i];
                 }
-                else
-                {
-                        SockadrToNetadr((struct sockaddr *) &from, net_from);
-                        net_message->readcount = 0;
 
-                        if(ret == net_message->maxsize)
-                        {
-                                Com_Printf( "Oversize packet from %s\n", NET_AdrToString (*net_from) );
-                                return qfalse;
-                        }
+                // wake up now and then to see if we should quit
+                timeout.tv_sec = 0;
+                timeout.tv_usec = 100000;
+                if ( select( highestfd + 1, &fdset, NULL, NULL, &timeout ) <= 0 )
+                        continue;
+
+                received = 0;
+                for ( i = 0 ; i < numSockets ; i++ ) {
+                        if ( !FD_ISSET( sockets[i], &fdset ) )
+                                continue;
+
+                        while ( 1 ) {
+                                if ( !Com_WaitPacketSpace( 0 ) ) {
+                                        // the ring is full, have the main thread drain it and
+                                        // leave the rest in the socket buffer until there is room
+                                        if ( received && wake_socket != INVALID_SOCKET ) {
+                                                send( wake_socket, &wake, 1, 0 );
+                                                received = 0;
+                                        }
+                                        if ( net_recvThreadQuit || !Com_WaitPacketSpace( 100 ) )
+                                                break;
+                                }
 
-                        net_message->cursize = ret;
-                        return qtrue;
+                                MSG_Init( &msg, data, sizeof( data ) );
+                                ret = NET_RecvFrom( sockets[i], &from, &msg, qfalse );
+                                if ( !ret )
+                                        break;
+                                if ( ret > 0 ) {
+                                        // the queue keeps only the payload, skip a socks header here
+                                        Com_QueuePacketEvent( &from, msg.data + msg.readcount, msg.cursize - msg.readcount );
+                                        received++;
+                                }
+                        }
                 }
+
+                if ( received && wake_socket != INVALID_SOCKET )
+                        send( wake_socket, &wake, 1, 0 );
         }
+}
 
-        if(multicast6_socket != INVALID_SOCKET && multicast6_socket != ip6_socket)
-        {
-                fromlen = sizeof(from);
-                ret = recvfrom(multicast6_socket, (void *)net_message->data, net_message->maxsize, 0, (struct sockaddr *) &from, &fromlen);
+/*
+==================
+NET_OpenWakeSocket
 
-                if (ret == SOCKET_ERROR)
-                {
-                        err = socketError;
+A loopback datagram socket connected to itself, the receive thread sends
+to it and NET_Sleep selects on it, which works for winsock too
+==================
+*/
+static SOCKET NET_OpenWakeSocket( void ) {
+        SOCKET                  s;
+        struct sockaddr_in      address;
+        socklen_t               length;
+        u_long                  _true = 1;
 
-                        if( err != EAGAIN && err != ECONNRESET )
-                                Com_Printf( "NET_GetPacket: %s\n", NET_ErrorString() );
-                }
-                else
-                {
-                        SockadrToNetadr((struct sockaddr *) &from, net_from);
-                        net_message->readcount = 0;
+        if( ( s = socket( PF_INET, SOCK_DGRAM, IPPROTO_UDP ) ) == INVALID_SOCKET )
+                return INVALID_SOCKET;
 
-                        if(ret == net_message->maxsize)
-                        {
-                                Com_Printf( "Oversize packet from %s\n", NET_AdrToString (*net_from) );
-                                return qfalse;
-                        }
+        memset( &address, 0, sizeof( address ) );
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+        address.sin_port = 0;
+        length = sizeof( address );
+
+        if( ioctlsocket( s, FIONBIO, &_true ) == SOCKET_ERROR ||
+                bind( s, (struct sockaddr *)&address, sizeof( address ) ) == SOCKET_ERROR ||
+                getsockname( s, (struct sockaddr *)&address, &length ) == SOCKET_ERROR ||
+                connect( s, (struct sockaddr *)&address, sizeof( address ) ) == SOCKET_ERROR ) {
+                Com_Printf( "WARNING: NET_OpenWakeSocket: %s\n", NET_ErrorString() );
+                closesocket( s );
+                return INVALID_SOCKET;
+        }
 
-                        net_message->cursize = ret;
-                        return qtrue;
-                }
+        return s;
+}
+
+/*
+==================
+NET_StartReceiveThread
+==================
+*/
+static void NET_StartReceiveThread( void ) {
+        if ( net_recvThreadHandle || !net_recvThread->integer )
+                return;
+
+        // a replayed journal gets its packets from the journal
+        if ( com_journal && com_journal->integer >= 2 )
+                return;
+
+        if ( ip_socket == INVALID_SOCKET && ip6_socket == INVALID_SOCKET )
+                return;
+
+        wake_socket = NET_OpenWakeSocket();
+        if ( wake_socket == INVALID_SOCKET )
+                return;
+
+        net_recvThreadQuit = qfalse;
+        net_recvThreadHandle = Sys_CreateThread( NET_ReceiveThread, NULL );
+        if ( !net_recvThreadHandle ) {
+                Com_Printf( "WARNING: couldn't start the network receive thread\n" );
+                closesocket( wake_socket );
+                wake_socket = INVALID_SOCKET;
+                return;
         }
 
+        Com_DPrintf( "Network receive thread started\n" );
+}
 
-        return qfalse;
+/*
+==================
+NET_StopReceiveThread
+
+Has to happen before the sockets it reads from are closed
+==================
+*/
+static void NET_StopReceiveThread( void ) {
+        if ( !net_recvThreadHandle )
+                return;
+
+        net_recvThreadQuit = qtrue;
+        Sys_JoinThread( net_recvThreadHandle );
+        net_recvThreadHandle = NULL;
+
+        closesocket( wake_socket );
+        wake_socket = INVALID_SOCKET;
 }
 
 //=============================================================================
@@ -1017,11 +1171,10 @@ void NET_SetMulticast6(void)
 
 /*
 ====================
-NET_JoinMulticast
-Join an ipv6 multicast group
+NET_JoinMulticast6Socket
 ====================
 */
-void NET_JoinMulticast6(void)
+static void NET_JoinMulticast6Socket(void)
 {
         int err;
 
@@ -1071,16 +1224,40 @@ void NET_JoinMulticast6(void)
         }
 }
 
+/*
+====================
+NET_JoinMulticast
+Join an ipv6 multicast group
+====================
+*/
+void NET_JoinMulticast6(void)
+{
+        qboolean        threaded = net_recvThreadHandle != NULL;
+
+        // the receive thread picks its sockets when it starts
+        NET_StopReceiveThread();
+        NET_JoinMulticast6Socket();
+        if(threaded)
+                NET_StartReceiveThread();
+}
+
 void NET_LeaveMulticast6()
 {
         if(multicast6_socket != INVALID_SOCKET)
         {
+                qboolean        threaded = net_recvThreadHandle != NULL;
+
+                NET_StopReceiveThread();
+
                 if(multicast6_socket != ip6_socket)
                         closesocket(multicast6_socket);
                 else
                         setsockopt(multicast6_socket, IPPROTO_IPV6, IPV6_LEAVE_GROUP, (char *) &curgroup, sizeof(curgroup));
 
                 multicast6_socket = INVALID_SOCKET;
+
+                if(threaded)
+                        NET_StartReceiveThread();
         }
 }
 
@@ -1519,6 +1696,11 @@ static qboolean NET_GetCvars( void ) {
         modified += net_socksPassword->modified;
         net_socksPassword->modified = qfalse;
 
+        // read the sockets on a thread of their own, packets get queued with their arrival time
+        net_recvThread = Cvar_Get( "net_recvThread", "0", CVAR_LATCH | CVAR_ARCHIVE );
+        modified += net_recvThread->modified;
+        net_recvThread->modified = qfalse;
+
         return modified ? qtrue : qfalse;
 }
 
@@ -1568,6 +1750,8 @@ void NET_Config( qboolean enableNetworking ) {
         }
 
         if( stop ) {
+                NET_StopReceiveThread();
+
                 if ( ip_socket != INVALID_SOCKET ) {
                         closesocket( ip_socket );
                         ip_socket = INVALID_SOCKET;
@@ -1599,6 +1783,7 @@ void NET_Config( qboolean enableNetworking ) {
                 {
                         NET_OpenIP();
                         NET_SetMulticast6();
+                        NET_StartReceiveThread();
                 }
         }
 }
@@ -1687,6 +1872,9 @@ void NET_Sleep( int msec ) {
         if (!com_dedicated->integer)
                 return; // we're not a server, just run full speed
 
+        if (com_journal->integer == JOURNAL_BENCHMARK)
+                return; // replaying a journal, time comes from the journal
+
         if (ip_socket == INVALID_SOCKET && ip6_socket == INVALID_SOCKET)
                 return;
 
@@ -1695,6 +1883,22 @@ void NET_Sleep( int msec ) {
 
         FD_ZERO(&fdset);
 
+        // the receive thread owns the sockets, wait for it to queue something
+        if (net_recvThreadHandle)
+        {
+                char    drain[64];
+
+                FD_SET(wake_socket, &fdset);
+                timeout.tv_sec = msec/1000;
+                timeout.tv_usec = (msec%1000)*1000;
+                if (select(wake_socket + 1, &fdset, NULL, NULL, &timeout) > 0)
+                {
+                        while (recv(wake_socket, drain, sizeof(drain), 0) > 0)
+                                ;
+                }
+                return;
+        }
+
         if(ip_socket != INVALID_SOCKET)
         {
                 FD_SET(ip_socket, &fdset);
@@ -0,0 +1,309 @@
+/*
+===========================================================================
+Copyright (C) 1999-2005 Id Software, Inc.
+
+This file is part of Quake III Arena source code.
+
+Quake III Arena source code is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the License,
+or (at your option) any later version.
+
+Quake III Arena source code is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Quake III Arena source code; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+===========================================================================
+*/
+// perf.c -- per frame timing histograms
+
+#include "q_shared.h"
+#include "qcommon.h"
+
+/*
+
+Every scope keeps a log-linear histogram of its durations in microseconds:
+values below 32 get a bucket each, above that every power of two is split
+in 16, so a reported percentile is within about 3% of the real one from
+1 usec up to an hour.
+
+Two histograms are kept per scope and the older one is thrown away every
+com_perfWindow seconds, percentiles are taken over both, so they always
+cover between one and two windows of recent frames.  com_perfWindow 0
+keeps accumulating until "perfstats reset".
+
+*/
+
+#define PERF_SUB_BITS		4
+#define PERF_SUB_BUCKETS	( 1 << PERF_SUB_BITS )
+#define PERF_LINEAR			( PERF_SUB_BUCKETS * 2 )			// exact below this
+#define PERF_BUCKETS		( PERF_LINEAR + ( 32 - PERF_SUB_BITS - 1 ) * PERF_SUB_BUCKETS )
+
+typedef struct {
+	unsigned			buckets[PERF_BUCKETS];
+	unsigned			count;
+	unsigned long long	total;
+	unsigned			max;
+} perfHistogram_t;
+
+typedef struct {
+	perfHistogram_t		hist[2];
+	int					current;
+} perfScopeStats_t;
+
+static const char *perfScopeNames[PERF_NUM_SCOPES] = {
+	"frame",
+	"events",
+	"event_latency",
+	"sv_frame",
+	"game_frame",
+	"snapshots",
+	"render_front",
+	"render_back",
+	"trace_at_time"
+};
+
+static perfScopeStats_t	perfScopes[PERF_NUM_SCOPES];
+static int				perfWindowStart;
+
+cvar_t	*com_perf;
+cvar_t	*com_perfWindow;
+
+/*
+================
+Perf_Bucket
+================
+*/
+static int Perf_Bucket( unsigned value ) {
+	int		msb;
+
+	if ( value < PERF_LINEAR ) {
+		return value;
+	}
+
+	msb = 31;
+	while ( !( value & ( 1u << msb ) ) ) {
+		msb--;
+	}
+	// value >> ( msb - PERF_SUB_BITS ) keeps the top PERF_SUB_BITS + 1 bits
+	return PERF_LINEAR + ( msb - PERF_SUB_BITS - 1 ) * PERF_SUB_BUCKETS
+		+ ( ( value >> ( msb - PERF_SUB_BITS ) ) - PERF_SUB_BUCKETS );
+}
+
+/*
+================
+Perf_BucketValue
+
+Middle of the range a bucket covers
+================
+*/
+static unsigned Perf_BucketValue( int bucket ) {
+	int		shift;
+
+	if ( bucket < PERF_LINEAR ) {
+		return bucket;
+	}
+
+	bucket -= PERF_LINEAR;
+	shift = bucket / PERF_SUB_BUCKETS + 1;
+	return ( ( bucket % PERF_SUB_BUCKETS + PERF_SUB_BUCKETS ) << shift ) + ( 1u << shift ) / 2;
+}
+
+/*
+================
+Perf_Begin
+
+Returns 0 when timing is off, Perf_End ignores that
+================
+*/
+perfTime_t Perf_Begin( void ) {
+	if ( !com_perf || !com_perf->integer ) {
+		return 0;
+	}
+	return Sys_Microseconds();
+}
+
+/*
+================
+Perf_Record
+================
+*/
+void Perf_Record( perfScope_t scope, unsigned usec ) {
+	perfHistogram_t	*h;
+
+	if ( (unsigned)scope >= PERF_NUM_SCOPES || !com_perf || !com_perf->integer ) {
+		return;
+	}
+
+	h = &perfScopes[scope].hist[perfScopes[scope].current];
+	h->buckets[Perf_Bucket( usec )]++;
+	h->count++;
+	h->total += usec;
+	if ( usec > h->max ) {
+		h->max = usec;
+	}
+}
+
+/*
+================
+Perf_End
+================
+*/
+void Perf_End( perfScope_t scope, perfTime_t start ) {
+	if ( !start ) {
+		return;
+	}
+	Perf_Record( scope, (unsigned)( Sys_Microseconds() - start ) );
+}
+
+/*
+================
+Perf_Frame
+
+Rotates the rolling window, called once per Com_Frame
+================
+*/
+void Perf_Frame( void ) {
+	int		i, now;
+
+	if ( !com_perf->integer || com_perfWindow->integer <= 0 ) {
+		return;
+	}
+
+	now = Sys_Milliseconds();
+	if ( now - perfWindowStart < com_perfWindow->integer * 1000 ) {
+		return;
+	}
+	perfWindowStart = now;
+
+	for ( i = 0; i < PERF_NUM_SCOPES; i++ ) {
+		perfScopes[i].current ^= 1;
+		Com_Memset( &perfScopes[i].hist[perfScopes[i].current], 0, sizeof( perfHistogram_t ) );
+	}
+}
+
+/*
+================
+Perf_Percentile
+
+Over both halves of the window, fraction in 0..1
+================
+*/
+static unsigned Perf_Percentile( const perfScopeStats_t *s, float fraction ) {
+	unsigned	target, seen;
+	int			i;
+
+	target = (unsigned)( fraction * ( s->hist[0].count + s->hist[1].count ) );
+	if ( target < 1 ) {
+		target = 1;
+	}
+
+	seen = 0;
+	for ( i = 0; i < PERF_BUCKETS; i++ ) {
+		seen += s->hist[0].buckets[i] + s->hist[1].buckets[i];
+		if ( seen >= target ) {
+			return Perf_BucketValue( i );
+		}
+	}
+	return 0;
+}
+
+/*
+================
+Perf_Summary
+
+Totals and percentiles of a scope over the current window
+================
+*/
+void Perf_Summary( perfScope_t scope, perfSummary_t *out ) {
+	const perfScopeStats_t	*s;
+
+	Com_Memset( out, 0, sizeof( *out ) );
+	if ( (unsigned)scope >= PERF_NUM_SCOPES ) {
+		return;
+	}
+
+	s = &perfScopes[scope];
+	out->count = s->hist[0].count + s->hist[1].count;
+	if ( !out->count ) {
+		return;
+	}
+	out->total = s->hist[0].total + s->hist[1].total;
+	out->max = s->hist[0].max > s->hist[1].max ? s->hist[0].max : s->hist[1].max;
+	out->p50 = Perf_Percentile( s, 0.5f );
+	out->p90 = Perf_Percentile( s, 0.9f );
+	out->p99 = Perf_Percentile( s, 0.99f );
+}
+
+/*
+================
+Perf_ScopeName
+================
+*/
+const char *Perf_ScopeName( perfScope_t scope ) {
+	if ( (unsigned)scope >= PERF_NUM_SCOPES ) {
+		return "";
+	}
+	return perfScopeNames[scope];
+}
+
+/*
+================
+Perf_Stats_f
+
+perfstats [reset|dump]
+================
+*/
+static void Perf_Stats_f( void ) {
+	perfSummary_t	sum;
+	qboolean	dump;
+	int			i;
+
+	if ( !Q_stricmp( Cmd_Argv( 1 ), "reset" ) ) {
+		Com_Memset( perfScopes, 0, sizeof( perfScopes ) );
+		perfWindowStart = Sys_Milliseconds();
+		return;
+	}
+	// one key=value line per scope, for scripts polling over rcon
+	dump = !Q_stricmp( Cmd_Argv( 1 ), "dump" );
+
+	if ( !dump ) {
+		if ( !com_perf->integer ) {
+			Com_Printf( "com_perf is 0, nothing is being recorded\n" );
+		}
+		Com_Printf( "usec          count      mean       p50       p90       p99       max\n" );
+	}
+
+	for ( i = 0; i < PERF_NUM_SCOPES; i++ ) {
+		Perf_Summary( i, &sum );
+
+		if ( dump ) {
+			Com_Printf( "perf scope=%s count=%u mean=%llu p50=%u p90=%u p99=%u max=%u\n",
+				perfScopeNames[i], sum.count, sum.count ? sum.total / sum.count : 0,
+				sum.p50, sum.p90, sum.p99, sum.max );
+			continue;
+		}
+		if ( !sum.count ) {
+			continue;
+		}
+		Com_Printf( "%-12s %6u %9llu %9u %9u %9u %9u\n", perfScopeNames[i], sum.count, sum.total / sum.count,
+			sum.p50, sum.p90, sum.p99, sum.max );
+	}
+}
+
+/*
+================
+Perf_Init
+================
+*/
+void Perf_Init( void ) {
+	com_perf = Cvar_Get( "com_perf", "1", 0 );
+	com_perfWindow = Cvar_Get( "com_perfWindow", "60", 0 );
+	Cmd_AddCommand( "perfstats", Perf_Stats_f );
+
+	perfWindowStart = Sys_Milliseconds();
+}
@@ -987,6 +987,7 @@ struct cvar_s {
 };
 
 #define MAX_CVAR_VALUE_STRING   256
+#define MAX_CVAR_HANDLES        2048    // cvar handles are below this
 
 typedef int     cvarHandle_t;
 
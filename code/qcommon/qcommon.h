@@ -109,6 +109,20 @@ void MSG_ReadDeltaEntity( msg_t *msg, entityState_t *from, entityState_t *to,
 void MSG_WriteDeltaPlayerstate( msg_t *msg, struct playerState_s *from, struct playerState_s *to );
 void MSG_ReadDeltaPlayerstate( msg_t *msg, struct playerState_s *from, struct playerState_s *to );
 
+// packet entities parsed from a snapshot go into a ring of mask + 1 states,
+// shared by the client and demoanalyze
+typedef struct {
+	entityState_t		*entities;
+	int					mask;
+	int					num;			// index (not anded off) of the next free state
+	entityState_t		*baselines;		// MAX_GENTITIES, for entities not in the old frame
+} parseEntities_t;
+
+// these return NULL or what was wrong with the message
+const char *MSG_ReadGamestate( msg_t *msg, gameState_t *gameState, entityState_t *baselines );
+const char *MSG_ReadPacketEntities( msg_t *msg, parseEntities_t *pe, int oldFirst, int oldCount,
+												 int *numEntities );
+
 
 void MSG_ReportChangeVectors_f( void );
 
@@ -201,6 +215,9 @@ void			NET_Sleep(int msec);
 Netchan handles packet fragmentation and out of order / duplicate suppression
 */
 
+// room for the largest packet header, written in front of the payload
+#define NETCHAN_HEADER_SPACE	16
+
 typedef struct {
 		netsrc_t		sock;
 
@@ -220,15 +237,18 @@ typedef struct {
 
 		// outgoing fragment buffer
 		// we need to space out the sending of large fragmented messages
+		// messages are encoded after NETCHAN_HEADER_SPACE, see Netchan_Arena
 		qboolean		unsentFragments;
 		int 					unsentFragmentStart;
 		int 					unsentLength;
-		byte			unsentBuffer[MAX_MSGLEN];
+		byte			unsentBuffer[NETCHAN_HEADER_SPACE + MAX_MSGLEN];
 
 		int 					challenge;
 		int 			lastSentTime;
 		int 			lastSentSize;
 
+		int 			queueDelay;		// usec between a packet's arrival and its processing, averaged
+
 #ifdef LEGACY_PROTOCOL
 		qboolean		compat;
 #endif
@@ -239,6 +259,22 @@ void Netchan_Setup(netsrc_t sock, netchan_t *chan, netadr_t adr, int qport, int
 
 void Netchan_Transmit( netchan_t *chan, int length, const byte *data );
 void Netchan_TransmitNextFragment( netchan_t *chan );
+byte *Netchan_Arena( netchan_t *chan );
+
+typedef struct {
+	unsigned long long	packets;
+	unsigned long long	sentBytes;
+	unsigned long long	inPlace;		// messages sent out of Netchan_Arena
+	unsigned long long	copies;
+	unsigned long long	copiedBytes;
+	unsigned long long	received;		// sequenced packets accepted by Netchan_Process
+	unsigned long long	dropped;		// gaps in the incoming sequence
+	unsigned long long	outOfOrder;
+} netchanStats_t;
+
+extern netchanStats_t	netchanStats;
+
+void Netchan_CountCopy( int length );
 
 qboolean Netchan_Process( netchan_t *chan, msg_t *msg );
 
@@ -257,6 +293,46 @@ PROTOCOL
 #define DEMO_PROTOCOL_VERSION	70
 // 1.31 - 67
 
+/*
+compressed, seekable demo container (sv_democompress)
+
+header:  DEMOZ_MAGIC, DEMOZ_VERSION, keyframe msec, modversion length + string, DEMO_PROTOCOL_VERSION
+blocks:  raw size, packed size, serverTime, gamestate size, data (stored if packed size == raw size)
+trailer: block count, demozIndex_t * block count, offset of the trailer, DEMOZ_INDEX_MAGIC
+
+The data of a block is the usual <sequence><length><message> record stream.
+A block with a gamestate size starts with a gamestate record followed by a
+non-delta snapshot, so playback can start from it; other blocks only
+continue the previous one.
+*/
+#define DEMOZ_MAGIC			0x5a445455	// "UTDZ"
+#define DEMOZ_INDEX_MAGIC	0x58445455	// "UTDX"
+#define DEMOZ_VERSION		1
+#define DEMOZ_EXT			"urtdemoz"
+#define DEMOZ_MAX_BLOCK		0x40000
+
+typedef struct {
+	int		offset;			// file offset of the block header
+	int		serverTime;		// time of the keyframe starting the block
+	int		gamestateSize;	// 0 for continuation blocks
+} demozIndex_t;
+
+typedef struct {
+	fileHandle_t	file;
+	int				keyframeMsec;
+	demozIndex_t	*index;
+	int				numBlocks;
+	int				blockNum;		// next block to load
+	byte			*block;			// inflated messages of the current block
+	int				blockSize;
+	int				blockPos;
+} demozReader_t;
+
+qboolean DemoZ_Open( demozReader_t *dz, fileHandle_t f, int size, const char *name );
+qboolean DemoZ_LoadBlock( demozReader_t *dz, int n, qboolean gamestate );
+qboolean DemoZ_ReadMessage( demozReader_t *dz, msg_t *buf, int *sequence );
+void DemoZ_Free( demozReader_t *dz );
+
 // maintain a list of compatible protocols for demo playing
 // NOTE: that stuff only works with two digits protocols
 extern int demo_protocols[];
@@ -517,6 +593,15 @@ void	Cvar_Register( vmCvar_t *vmCvar, const char *varName, const char *defaultVa
 void	Cvar_Update( vmCvar_t *vmCvar );
 // updates an interpreted modules' version of a cvar
 
+typedef enum {
+	CVAR_GEN_GAME,
+	CVAR_GEN_CGAME,
+	CVAR_GEN_MAX
+} cvarGenModule_t;
+
+void	Cvar_SetGenerations( int module, int *table, int count );
+// keeps table[handle] equal to each cvar's modificationCount, NULL unregisters
+
 void	Cvar_Set( const char *var_name, const char *value );
 // will create the variable with no flags if it doesn't exist
 
@@ -672,6 +757,11 @@ void	FS_ForceFlush( fileHandle_t f );
 void	FS_FreeFile( void *buffer );
 // frees the memory returned by FS_ReadFile
 
+void	*FS_MapShared( const char *qpath, int *length );
+void	FS_UnmapShared( void *data, int length );
+// read-only mapping of a pk3 file through the fs_sharedCache directory,
+// NULL if that isn't possible
+
 void	FS_WriteFile( const char *qpath, const void *buffer, int size );
 // writes a complete file, creating any subdirectories needed
 
@@ -683,6 +773,9 @@ int 			FS_FTell( fileHandle_t f );
 
 void	FS_Flush( fileHandle_t f );
 
+FILE	*FS_StdioHandle( fileHandle_t f );
+// the FILE behind a handle we are writing to, NULL for anything else
+
 void	QDECL FS_Printf( fileHandle_t f, const char *fmt, ... ) __attribute__ ((format (printf, 2, 3)));
 // like fprintf
 
@@ -806,6 +899,10 @@ typedef struct {
 } sysEvent_t;
 
 void			Com_QueueEvent( int time, sysEventType_t type, int value, int value2, int ptrLength, void *ptr );
+void			Com_QueueConsoleEvent( const char *text );
+void			Com_QueuePacketEvent( const netadr_t *from, const byte *data, int length );
+qboolean		Com_WaitPacketSpace( int msec );
+extern unsigned long long	com_packetArrival;		// Sys_Microseconds the dispatched packet arrived, or 0
 int 					Com_EventLoop( void );
 sysEvent_t		Com_GetSystemEvent( void );
 
@@ -837,7 +934,6 @@ void			Com_StartupVariable( const char *match );
 extern	cvar_t	*com_developer;
 extern	cvar_t	*com_dedicated;
 extern	cvar_t	*com_speeds;
-extern	cvar_t	*com_speeds2;
 extern	cvar_t	*com_timescale;
 extern	cvar_t	*com_sv_running;
 extern	cvar_t	*com_cl_running;
@@ -882,6 +978,12 @@ extern	qboolean		com_errorEntered;
 extern	fileHandle_t	com_journalFile;
 extern	fileHandle_t	com_journalDataFile;
 
+// journal 3 replays like 2, but as fast as possible with the network
+// stubbed out, and reports frame timings when the journal runs out
+#define	JOURNAL_BENCHMARK	3
+
+void Com_BenchmarkFrame( int gameUsec, int snapshotUsec );
+
 typedef enum {
 		TAG_FREE,
 		TAG_GENERAL,
@@ -1085,6 +1187,7 @@ void	Sys_Print( const char *msg );
 // Sys_Milliseconds should only be used for profiling purposes,
 // any game related timing information should come from event timestamps
 int 			Sys_Milliseconds (void);
+unsigned long long	Sys_Microseconds (void);
 
 void	Sys_SnapVector( float *v );
 
@@ -1150,6 +1253,80 @@ typedef enum
 dialogResult_t Sys_Dialog( dialogType_t type, const char *message, const char *title );
 
 qboolean Sys_WritePIDFile( void );
+int Sys_PID( void );
+
+// background threads, see log.c
+typedef void (*threadFunc_t)( void *arg );
+
+void	*Sys_CreateThread( threadFunc_t function, void *arg );
+void	Sys_JoinThread( void *thread );
+void	Sys_ThreadSleep( int msec );	// unlike Sys_Sleep this never waits on stdin
+
+// counting semaphores, so threads can hand work over without polling
+void		*Sys_CreateSemaphore( int count );
+void		Sys_DestroySemaphore( void *sem );
+void		Sys_SemaphorePost( void *sem );
+qboolean	Sys_SemaphoreWait( void *sem, int msec );	// msec < 0 waits forever, qfalse on timeout
+
+// lock-free primitives, every compiler we build with has the gcc builtins
+#define Sys_AtomicAdd( ptr, value )				__sync_fetch_and_add( ( ptr ), ( value ) )
+#define Sys_AtomicCompareSwap( ptr, oldv, newv )	__sync_bool_compare_and_swap( ( ptr ), ( oldv ), ( newv ) )
+#define Sys_MemoryBarrier()						__sync_synchronize()
+
+// read-only file mappings, shared with every process mapping the same file
+void	*Sys_MapFile( const char *ospath, int *length );
+void	Sys_UnmapFile( void *data, int length );
+
+/*
+==============================================================
+
+ASYNC LOG
+
+==============================================================
+*/
+
+void	AsyncLog_Init( void );
+void	AsyncLog_Shutdown( void );
+void	AsyncLog_Open( fileHandle_t f, qboolean flushLines );
+void	AsyncLog_Close( fileHandle_t f );
+void	AsyncLog_Write( fileHandle_t f, const void *data, int length );
+
+/*
+==============================================================
+
+FRAME TIMING
+
+==============================================================
+*/
+
+typedef enum {
+	PERF_FRAME,				// Com_Frame, without the wait for the next frame
+	PERF_EVENTS,			// Com_EventLoop calls that had something to do
+	PERF_EVENT_LATENCY,		// from a system event's arrival to its dispatch
+	PERF_SV_FRAME,
+	PERF_GAME_FRAME,		// VM_Call( gvm, GAME_RUN_FRAME )
+	PERF_SNAPSHOTS,			// SV_SendClientMessages
+	PERF_RENDER_FRONT,		// renderer front end, only msec resolution
+	PERF_RENDER_BACK,
+	PERF_TRACE_AT_TIME,		// one lag compensated game trace
+	PERF_NUM_SCOPES
+} perfScope_t;
+
+typedef unsigned long long perfTime_t;
+
+typedef struct {
+	unsigned			count;
+	unsigned long long	total;
+	unsigned			p50, p90, p99, max;
+} perfSummary_t;
+
+void		Perf_Init( void );
+void		Perf_Frame( void );
+perfTime_t	Perf_Begin( void );
+void		Perf_End( perfScope_t scope, perfTime_t start );
+void		Perf_Record( perfScope_t scope, unsigned usec );
+void		Perf_Summary( perfScope_t scope, perfSummary_t *out );
+const char	*Perf_ScopeName( perfScope_t scope );
 
 /* This is based on the Adaptive Huffman algorithm described in Sayood's Data
  * Compression book.  The ranks are not actually stored, but implicitly defined
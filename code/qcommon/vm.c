@@ -458,6 +458,10 @@ void VM_Free( vm_t *vm ) {
 
 void VM_Clear(void) {
         int i;
+        // tables the modules registered live in their memory
+        for (i=0;i<CVAR_GEN_MAX; i++) {
+                Cvar_SetGenerations(i, NULL, 0);
+        }
         for (i=0;i<MAX_VM; i++) {
                 VM_Free(&vmTable[i]);
         }
@@ -218,4 +218,15 @@ static void *VM_ArgPtr( intptr_t intValue ) {
 		}
 }
 
+// clamps count elements of size bytes at intValue to what fits in the vm's data
+static ID_INLINE int VM_ArgCount( vm_t *vm, intptr_t intValue, int count, int size ) {
+		int		space;
+
+		if ( !intValue || vm->entryPoint ) {
+				return count;
+		}
+		space = ( vm->dataMask + 1 - ( intValue & vm->dataMask ) ) / size;
+		return count < space ? count : space;
+}
+
 
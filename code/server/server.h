@@ -183,6 +183,9 @@ typedef struct client_s {
 	// buffer them into this queue, and hand them out to netchan as needed
 	netchan_buffer_t *netchan_start_queue;
 	netchan_buffer_t **netchan_end_queue;
+	// token bucket that fragments are paced out of, see SV_PaceClient
+	int		pace_tokens;	// bytes that may go out now, negative while in debt
+	unsigned long long	pace_time;	// Sys_Microseconds of the last refill
 
 	qboolean	demo_recording;	// are we currently recording this client?
 	fileHandle_t	demo_file;	// the file we are writing the demo to
@@ -190,6 +193,20 @@ typedef struct client_s {
 	int		demo_backoff;	// how many packets (-1 actually) between non-delta frames?
 	int		demo_deltas;	// how many delta frames did we let through so far?
 
+	// compressed demo container, see DEMOZ_MAGIC
+	qboolean	demo_compressed;	// are we writing blocks instead of a raw stream?
+	qboolean	demo_keyframe;	// was the last snapshot written a non-delta one?
+	byte		*demo_block;	// records of the block being built
+	int		demo_blockSize;
+	int		demo_maxBlockSize;	// allocated, grows up to DEMOZ_MAX_BLOCK
+	int		demo_blockTime;	// sv.time of the keyframe starting the block
+	int		demo_blockGamestate;	// size of the gamestate record at the block start
+	demozIndex_t	*demo_index;
+	int		demo_numBlocks;
+	int		demo_maxBlocks;
+	int		demo_rawBytes;	// totals for the compression report
+	int		demo_packedBytes;
+
 
 #ifdef USE_VOIP
 	qboolean hasVoip;
@@ -338,6 +355,13 @@ extern	cvar_t	*sv_pure;
 extern	cvar_t	*sv_newpurelist;
 extern	cvar_t	*sv_floodProtect;
 extern	cvar_t	*sv_lanForceRate;
+extern	cvar_t	*sv_pacing;
+extern	cvar_t	*sv_batchPmove;
+extern	cvar_t	*sv_pmoveChecksum;
+extern	cvar_t	*sv_eventStream;
+extern	cvar_t	*sv_eventStreamPath;
+extern	cvar_t	*sv_metrics;
+extern	cvar_t	*sv_metricsAddress;
 extern	cvar_t	*sv_strictAuth;
 extern	cvar_t	*sv_banFile;
 
@@ -353,6 +377,8 @@ extern	cvar_t	*sv_demonotice;
 extern  cvar_t  *sv_sayprefix;
 extern  cvar_t  *sv_tellprefix;
 extern  cvar_t  *sv_demofolder;
+extern  cvar_t  *sv_democompress;
+extern  cvar_t  *sv_demokeyframe;
 
 #ifdef USE_AUTH
 extern	cvar_t	*sv_authServerIP;
@@ -416,6 +442,8 @@ void SV_Auth_DropClient( client_t *drop, const char *reason, const char *message
 
 void SV_ExecuteClientCommand( client_t *cl, const char *s, qboolean clientOK );
 void SV_ClientThink (client_t *cl, usercmd_t *cmd);
+void SV_FlushUsercmds( void );
+void SV_ClearUsercmds( void );
 
 void SV_WriteDownloadToClient( client_t *cl , msg_t *msg );
 
@@ -428,7 +456,7 @@ void SV_WriteVoipToClient( client_t *cl, msg_t *msg );
 // sv_ccmds.c
 //
 void SV_Heartbeat_f( void );
-void SVD_WriteDemoFile(const client_t*, const msg_t*);
+void SVD_WriteDemoFile(client_t*, const msg_t*);
 
 //
 // sv_snapshot.c
@@ -439,6 +467,9 @@ void SV_WriteFrameToClient (client_t *client, msg_t *msg);
 void SV_SendMessageToClient( msg_t *msg, client_t *client );
 void SV_SendClientMessages( void );
 void SV_SendClientSnapshot( client_t *client );
+int SV_PaceClients( int sleepMsec );
+int SV_PaceDelay( const client_t *client );
+void SV_PaceCharge( client_t *client, int packetSize );
 void SV_CheckClientUserinfoTimer( void );
 void SV_UpdateUserinfo_f( client_t *cl );
 
@@ -450,6 +481,7 @@ sharedEntity_t *SV_GentityNum( int num );
 playerState_t *SV_GameClientNum( int num );
 svEntity_t	*SV_SvEntityForGentity( sharedEntity_t *gEnt );
 sharedEntity_t *SV_GEntityForSvEntity( svEntity_t *svEnt );
+intptr_t	QDECL SV_GameCall( int callnum, ... );
 void		SV_InitGameProgs ( void );
 void		SV_ShutdownGameProgs ( void );
 void		SV_RestartGameProgs( void );
@@ -527,10 +559,46 @@ void SV_Trace( trace_t *results, const vec3_t start, vec3_t mins, vec3_t maxs, c
 void SV_ClipToEntity( trace_t *trace, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int entityNum, int contentmask, int capsule );
 // clip to a specific entity
 
+void SV_TraceAtTime( trace_t *results, const vec3_t start, vec3_t mins, vec3_t maxs, const vec3_t end, int passEntityNum, int contentmask, int time );
+// like SV_Trace, but clients are clipped where they were at time, within the last
+// MAX_HISTORY_FRAMES game frames
+
+void SV_RecordHistory( void );
+void SV_ClearHistory( void );
+
+//
+// sv_events.c
+//
+void SV_GameEvent( int type, const int *args, int numArgs, const char *text );
+void SV_EventsClose( void );
+
+//
+// sv_metrics.c
+//
+typedef struct {
+	unsigned long long	frames;
+	unsigned long long	packetsReceived;		// SV_PacketEvent
+	unsigned long long	bytesReceived;
+	unsigned long long	connectionless;
+	unsigned long long	messagesSent;			// SV_SendMessageToClient
+	unsigned long long	messageBytesSent;
+	unsigned long long	serverCommands;			// SV_AddServerCommand
+	unsigned long long	serverCommandBytes;
+	unsigned long long	downloadBytes;
+	unsigned long long	rateLimited;			// SVC_RateLimit refusals
+	unsigned long long	scrapes;
+} svMetrics_t;
+
+extern	svMetrics_t	svMetrics;
+
+void SV_MetricsFrame( void );
+void SV_MetricsClose( void );
+
 //
 // sv_net_chan.c
 //
 void SV_Netchan_Transmit( client_t *client, msg_t *msg);
 void SV_Netchan_TransmitNextFragment( client_t *client );
+int SV_Netchan_QueuedBytes( const client_t *client );
 qboolean SV_Netchan_Process( client_t *client, msg_t *msg );
 
@@ -433,7 +433,7 @@ void SV_BotFrame( int time ) {
 	if (!bot_enable) return;
 	//NOTE: maybe the game is already shutdown
 	if (!gvm) return;
-	VM_Call( gvm, BOTAI_START_FRAME, time );
+	SV_GameCall( BOTAI_START_FRAME, time );
 }
 
 /*
@@ -492,6 +492,7 @@ void SV_BotInitCvars(void) {
 	Cvar_Get("bot_saveroutingcache", "0", 0);			//save routing cache
 	Cvar_Get("bot_thinktime", "100", CVAR_CHEAT);		//msec the bots thinks
 	Cvar_Get("bot_reloadcharacters", "0", 0);			//reload the bot characters each time
+	Cvar_Get("bot_scriptcache", "1", 0);				//cache parsed bot chat and item files
 	Cvar_Get("bot_testichat", "0", 0);					//test ichats
 	Cvar_Get("bot_testrchat", "0", 0);					//test rchats
 	Cvar_Get("bot_testsolid", "0", CVAR_CHEAT);			//test for solid areas
@@ -530,6 +531,7 @@ void SV_BotInitBotLib(void) {
 	botlib_import.BSPEntityData = BotImport_BSPEntityData;
 	botlib_import.BSPModelMinsMaxsOrigin = BotImport_BSPModelMinsMaxsOrigin;
 	botlib_import.BotClientCommand = BotClientCommand;
+	botlib_import.MilliSeconds = Sys_Milliseconds;
 
 	//memory management
 	botlib_import.GetMemory = BotImport_GetMemory;
@@ -543,6 +545,15 @@ void SV_BotInitBotLib(void) {
 	botlib_import.FS_Write = FS_Write;
 	botlib_import.FS_FCloseFile = FS_FCloseFile;
 	botlib_import.FS_Seek = FS_Seek;
+	botlib_import.FS_MapShared = FS_MapShared;
+	botlib_import.FS_UnmapShared = FS_UnmapShared;
+
+	botlib_import.CreateThread = Sys_CreateThread;
+	botlib_import.JoinThread = Sys_JoinThread;
+	botlib_import.CreateSemaphore = Sys_CreateSemaphore;
+	botlib_import.DestroySemaphore = Sys_DestroySemaphore;
+	botlib_import.SemaphorePost = Sys_SemaphorePost;
+	botlib_import.SemaphoreWait = Sys_SemaphoreWait;
 
 	//debug lines
 	botlib_import.DebugLineCreate = BotImport_DebugLineCreate;
@@ -23,6 +23,14 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include "server.h"
 extern cvar_t *com_newdemoformat;
 
+#ifdef USE_DEMO_DEFLATE
+#ifdef USE_LOCAL_HEADERS
+  #include "../zlib/zlib.h"
+#else
+  #include <zlib.h>
+#endif
+#endif
+
 /*
 ===============================================================================
 
@@ -451,7 +459,7 @@ static void SV_MapRestart_f( void ) {
     // run a few frames to allow everything to settle
     for (i = 0; i < 3; i++)
     {
-        VM_Call (gvm, GAME_RUN_FRAME, sv.time);
+        SV_GameCall (GAME_RUN_FRAME, sv.time);
         sv.time += 100;
         svs.time += 100;
     }
@@ -478,7 +486,7 @@ static void SV_MapRestart_f( void ) {
         SV_AddServerCommand( client, "map_restart\n" );
 
         // connect the client again, without the firstTime flag
-        denied = VM_ExplicitArgPtr( gvm, VM_Call( gvm, GAME_CLIENT_CONNECT, i, qfalse, isBot ) );
+        denied = VM_ExplicitArgPtr( gvm, SV_GameCall( GAME_CLIENT_CONNECT, i, qfalse, isBot ) );
         if ( denied ) {
             // this generally shouldn't happen, because the client
             // was connected before the level change
@@ -499,7 +507,7 @@ static void SV_MapRestart_f( void ) {
     }
 
     // run another frame to allow things to look at all the players
-    VM_Call (gvm, GAME_RUN_FRAME, sv.time);
+    SV_GameCall (GAME_RUN_FRAME, sv.time);
     sv.time += 100;
     svs.time += 100;
 }
@@ -1235,8 +1243,8 @@ static void SV_Status_f( void ) {
 
     Com_Printf ("map: %s\n", sv_mapname->string );
 
-    Com_Printf ("num score ping name            lastmsg address               qport rate\n");
-    Com_Printf ("--- ----- ---- --------------- ------- --------------------- ----- -----\n");
+    Com_Printf ("num score ping name            lastmsg address               qport rate  queue pace\n");
+    Com_Printf ("--- ----- ---- --------------- ------- --------------------- ----- ----- ----- ----\n");
     for (i=0,cl=svs.clients ; i < sv_maxclients->integer ; i++,cl++)
     {
         if (!cl->state)
@@ -1275,6 +1283,8 @@ static void SV_Status_f( void ) {
 
         Com_Printf (" %5i", cl->rate);
 
+        Com_Printf (" %5i %4i", SV_Netchan_QueuedBytes( cl ), SV_PaceDelay( cl ));
+
         Com_Printf ("\n");
     }
     Com_Printf ("\n");
@@ -1434,6 +1444,172 @@ static void SV_KillServer_f( void ) {
 
 //===========================================================
 
+/*
+Write the gamestate the way SV_SendClientGameState does, as the
+first record of a demo or of a seekable block.
+*/
+static void SVD_WriteGamestate(client_t *client, msg_t *msg)
+{
+    int     i;
+    entityState_t   *base, nullstate;
+
+    MSG_Bitstream(msg); // XXX server code doesn't do this, client code does
+
+    MSG_WriteLong(msg, client->lastClientCommand); // TODO: or is it client->reliableSequence?
+
+    MSG_WriteByte(msg, svc_gamestate);
+    MSG_WriteLong(msg, client->reliableSequence);
+
+    for (i = 0; i < MAX_CONFIGSTRINGS; i++) {
+        if (sv.configstrings[i][0]) {
+            MSG_WriteByte(msg, svc_configstring);
+            MSG_WriteShort(msg, i);
+            MSG_WriteBigString(msg, sv.configstrings[i]);
+        }
+    }
+
+    Com_Memset(&nullstate, 0, sizeof(nullstate));
+    for (i = 0 ; i < MAX_GENTITIES; i++) {
+        base = &sv.svEntities[i].baseline;
+        if (!base->number) {
+            continue;
+        }
+        MSG_WriteByte(msg, svc_baseline);
+        MSG_WriteDeltaEntity(msg, &nullstate, base, qtrue);
+    }
+
+    MSG_WriteByte(msg, svc_EOF);
+
+    MSG_WriteLong(msg, client - svs.clients);
+    MSG_WriteLong(msg, sv.checksumFeed);
+
+    MSG_WriteByte(msg, svc_EOF); // XXX server code doesn't do this, SV_Netchan_Transmit adds it!
+}
+
+/*
+Compress the block being built and append it to a seekable demo,
+remembering where it went for the trailing index.
+*/
+static void SVD_FlushBlock(client_t *client)
+{
+    int     header[4];
+    byte    *data;
+    int     size;
+#ifdef USE_DEMO_DEFLATE
+    byte    *packed = NULL;
+    uLongf  packedSize;
+#endif
+    demozIndex_t    *index;
+
+    if (!client->demo_blockSize) {
+        return;
+    }
+
+    data = client->demo_block;
+    size = client->demo_blockSize;
+
+#ifdef USE_DEMO_DEFLATE
+    packedSize = compressBound(size);
+    packed = Z_Malloc(packedSize);
+    if (compress2(packed, &packedSize, data, size, sv_democompress->integer) == Z_OK
+        && packedSize < size) {
+        data = packed;
+        size = packedSize;
+    }
+#endif
+
+    if (client->demo_numBlocks == client->demo_maxBlocks) {
+        client->demo_maxBlocks = client->demo_maxBlocks ? client->demo_maxBlocks * 2 : 64;
+        index = Z_Malloc(client->demo_maxBlocks * sizeof(demozIndex_t));
+        if (client->demo_index) {
+            Com_Memcpy(index, client->demo_index, client->demo_numBlocks * sizeof(demozIndex_t));
+            Z_Free(client->demo_index);
+        }
+        client->demo_index = index;
+    }
+    index = &client->demo_index[client->demo_numBlocks++];
+    index->offset = FS_FTell(client->demo_file);
+    index->serverTime = client->demo_blockTime;
+    index->gamestateSize = client->demo_blockGamestate;
+
+    header[0] = LittleLong(client->demo_blockSize);
+    header[1] = LittleLong(size);
+    header[2] = LittleLong(client->demo_blockTime);
+    header[3] = LittleLong(client->demo_blockGamestate);
+    FS_Write(header, sizeof(header), client->demo_file);
+    FS_Write(data, size, client->demo_file);
+    FS_Flush(client->demo_file);
+
+    client->demo_rawBytes += client->demo_blockSize;
+    client->demo_packedBytes += size + sizeof(header);
+
+#ifdef USE_DEMO_DEFLATE
+    Z_Free(packed);
+#endif
+
+    // anything that still goes into this block only continues the previous one
+    client->demo_blockSize = 0;
+    client->demo_blockTime = sv.time;
+    client->demo_blockGamestate = 0;
+}
+
+/*
+Append a <sequence><length><message> record to the block being built.
+*/
+static void SVD_AppendRecord(client_t *client, int sequence, const msg_t *msg)
+{
+    int len, size;
+    byte *block;
+
+    if (client->demo_blockSize + 8 + msg->cursize > DEMOZ_MAX_BLOCK) {
+        SVD_FlushBlock(client);
+        // get a keyframe in soon so the next block is seekable again
+        client->demo_deltas = 0;
+    }
+
+    // most blocks stay far below the limit, so grow the buffer as needed
+    if (client->demo_blockSize + 8 + msg->cursize > client->demo_maxBlockSize) {
+        size = client->demo_maxBlockSize ? client->demo_maxBlockSize * 2 : MAX_MSGLEN;
+        while (size < client->demo_blockSize + 8 + msg->cursize) {
+            size *= 2;
+        }
+        size = MIN(size, DEMOZ_MAX_BLOCK);
+        block = Z_Malloc(size);
+        if (client->demo_block) {
+            Com_Memcpy(block, client->demo_block, client->demo_blockSize);
+            Z_Free(client->demo_block);
+        }
+        client->demo_block = block;
+        client->demo_maxBlockSize = size;
+    }
+
+    len = LittleLong(sequence);
+    Com_Memcpy(client->demo_block + client->demo_blockSize, &len, 4);
+    len = LittleLong(msg->cursize);
+    Com_Memcpy(client->demo_block + client->demo_blockSize + 4, &len, 4);
+    Com_Memcpy(client->demo_block + client->demo_blockSize + 8, msg->data, msg->cursize);
+    client->demo_blockSize += 8 + msg->cursize;
+}
+
+/*
+Close the current block and start a seekable one with the gamestate
+as it is right now; the non-delta snapshot follows.
+*/
+static void SVD_BeginKeyframe(client_t *client)
+{
+    msg_t       msg;
+    byte        buffer[MAX_MSGLEN];
+
+    SVD_FlushBlock(client);
+
+    MSG_Init(&msg, buffer, sizeof(buffer));
+    SVD_WriteGamestate(client, &msg);
+
+    client->demo_blockTime = sv.time;
+    SVD_AppendRecord(client, client->netchan.outgoingSequence - 1, &msg);
+    client->demo_blockGamestate = client->demo_blockSize;
+}
+
 /*
 Start a server-side demo.
 
@@ -1445,8 +1621,7 @@ and cl_main.c/CL_Record_f.
 */
 static void SVD_StartDemoFile(client_t *client, const char *path)
 {
-    int     i, len;
-    entityState_t   *base, nullstate;
+    int     len;
     msg_t       msg;
     byte        buffer[MAX_MSGLEN];
     fileHandle_t    file;
@@ -1460,6 +1635,49 @@ static void SVD_StartDemoFile(client_t *client, const char *path)
     file = FS_FOpenFileWrite(path);
     assert(file != 0);
 
+    client->demo_compressed = sv_democompress->integer > 0;
+
+    if (client->demo_compressed) {
+        s = Cvar_VariableString("g_modversion");
+
+        v = LittleLong( DEMOZ_MAGIC );
+        FS_Write( &v, 4, file );
+        v = LittleLong( DEMOZ_VERSION );
+        FS_Write( &v, 4, file );
+        v = LittleLong( sv_demokeyframe->integer );
+        FS_Write( &v, 4, file );
+
+        size = strlen( s );
+        len = LittleLong( size );
+        FS_Write( &len, 4, file );
+        FS_Write( s, size, file );
+
+        v = LittleLong( DEMO_PROTOCOL_VERSION );
+        FS_Write( &v, 4, file );
+
+        FS_Flush(file);
+
+        // the gamestate goes into the first block once the first
+        // non-delta snapshot shows up
+        client->demo_block = NULL;
+        client->demo_blockSize = 0;
+        client->demo_maxBlockSize = 0;
+        client->demo_blockGamestate = 0;
+        client->demo_index = NULL;
+        client->demo_numBlocks = 0;
+        client->demo_maxBlocks = 0;
+        client->demo_rawBytes = 0;
+        client->demo_packedBytes = 0;
+
+        // adjust client_t to reflect demo started
+        client->demo_recording = qtrue;
+        client->demo_file = file;
+        client->demo_waiting = qtrue;
+        client->demo_backoff = sv_demokeyframe->integer / MAX(client->snapshotMsec, 1000 / sv_fps->integer);
+        client->demo_deltas = 0;
+        return;
+    }
+
     /* File_write_header_demo // ADD this fx */
     /* HOLBLIN  entete demo */
     if (com_newdemoformat->integer) {
@@ -1482,37 +1700,7 @@ static void SVD_StartDemoFile(client_t *client, const char *path)
     /* END HOLBLIN  entete demo */
 
     MSG_Init(&msg, buffer, sizeof(buffer));
-    MSG_Bitstream(&msg); // XXX server code doesn't do this, client code does
-
-    MSG_WriteLong(&msg, client->lastClientCommand); // TODO: or is it client->reliableSequence?
-
-    MSG_WriteByte(&msg, svc_gamestate);
-    MSG_WriteLong(&msg, client->reliableSequence);
-
-    for (i = 0; i < MAX_CONFIGSTRINGS; i++) {
-        if (sv.configstrings[i][0]) {
-            MSG_WriteByte(&msg, svc_configstring);
-            MSG_WriteShort(&msg, i);
-            MSG_WriteBigString(&msg, sv.configstrings[i]);
-        }
-    }
-
-    Com_Memset(&nullstate, 0, sizeof(nullstate));
-    for (i = 0 ; i < MAX_GENTITIES; i++) {
-        base = &sv.svEntities[i].baseline;
-        if (!base->number) {
-            continue;
-        }
-        MSG_WriteByte(&msg, svc_baseline);
-        MSG_WriteDeltaEntity(&msg, &nullstate, base, qtrue);
-    }
-
-    MSG_WriteByte(&msg, svc_EOF);
-
-    MSG_WriteLong(&msg, client - svs.clients);
-    MSG_WriteLong(&msg, sv.checksumFeed);
-
-    MSG_WriteByte(&msg, svc_EOF); // XXX server code doesn't do this, SV_Netchan_Transmit adds it!
+    SVD_WriteGamestate(client, &msg);
 
     len = LittleLong(client->netchan.outgoingSequence-1);
     FS_Write(&len, 4, file);
@@ -1539,7 +1727,7 @@ static void SVD_StartDemoFile(client_t *client, const char *path)
 /*
 Write a message to a server-side demo file.
 */
-void SVD_WriteDemoFile(const client_t *client, const msg_t *msg)
+void SVD_WriteDemoFile(client_t *client, const msg_t *msg)
 {
     int len;
     msg_t cmsg;
@@ -1560,6 +1748,18 @@ void SVD_WriteDemoFile(const client_t *client, const msg_t *msg)
     // here because we get the packet *before* the netchan has it's way
     // with it; just not sure that's really true :-/
 
+    if (client->demo_compressed) {
+        // a non-delta snapshot starts a new seekable block once the
+        // keyframe interval has passed
+        if (client->demo_keyframe && (!client->demo_numBlocks && !client->demo_blockSize
+            || sv.time - client->demo_blockTime >= sv_demokeyframe->integer
+            || !client->demo_blockGamestate)) {
+            SVD_BeginKeyframe(client);
+        }
+        SVD_AppendRecord(client, client->netchan.outgoingSequence, &cmsg);
+        return;
+    }
+
     len = LittleLong(client->netchan.outgoingSequence);
     FS_Write(&len, 4, file);
 
@@ -1576,6 +1776,51 @@ void SVD_WriteDemoFile(const client_t *client, const msg_t *msg)
     FS_Flush(file);
 }
 
+/*
+Finish a seekable demo: write out the last block and the index
+of all blocks so players can jump straight to a keyframe.
+*/
+static void SVD_FinishCompressed(client_t *client)
+{
+    int     i, v, trailer;
+    fileHandle_t file = client->demo_file;
+
+    SVD_FlushBlock(client);
+
+    trailer = FS_FTell(file);
+    v = LittleLong(client->demo_numBlocks);
+    FS_Write(&v, 4, file);
+    for (i = 0; i < client->demo_numBlocks; i++) {
+        v = LittleLong(client->demo_index[i].offset);
+        FS_Write(&v, 4, file);
+        v = LittleLong(client->demo_index[i].serverTime);
+        FS_Write(&v, 4, file);
+        v = LittleLong(client->demo_index[i].gamestateSize);
+        FS_Write(&v, 4, file);
+    }
+    v = LittleLong(trailer);
+    FS_Write(&v, 4, file);
+    v = LittleLong(DEMOZ_INDEX_MAGIC);
+    FS_Write(&v, 4, file);
+
+    Com_Printf("%s: %i blocks, %i bytes of messages stored in %i bytes (%.1f%%)\n",
+        client->name, client->demo_numBlocks, client->demo_rawBytes, client->demo_packedBytes,
+        client->demo_rawBytes ? 100.0f * client->demo_packedBytes / client->demo_rawBytes : 0.0f);
+
+    if (client->demo_block) {
+        Z_Free(client->demo_block);
+        client->demo_block = NULL;
+    }
+    client->demo_maxBlockSize = 0;
+    if (client->demo_index) {
+        Z_Free(client->demo_index);
+        client->demo_index = NULL;
+    }
+    client->demo_numBlocks = 0;
+    client->demo_maxBlocks = 0;
+    client->demo_compressed = qfalse;
+}
+
 /*
 Stop a server-side demo.
 
@@ -1591,8 +1836,12 @@ static void SVD_StopDemoFile(client_t *client)
     assert(client->demo_recording);
 
     // write the necessary trailer and close the demo file
-    FS_Write(&marker, 4, file);
-    FS_Write(&marker, 4, file);
+    if (client->demo_compressed) {
+        SVD_FinishCompressed(client);
+    } else {
+        FS_Write(&marker, 4, file);
+        FS_Write(&marker, 4, file);
+    }
     FS_Flush(file);
     FS_FCloseFile(file);
 
@@ -1640,6 +1889,7 @@ static void SV_NameServerDemo(char *filename, int length, const client_t *client
     qtime_t time;
     char playername[32];
     char demoName[64]; //@Barbatos
+    const char *ext = sv_democompress->integer > 0 ? DEMOZ_EXT : NEWDEMOEXT;
 
     Com_DPrintf("SV_NameServerDemo\n");
 
@@ -1650,10 +1900,10 @@ static void SV_NameServerDemo(char *filename, int length, const client_t *client
     if (fn != NULL) {
         Q_strncpyz(demoName, fn, sizeof(demoName));
 
-        if (com_newdemoformat->integer) {
-            Q_snprintf(filename, length-1, "%s/%s.urtdemo", sv_demofolder->string, demoName );
+        if (sv_democompress->integer > 0 || com_newdemoformat->integer) {
+            Q_snprintf(filename, length-1, "%s/%s.%s", sv_demofolder->string, demoName, ext );
             if (FS_FileExists(filename)) {
-                Q_snprintf(filename, length-1, "%s/%s_%d.urtdemo", sv_demofolder->string, demoName, Sys_Milliseconds() );
+                Q_snprintf(filename, length-1, "%s/%s_%d.%s", sv_demofolder->string, demoName, Sys_Milliseconds(), ext );
             }
         } else {
             Q_snprintf(filename, length-1, "%s/%s.dm_%d", sv_demofolder->string, demoName , PROTOCOL_VERSION );
@@ -1662,13 +1912,14 @@ static void SV_NameServerDemo(char *filename, int length, const client_t *client
             }
         }
     } else {
-        if (com_newdemoformat->integer) {
+        if (sv_democompress->integer > 0 || com_newdemoformat->integer) {
             Q_snprintf(
-                filename, length-1, "%s/%.4d-%.2d-%.2d_%.2d-%.2d-%.2d_%s_%d.urtdemo",
+                filename, length-1, "%s/%.4d-%.2d-%.2d_%.2d-%.2d-%.2d_%s_%d.%s",
                 sv_demofolder->string, time.tm_year+1900, time.tm_mon + 1, time.tm_mday,
                 time.tm_hour, time.tm_min, time.tm_sec,
                 playername,
-                Sys_Milliseconds()
+                Sys_Milliseconds(),
+                ext
             );
         } else {
             Q_snprintf(
@@ -1934,7 +2185,7 @@ static void SV_Auth_Whois_f( void ) {
                 if (cl->state != CS_ACTIVE)
                     continue;
 
-                VM_Call(gvm, GAME_AUTH_WHOIS, (int)(cl - svs.clients));
+                SV_GameCall(GAME_AUTH_WHOIS, (int)(cl - svs.clients));
             }
 
             return;
@@ -1949,7 +2200,7 @@ static void SV_Auth_Whois_f( void ) {
     if ( !cl )
         return;
 
-    VM_Call(gvm, GAME_AUTH_WHOIS, idnum);
+    SV_GameCall(GAME_AUTH_WHOIS, idnum);
 }
 
 /*
@@ -2008,7 +2259,7 @@ static void SV_Auth_Ban_f( void ) {
         return;
     }
 
-    VM_Call(gvm, GAME_AUTH_BAN, idnum, atoi(days), atoi(hours), atoi(mins));
+    SV_GameCall(GAME_AUTH_BAN, idnum, atoi(days), atoi(hours), atoi(mins));
 }
 
 #endif
@@ -456,7 +456,7 @@ void SV_DirectConnect( netadr_t from ) {
 
 //			// disconnect the client from the game first so any flags the
 //			// player might have are dropped
-//			VM_Call( gvm, GAME_CLIENT_DISCONNECT, newcl - svs.clients );
+//			SV_GameCall( GAME_CLIENT_DISCONNECT, newcl - svs.clients );
 			//
 			goto gotnewcl;
 		}
@@ -553,7 +553,7 @@ gotnewcl:
 	Q_strncpyz( newcl->userinfo, userinfo, sizeof(newcl->userinfo) );
 
 	// get the game a chance to reject this connection or modify the userinfo
-	denied = VM_Call( gvm, GAME_CLIENT_CONNECT, clientNum, qtrue, qfalse ); // firstTime = qtrue
+	denied = SV_GameCall( GAME_CLIENT_CONNECT, clientNum, qtrue, qfalse ); // firstTime = qtrue
 	if ( denied ) {
 		// we can't just use VM_ArgPtr, because that is only valid inside a VM_Call
 		char *str = VM_ExplicitArgPtr( gvm, denied );
@@ -615,6 +615,8 @@ void SV_DropClient( client_t *drop, const char *reason ) {
 		return;		// already dropped
 	}
 
+	SV_FlushUsercmds();
+
 	if ( !isBot ) {
 		// see if we already have a challenge for this ip
 		challenge = &svs.challenges[0];
@@ -647,7 +649,7 @@ void SV_DropClient( client_t *drop, const char *reason ) {
 
 	// call the prog function for removing a client
 	// this will remove the body, among other things
-	VM_Call( gvm, GAME_CLIENT_DISCONNECT, drop - svs.clients );
+	SV_GameCall( GAME_CLIENT_DISCONNECT, drop - svs.clients );
 
 	// add the disconnect command
 	SV_SendServerCommand( drop, "disconnect \"%s\"", reason);
@@ -729,7 +731,7 @@ void SV_Auth_DropClient( client_t *drop, const char *reason, const char *message
 
 	// call the prog function for removing a client
 	// this will remove the body, among other things
-	VM_Call( gvm, GAME_CLIENT_DISCONNECT, drop - svs.clients );
+	SV_GameCall( GAME_CLIENT_DISCONNECT, drop - svs.clients );
 
 	// add the disconnect command
 	SV_SendServerCommand( drop, "disconnect \"%s\"", message);
@@ -786,7 +788,11 @@ static void SV_SendClientGameState( client_t *client ) {
 	// gamestate message was not just sent, forcing a retransmit
 	client->gamestateMessageNum = client->netchan.outgoingSequence;
 
-	MSG_Init( &msg, msgBuffer, sizeof( msgBuffer ) );
+	if ( Netchan_Arena( &client->netchan ) ) {
+		MSG_Init( &msg, Netchan_Arena( &client->netchan ), MAX_MSGLEN );
+	} else {
+		MSG_Init( &msg, msgBuffer, sizeof( msgBuffer ) );
+	}
 
 	// NOTE, MRE: all server->client messages now acknowledge
 	// let the client know which reliable clientCommands we have received
@@ -861,7 +867,7 @@ void SV_ClientEnterWorld( client_t *client, usercmd_t *cmd ) {
 	client->lastUsercmd = *cmd;
 
 	// call the game begin function
-	VM_Call( gvm, GAME_CLIENT_BEGIN, client - svs.clients );
+	SV_GameCall( GAME_CLIENT_BEGIN, client - svs.clients );
 }
 
 /*
@@ -1196,6 +1202,7 @@ void SV_WriteDownloadToClient( client_t *cl , msg_t *msg )
 		// Write the block
 		if ( cl->downloadBlockSize[curindex] ) {
 			MSG_WriteData( msg, cl->downloadBlocks[curindex], cl->downloadBlockSize[curindex] );
+			svMetrics.downloadBytes += cl->downloadBlockSize[curindex];
 		}
 
 		Com_DPrintf( "clientDownload: %d : writing block %d\n", (int) (cl - svs.clients), cl->downloadXmitBlock );
@@ -1555,7 +1562,7 @@ void SV_UpdateUserinfo_f( client_t *cl ) {
 
 	SV_UserinfoChanged( cl );
 	// call prog code to allow overrides
-	VM_Call( gvm, GAME_CLIENT_USERINFO_CHANGED, cl - svs.clients );
+	SV_GameCall( GAME_CLIENT_USERINFO_CHANGED, cl - svs.clients );
 }
 
 
@@ -1700,7 +1707,7 @@ void SV_ExecuteClientCommand( client_t *cl, const char *s, qboolean clientOK ) {
 				return;
 			}
 
-			VM_Call( gvm, GAME_CLIENT_COMMAND, cl - svs.clients );
+			SV_GameCall( GAME_CLIENT_COMMAND, cl - svs.clients );
 		}
 	}
 	else if (!bProcessed)
@@ -1766,6 +1773,87 @@ static qboolean SV_ClientCommand( client_t *cl, msg_t *msg ) {
 //==================================================================================
 
 
+/*
+
+With sv_batchPmove set the usercmds of every client are queued as the
+packets are parsed and run through the game back to back before the
+next game frame, so the pmoves and their traces run together instead
+of between message parsing of different clients.  The queue keeps the
+arrival order and is flushed before anything else reaches the game
+(client commands, entering the world, drops, and every other call that
+goes through SV_GameCall), so the game sees the same sequence of calls
+as without it.
+
+*/
+
+#define MAX_QUEUED_USERCMDS		( MAX_CLIENTS * MAX_PACKET_USERCMDS * 2 )
+
+typedef struct {
+	int			clientNum;
+	usercmd_t	cmd;
+} queuedUsercmd_t;
+
+static queuedUsercmd_t	queuedUsercmds[MAX_QUEUED_USERCMDS];
+static int				numQueuedUsercmds;
+static int				queuedUsercmdTime[MAX_CLIENTS];		// serverTime of the last queued cmd, 0 if none
+static qboolean			flushingUsercmds;
+
+/*
+==================
+SV_FlushUsercmds
+
+Runs the queued usercmds in the order they arrived
+==================
+*/
+void SV_FlushUsercmds( void ) {
+	queuedUsercmd_t	*q;
+	int		i;
+
+	if ( flushingUsercmds || !numQueuedUsercmds ) {
+		return;		// a drop from inside a ClientThink
+	}
+
+	flushingUsercmds = qtrue;
+	for ( i = 0 ; i < numQueuedUsercmds ; i++ ) {
+		q = &queuedUsercmds[i];
+		queuedUsercmdTime[q->clientNum] = 0;
+		SV_ClientThink( &svs.clients[q->clientNum], &q->cmd );
+	}
+	numQueuedUsercmds = 0;
+	flushingUsercmds = qfalse;
+}
+
+/*
+==================
+SV_ClearUsercmds
+
+Throws the queue away, after an error dropped out of a flush
+==================
+*/
+void SV_ClearUsercmds( void ) {
+	numQueuedUsercmds = 0;
+	Com_Memset( queuedUsercmdTime, 0, sizeof( queuedUsercmdTime ) );
+	flushingUsercmds = qfalse;
+}
+
+/*
+==================
+SV_QueueUsercmd
+==================
+*/
+static void SV_QueueUsercmd( client_t *cl, usercmd_t *cmd ) {
+	queuedUsercmd_t	*q;
+
+	if ( numQueuedUsercmds == MAX_QUEUED_USERCMDS ) {
+		SV_FlushUsercmds();
+	}
+
+	q = &queuedUsercmds[numQueuedUsercmds++];
+	q->clientNum = cl - svs.clients;
+	q->cmd = *cmd;
+	queuedUsercmdTime[q->clientNum] = cmd->serverTime;
+}
+
 /*
 ==================
 SV_ClientThink
@@ -1780,7 +1868,7 @@ void SV_ClientThink (client_t *cl, usercmd_t *cmd) {
 		return;		// may have been kicked during the last usercmd
 	}
 
-	VM_Call( gvm, GAME_CLIENT_THINK, cl - svs.clients );
+	SV_GameCall( GAME_CLIENT_THINK, cl - svs.clients );
 }
 
 /*
@@ -1855,6 +1943,7 @@ static void SV_UserMove( client_t *cl, msg_t *msg, qboolean delta ) {
 	// if this is the first usercmd we have received
 	// this gamestate, put the client into the world
 	if ( cl->state == CS_PRIMED ) {
+		SV_FlushUsercmds();
 		SV_ClientEnterWorld( cl, &cmds[0] );
 		// the moves can be processed normaly
 	}
@@ -1887,7 +1976,14 @@ static void SV_UserMove( client_t *cl, msg_t *msg, qboolean delta ) {
 		if ( cmds[i].serverTime <= cl->lastUsercmd.serverTime ) {
 			continue;
 		}
-		SV_ClientThink (cl, &cmds[ i ]);
+		if ( cmds[i].serverTime <= queuedUsercmdTime[cl - svs.clients] ) {
+			continue;
+		}
+		if ( sv_batchPmove->integer ) {
+			SV_QueueUsercmd( cl, &cmds[i] );
+		} else {
+			SV_ClientThink (cl, &cmds[ i ]);
+		}
 	}
 }
 
@@ -2108,6 +2204,7 @@ void SV_ExecuteClientMessage( client_t *cl, msg_t *msg ) {
 		if ( c != clc_clientCommand ) {
 			break;
 		}
+		SV_FlushUsercmds();
 		if ( !SV_ClientCommand( cl, msg ) ) {
 			return;	// we couldn't execute it because of the flood protection
 		}
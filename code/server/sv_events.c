@@ -0,0 +1,291 @@
+/*
+===========================================================================
+Copyright (C) 1999-2005 Id Software, Inc.
+
+This file is part of Quake III Arena source code.
+
+Quake III Arena source code is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the License,
+or (at your option) any later version.
+
+Quake III Arena source code is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Quake III Arena source code; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+===========================================================================
+*/
+// sv_events.c -- structured game event stream
+
+#include "server.h"
+
+#ifndef _WIN32
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+/*
+
+The game reports kills, hits, pickups, flag and round changes through
+trap_LogEvent next to its games.log lines.  With sv_eventStream set they
+go out as records to sv_eventStreamPath, a file under the game directory
+or, with a "unix:" prefix, a datagram UNIX domain socket.
+
+sv_eventStream 1, binary records, little endian:
+	short	length			// of the rest of the record
+	byte	type			// gameEvent_t
+	byte	numArgs
+	int		serverTime
+	int		args[numArgs]
+	char	text[]			// up to the end of the record, no terminator
+
+sv_eventStream 2, one JSON object per line:
+	{"time":12345,"event":"kill","attacker":2,"target":5,"mod":12,"text":"MOD_RAILGUN"}
+
+Files are written by the async log thread, sockets are sent to without
+blocking, a full socket buffer drops the record.
+
+*/
+
+#define EVENT_MAX_RECORD	1024
+
+static const char *eventNames[GEV_NUM_EVENTS] = {
+	"kill",
+	"hit",
+	"item",
+	"flag",
+	"round"
+};
+
+static const char *eventArgNames[GEV_NUM_EVENTS][GEV_MAX_ARGS] = {
+	{ "attacker", "target", "mod" },
+	{ "attacker", "target", "damage", "mod" },
+	{ "client", "item" },
+	{ "client", "team", "action" },
+	{ "state" }
+};
+
+static struct {
+	int				mode;				// sv_eventStream when opened
+	fileHandle_t	file;
+	int				socket;
+
+	int				events;
+	int				bytes;
+	int				dropped;
+} evs = { 0, 0, -1 };
+
+/*
+================
+SV_EventsOpen
+================
+*/
+static void SV_EventsOpen( void ) {
+	const char	*path;
+
+	evs.mode = sv_eventStream->integer;
+	if ( !evs.mode ) {
+		return;
+	}
+
+	path = sv_eventStreamPath->string;
+	if ( !Q_stricmpn( path, "unix:", 5 ) ) {
+#ifdef _WIN32
+		Com_Printf( "sv_eventStreamPath: UNIX domain sockets are not supported on this platform\n" );
+#else
+		struct sockaddr_un	addr;
+
+		Com_Memset( &addr, 0, sizeof( addr ) );
+		addr.sun_family = AF_UNIX;
+		Q_strncpyz( addr.sun_path, path + 5, sizeof( addr.sun_path ) );
+
+		evs.socket = socket( AF_UNIX, SOCK_DGRAM, 0 );
+		if ( evs.socket == -1 ) {
+			Com_Printf( "WARNING: event stream socket: %s\n", strerror( errno ) );
+			return;
+		}
+		if ( connect( evs.socket, (struct sockaddr *)&addr, sizeof( addr ) ) == -1 ) {
+			// nobody listening yet, try again on the next map
+			Com_Printf( "WARNING: event stream connect to %s: %s\n", addr.sun_path, strerror( errno ) );
+			close( evs.socket );
+			evs.socket = -1;
+			return;
+		}
+		Com_Printf( "Streaming game events to %s\n", addr.sun_path );
+#endif
+		return;
+	}
+
+	evs.file = FS_FOpenFileAppend( path );
+	if ( !evs.file ) {
+		Com_Printf( "WARNING: couldn't open event stream %s\n", path );
+		return;
+	}
+	AsyncLog_Open( evs.file, qfalse );
+	Com_Printf( "Streaming game events to %s\n", path );
+}
+
+/*
+================
+SV_EventsClose
+
+Called when the game is shut down, the next map reopens with
+whatever sv_eventStream says then
+================
+*/
+void SV_EventsClose( void ) {
+	if ( evs.file ) {
+		FS_FCloseFile( evs.file );
+		evs.file = 0;
+	}
+#ifndef _WIN32
+	if ( evs.socket != -1 ) {
+		close( evs.socket );
+		evs.socket = -1;
+	}
+#endif
+	if ( evs.events ) {
+		Com_DPrintf( "event stream: %i events, %i bytes, %i dropped\n", evs.events, evs.bytes, evs.dropped );
+	}
+	evs.mode = 0;
+	evs.events = evs.bytes = evs.dropped = 0;
+}
+
+/*
+================
+SV_EventEncodeBinary
+================
+*/
+static int SV_EventEncodeBinary( byte *buf, int type, const int *args, int numArgs, const char *text ) {
+	int		length, textLength, i;
+
+	textLength = text ? strlen( text ) : 0;
+	length = 2 + 1 + 1 + 4 + numArgs * 4;
+	if ( length + textLength > EVENT_MAX_RECORD ) {
+		textLength = EVENT_MAX_RECORD - length;
+	}
+
+	buf[2] = type;
+	buf[3] = numArgs;
+	*(int *)( buf + 4 ) = LittleLong( sv.time );
+	for ( i = 0; i < numArgs; i++ ) {
+		*(int *)( buf + 8 + i * 4 ) = LittleLong( args[i] );
+	}
+	Com_Memcpy( buf + length, text, textLength );
+	length += textLength;
+
+	*(short *)buf = LittleShort( length - 2 );
+	return length;
+}
+
+/*
+================
+SV_EventEncodeJSON
+================
+*/
+static int SV_EventEncodeJSON( byte *buf, int type, const int *args, int numArgs, const char *text ) {
+	char	*s, *end;
+	int		i, c;
+
+	s = (char *)buf;
+	end = s + EVENT_MAX_RECORD - 4;		// room for the closing "}\n
+
+	Com_sprintf( s, end - s, "{\"time\":%i,\"event\":\"%s\"", sv.time, eventNames[type] );
+	s += strlen( s );
+	for ( i = 0; i < numArgs; i++ ) {
+		if ( eventArgNames[type][i] ) {
+			Com_sprintf( s, end - s, ",\"%s\":%i", eventArgNames[type][i], args[i] );
+			s += strlen( s );
+		} else {
+			Com_sprintf( s, end - s, ",\"arg%i\":%i", i, args[i] );
+			s += strlen( s );
+		}
+	}
+
+	if ( text ) {
+		Com_sprintf( s, end - s, ",\"text\":\"" );
+		s += strlen( s );
+		// names and chat aren't UTF-8, so high bytes go out as Latin-1
+		for ( ; *text; text++ ) {
+			c = (unsigned char)*text;
+			if ( c == '"' || c == '\\' ) {
+				if ( s + 2 > end ) {
+					break;
+				}
+				*s++ = '\\';
+				*s++ = c;
+			} else if ( c >= 0x80 ) {
+				if ( s + 6 > end ) {
+					break;
+				}
+				Com_sprintf( s, 7, "\\u%04x", c );
+				s += 6;
+			} else if ( c >= ' ' ) {
+				if ( s + 1 > end ) {
+					break;
+				}
+				*s++ = c;
+			}
+		}
+		*s++ = '"';
+	}
+
+	*s++ = '}';
+	*s++ = '\n';
+	return s - (char *)buf;
+}
+
+/*
+================
+SV_GameEvent
+
+G_LOG_EVENT, called from the game's frame
+================
+*/
+void SV_GameEvent( int type, const int *args, int numArgs, const char *text ) {
+	byte	buf[EVENT_MAX_RECORD];
+	int		length;
+
+	if ( evs.mode != sv_eventStream->integer ) {
+		SV_EventsClose();
+		SV_EventsOpen();
+	}
+	if ( !evs.file && evs.socket == -1 ) {
+		return;
+	}
+
+	if ( type < 0 || type >= GEV_NUM_EVENTS ) {
+		return;
+	}
+	if ( numArgs < 0 ) {
+		numArgs = 0;
+	} else if ( numArgs > GEV_MAX_ARGS ) {
+		numArgs = GEV_MAX_ARGS;
+	}
+
+	if ( evs.mode == 1 ) {
+		length = SV_EventEncodeBinary( buf, type, args, numArgs, text );
+	} else {
+		length = SV_EventEncodeJSON( buf, type, args, numArgs, text );
+	}
+
+	evs.events++;
+	evs.bytes += length;
+
+	if ( evs.file ) {
+		AsyncLog_Write( evs.file, buf, length );
+		return;
+	}
+#ifndef _WIN32
+	if ( send( evs.socket, buf, length, MSG_DONTWAIT ) == -1 ) {
+		evs.dropped++;
+	}
+#endif
+}
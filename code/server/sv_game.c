@@ -328,6 +328,9 @@ intptr_t SV_GameSystemCalls( intptr_t *args ) {
 	case G_CVAR_UPDATE:
 		Cvar_Update( VMA(1) );
 		return 0;
+	case G_CVAR_GENERATIONS:
+		Cvar_SetGenerations( CVAR_GEN_GAME, VMA(1), VM_ArgCount( gvm, args[1], args[2], sizeof( int ) ) );
+		return 0;
 	case G_CVAR_SET:
 		Cvar_Set( (const char *)VMA(1), (const char *)VMA(2) );
 		return 0;
@@ -346,12 +349,21 @@ intptr_t SV_GameSystemCalls( intptr_t *args ) {
 		return 0;
 
 	case G_FS_FOPEN_FILE:
-		return FS_FOpenFileByMode( VMA(1), VMA(2), args[3] );
+		{
+			int		r;
+
+			r = FS_FOpenFileByMode( VMA(1), VMA(2), args[3] );
+			// append mode is what the game logs are opened with
+			if ( VMA(2) && ( args[3] == FS_APPEND || args[3] == FS_APPEND_SYNC ) ) {
+				AsyncLog_Open( *(fileHandle_t *)VMA(2), args[3] == FS_APPEND_SYNC );
+			}
+			return r;
+		}
 	case G_FS_READ:
 		FS_Read2( VMA(1), args[2], args[3] );
 		return 0;
 	case G_FS_WRITE:
-		FS_Write( VMA(1), args[2], args[3] );
+		AsyncLog_Write( args[3], VMA(1), args[2] );
 		return 0;
 	case G_FS_FCLOSE_FILE:
 		FS_FCloseFile( args[1] );
@@ -361,6 +373,19 @@ intptr_t SV_GameSystemCalls( intptr_t *args ) {
 	case G_FS_SEEK:
 		return FS_Seek( args[1], args[2], args[3] );
 
+	case G_LOG_EVENT:
+		{
+			int numArgs = args[3];
+
+			if ( !args[2] || numArgs < 0 ) {
+				numArgs = 0;
+			} else if ( numArgs > GEV_MAX_ARGS ) {
+				numArgs = GEV_MAX_ARGS;
+			}
+			SV_GameEvent( args[1], VMA(2), VM_ArgCount( gvm, args[2], numArgs, sizeof( int ) ), VMA(4) );
+		}
+		return 0;
+
 	case G_LOCATE_GAME_DATA:
 		SV_LocateGameData( VMA(1), args[2], args[3], VMA(4), args[5] );
 		return 0;
@@ -395,6 +420,9 @@ intptr_t SV_GameSystemCalls( intptr_t *args ) {
 	case G_TRACECAPSULE:
 		SV_Trace( VMA(1), VMA(2), VMA(3), VMA(4), VMA(5), args[6], args[7], /*int capsule*/ qtrue );
 		return 0;
+	case G_TRACE_AT_TIME:
+		SV_TraceAtTime( VMA(1), VMA(2), VMA(3), VMA(4), VMA(5), args[6], args[7], args[8] );
+		return 0;
 	case G_POINT_CONTENTS:
 		return SV_PointContents( VMA(1), args[2] );
 	case G_SET_BRUSH_MODEL:
@@ -894,6 +922,32 @@ intptr_t SV_GameSystemCalls( intptr_t *args ) {
 	return -1;
 }
 
+/*
+===============
+SV_GameCall
+
+Every call into the game goes through here, so the usercmds queued by
+sv_batchPmove always run before the game sees anything else.  The
+arguments are passed on the same way VM_Call reads them.
+===============
+*/
+intptr_t QDECL SV_GameCall( int callnum, ... ) {
+	int		args[10];
+	va_list	ap;
+	int		i;
+
+	SV_FlushUsercmds();
+
+	va_start( ap, callnum );
+	for ( i = 0 ; i < ARRAY_LEN( args ) ; i++ ) {
+		args[i] = va_arg( ap, int );
+	}
+	va_end( ap );
+
+	return VM_Call( gvm, callnum, args[0], args[1], args[2], args[3], args[4],
+		args[5], args[6], args[7], args[8], args[9] );
+}
+
 /*
 ===============
 SV_ShutdownGameProgs
@@ -905,9 +959,13 @@ void SV_ShutdownGameProgs( void ) {
 	if ( !gvm ) {
 		return;
 	}
-	VM_Call( gvm, GAME_SHUTDOWN, qfalse );
+	SV_FlushUsercmds();
+	SV_ClearUsercmds();
+	SV_GameCall( GAME_SHUTDOWN, qfalse );
+	Cvar_SetGenerations( CVAR_GEN_GAME, NULL, 0 );
 	VM_Free( gvm );
 	gvm = NULL;
+	SV_EventsClose();
 }
 
 /*
@@ -933,7 +991,7 @@ static void SV_InitGameVM( qboolean restart ) {
 
 	// use the current msec count for a random seed
 	// init for this gamestate
-	VM_Call (gvm, GAME_INIT, sv.time, Com_Milliseconds(), restart);
+	SV_GameCall (GAME_INIT, sv.time, Com_Milliseconds(), restart);
 }
 
 
@@ -949,7 +1007,10 @@ void SV_RestartGameProgs( void ) {
 	if ( !gvm ) {
 		return;
 	}
-	VM_Call( gvm, GAME_SHUTDOWN, qtrue );
+	SV_FlushUsercmds();
+	SV_ClearUsercmds();
+	SV_GameCall( GAME_SHUTDOWN, qtrue );
+	Cvar_SetGenerations( CVAR_GEN_GAME, NULL, 0 );
 
 	// do a restart instead of a free
 	gvm = VM_Restart( gvm );
@@ -1003,6 +1064,6 @@ qboolean SV_GameCommand( void ) {
 		return qfalse;
 	}
 
-	return VM_Call( gvm, GAME_CONSOLE_COMMAND );
+	return SV_GameCall( GAME_CONSOLE_COMMAND );
 }
 
@@ -712,7 +712,7 @@ void SV_SpawnServer( char *server, qboolean killBots ) {
     // run a few frames to allow everything to settle
     for (i = 0;i < 3; i++)
     {
-        VM_Call (gvm, GAME_RUN_FRAME, sv.time);
+        SV_GameCall (GAME_RUN_FRAME, sv.time);
         SV_BotFrame (sv.time);
         sv.time += 100;
         svs.time += 100;
@@ -741,7 +741,7 @@ void SV_SpawnServer( char *server, qboolean killBots ) {
             }
 
             // connect the client again
-            denied = VM_ExplicitArgPtr( gvm, VM_Call( gvm, GAME_CLIENT_CONNECT, i, qfalse, isBot ) );   // firstTime = qfalse
+            denied = VM_ExplicitArgPtr( gvm, SV_GameCall( GAME_CLIENT_CONNECT, i, qfalse, isBot ) );   // firstTime = qfalse
             if ( denied ) {
                 // this generally shouldn't happen, because the client
                 // was connected before the level change
@@ -765,14 +765,14 @@ void SV_SpawnServer( char *server, qboolean killBots ) {
                     client->deltaMessage = -1;
                     client->nextSnapshotTime = svs.time;    // generate a snapshot immediately
 
-                    VM_Call( gvm, GAME_CLIENT_BEGIN, i );
+                    SV_GameCall( GAME_CLIENT_BEGIN, i );
                 }
             }
         }
     }
 
     // run another frame to allow things to look at all the players
-    VM_Call (gvm, GAME_RUN_FRAME, sv.time);
+    SV_GameCall (GAME_RUN_FRAME, sv.time);
     SV_BotFrame (sv.time);
     sv.time += 100;
     svs.time += 100;
@@ -930,6 +930,13 @@ void SV_Init (void) {
     sv_killserver = Cvar_Get ("sv_killserver", "0", 0);
     sv_mapChecksum = Cvar_Get ("sv_mapChecksum", "", CVAR_ROM);
     sv_lanForceRate = Cvar_Get ("sv_lanForceRate", "1", CVAR_ARCHIVE );
+    sv_pacing = Cvar_Get ("sv_pacing", "1", CVAR_ARCHIVE );
+    sv_batchPmove = Cvar_Get ("sv_batchPmove", "0", CVAR_ARCHIVE );
+    sv_pmoveChecksum = Cvar_Get ("sv_pmoveChecksum", "0", CVAR_CHEAT );
+    sv_eventStream = Cvar_Get ("sv_eventStream", "0", CVAR_ARCHIVE );
+    sv_eventStreamPath = Cvar_Get ("sv_eventStreamPath", "events.log", CVAR_ARCHIVE );
+    sv_metrics = Cvar_Get ("sv_metrics", "0", CVAR_ARCHIVE );
+    sv_metricsAddress = Cvar_Get ("sv_metricsAddress", "127.0.0.1:27961", CVAR_ARCHIVE );
     sv_strictAuth = Cvar_Get ("sv_strictAuth", "1", CVAR_ARCHIVE );
     sv_banFile = Cvar_Get("sv_banFile", "serverbans.dat", CVAR_ARCHIVE);
     sv_demonotice = Cvar_Get ("sv_demonotice", "Smile! You're on camera!", CVAR_ARCHIVE);
@@ -937,6 +944,10 @@ void SV_Init (void) {
     sv_sayprefix = Cvar_Get ("sv_sayprefix", "console: ", CVAR_ARCHIVE );
     sv_tellprefix = Cvar_Get ("sv_tellprefix", "console_tell: ", CVAR_ARCHIVE );
     sv_demofolder = Cvar_Get ("sv_demofolder", "serverdemos", CVAR_ARCHIVE );
+    sv_democompress = Cvar_Get ("sv_democompress", "0", CVAR_ARCHIVE );
+    Cvar_CheckRange( sv_democompress, 0, 9, qtrue );
+    sv_demokeyframe = Cvar_Get ("sv_demokeyframe", "10000", CVAR_ARCHIVE );
+    Cvar_CheckRange( sv_demokeyframe, 1000, 600000, qtrue );
 
     #ifdef USE_AUTH
     sv_authServerIP = Cvar_Get("sv_authServerIP", "", CVAR_TEMP | CVAR_ROM);
@@ -1011,6 +1022,7 @@ void SV_Shutdown( char *finalmsg ) {
 
     SV_RemoveOperatorCommands();
     SV_MasterShutdown();
+    SV_MetricsClose();
     SV_ShutdownGameProgs();
 
     // free current level
@@ -22,14 +22,8 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include "server.h"
 
-FILE *file_speeds2 = NULL;
 extern cvar_t *com_quiet;
 extern int com_frameNumber;
-extern unsigned long long Sys_Microseconds (void);
-
-unsigned long long Time1 = 0;
-unsigned long long Time2 = 0;
-unsigned long long lastTime1 = 0;
 
 #ifdef USE_VOIP
 cvar_t *sv_voip;
@@ -68,6 +62,13 @@ cvar_t  *sv_pure;
 cvar_t  *sv_floodProtect;
 cvar_t  *sv_newpurelist;
 cvar_t  *sv_lanForceRate; // dedicated 1 (LAN) server forces local client rates to 99999 (bug #491)
+cvar_t  *sv_pacing; // spread fragments over time with a per-client token bucket
+cvar_t  *sv_batchPmove; // run all usercmds of a server frame back to back before the game frame
+cvar_t  *sv_pmoveChecksum; // print a checksum of all playerstates every game frame
+cvar_t  *sv_eventStream; // 1 = binary, 2 = NDJSON records of the game's events
+cvar_t  *sv_eventStreamPath; // file in the game directory, or unix:/path/to/socket
+cvar_t  *sv_metrics; // serve counters in the Prometheus text format, dedicated only
+cvar_t  *sv_metricsAddress; // host:port or unix:/path/to/socket
 cvar_t  *sv_strictAuth;
 cvar_t  *sv_banFile;
 
@@ -77,6 +78,8 @@ cvar_t	*sv_demonotice;				// notice to print to a client being recorded server-s
 cvar_t  *sv_tellprefix;
 cvar_t  *sv_sayprefix;
 cvar_t 	*sv_demofolder;				//@Barbatos - the name of the folder that contains server-side demos
+cvar_t	*sv_democompress;			// zlib level for seekable server-side demos, 0 writes the plain format
+cvar_t	*sv_demokeyframe;			// msec between keyframes of seekable server-side demos
 
 //@Barbatos
 #ifdef USE_AUTH
@@ -187,6 +190,9 @@ void SV_AddServerCommand( client_t *client, const char *cmd ) {
         }
         index = client->reliableSequence & ( MAX_RELIABLE_COMMANDS - 1 );
         Q_strncpyz( client->reliableCommands[ index ], cmd, sizeof( client->reliableCommands[ index ] ) );
+
+        svMetrics.serverCommands++;
+        svMetrics.serverCommandBytes += strlen( client->reliableCommands[ index ] );
 }
 
 
@@ -267,6 +273,9 @@ void SV_MasterHeartbeat( void ) {
         if (!com_dedicated || com_dedicated->integer != 2 || !(netenabled & (NET_ENABLEV4 | NET_ENABLEV6)))
                 return;         // only dedicated servers send heartbeats
 
+        if (com_journal->integer == JOURNAL_BENCHMARK)
+                return;         // don't resolve masters during a benchmark replay
+
         // if not time yet, don't send anything
         if ( svs.time < svs.nextHeartbeatTime )
                 return;
@@ -275,7 +284,7 @@ void SV_MasterHeartbeat( void ) {
 
 
         #ifdef USE_AUTH
-        VM_Call( gvm, GAME_AUTHSERVER_HEARTBEAT );
+        SV_GameCall( GAME_AUTHSERVER_HEARTBEAT );
         #endif
         // send to group masters
         for (i = 0; i < MAX_MASTER_SERVERS; i++)
@@ -374,14 +383,9 @@ void SV_MasterShutdown( void ) {
         // it will be removed from the list
 
         #ifdef USE_AUTH
-        VM_Call( gvm, GAME_AUTHSERVER_SHUTDOWN );
+        SV_GameCall( GAME_AUTHSERVER_SHUTDOWN );
         #endif
 
-        if (file_speeds2) {
-         fclose(file_speeds2);
-         file_speeds2=NULL;
-        }
-
 }
 
 
@@ -553,6 +557,7 @@ static qboolean SVC_RateLimit( leakyBucket_t *bucket, int burst, int period ) {
                 }
         }
 
+        svMetrics.rateLimited++;
         return qtrue;
 }
 
@@ -1029,7 +1034,7 @@ static void SV_ConnectionlessPacket( netadr_t from, msg_t *msg ) {
                         Com_Printf( "AUTH not from the Auth Server\n" );
                         return;
                 }
-                VM_Call(gvm, GAME_AUTHSERVER_PACKET);
+                SV_GameCall(GAME_AUTHSERVER_PACKET);
         #endif
         } else if (!Q_stricmp(c, "rcon")) {
                 SVC_RemoteCommand( from, msg );
@@ -1057,8 +1062,12 @@ void SV_PacketEvent( netadr_t from, msg_t *msg ) {
         client_t        *cl;
         int                     qport;
 
+        svMetrics.packetsReceived++;
+        svMetrics.bytesReceived += msg->cursize;
+
         // check for connectionless packet (0xffffffff) first
         if ( msg->cursize >= 4 && *(int *)msg->data == -1) {
+                svMetrics.connectionless++;
                 SV_ConnectionlessPacket( from, msg );
                 return;
         }
@@ -1247,6 +1256,31 @@ static qboolean SV_CheckPaused( void ) {
         return qtrue;
 }
 
+/*
+==================
+SV_PmoveChecksum
+
+One line per game frame over the playerstates of the active clients
+==================
+*/
+static void SV_PmoveChecksum( void ) {
+        playerState_t   *ps;
+        unsigned        checksum;
+        int             i, count;
+
+        checksum = 0;
+        count = 0;
+        for ( i = 0 ; i < sv_maxclients->integer ; i++ ) {
+                if ( svs.clients[i].state != CS_ACTIVE ) {
+                        continue;
+                }
+                ps = SV_GameClientNum( i );
+                checksum = checksum * 31 + Com_BlockChecksum( ps, sizeof( *ps ) );
+                count++;
+        }
+        Com_Printf( "pmove %i %i %08x\n", sv.time, count, checksum );
+}
+
 /*
 ==================
 SV_Frame
@@ -1258,6 +1292,9 @@ happen before SV_Frame is called
 void SV_Frame( int msec ) {
         int             frameMsec;
         int             startTime;
+        unsigned long long      benchStart;
+        int             benchGame = 0;
+        perfTime_t      svPerfStart, perfStart;
 
         // the menu kills the server with this cvar
         if ( sv_killserver->integer ) {
@@ -1277,6 +1314,9 @@ void SV_Frame( int msec ) {
                 return;
         }
 
+        // scrapers are answered even while the server idles between frames
+        SV_MetricsFrame();
+
         // allow pause if only the local client is connected
         if ( SV_CheckPaused() ) {
                 return;
@@ -1301,11 +1341,14 @@ void SV_Frame( int msec ) {
 
         if ( com_dedicated->integer && sv.timeResidual < frameMsec ) {
                 // NET_Sleep will give the OS time slices until either get a packet
-                // or time enough for a server frame has gone by
-                NET_Sleep(frameMsec - sv.timeResidual);
+                // or time enough for a server frame has gone by, waking up early
+                // for any fragments the pacer still has to send
+                NET_Sleep(SV_PaceClients(frameMsec - sv.timeResidual));
                 return;
         }
 
+        svPerfStart = Perf_Begin();
+
         // if time is about to hit the 32nd bit, kick all clients
         // and clear sv.time, rather
         // than checking for negative time wraparound everywhere.
@@ -1347,10 +1390,16 @@ void SV_Frame( int msec ) {
         // update ping based on the all received frames
         SV_CalcPings();
 
+        // run the usercmds held back by sv_batchPmove
+        SV_FlushUsercmds();
+
         if (com_dedicated->integer) SV_BotFrame (sv.time);
 
 
-        if (com_speeds2->integer) Time1 = Sys_Microseconds();
+        benchStart = 0;
+        if ( com_journal->integer == JOURNAL_BENCHMARK ) {
+                benchStart = Sys_Microseconds();
+        }
 
         // run the game simulation in chunks
         while ( sv.timeResidual >= frameMsec ) {
@@ -1358,11 +1407,21 @@ void SV_Frame( int msec ) {
                 svs.time += frameMsec;
                 sv.time += frameMsec;
 
+                if ( sv_pmoveChecksum->integer ) {
+                        SV_PmoveChecksum();
+                }
+
                 // let everything in the world think and move
-                VM_Call (gvm, GAME_RUN_FRAME, sv.time);
+                perfStart = Perf_Begin();
+                SV_GameCall (GAME_RUN_FRAME, sv.time);
+                Perf_End( PERF_GAME_FRAME, perfStart );
+                SV_RecordHistory();
+                svMetrics.frames++;
         }
 
-        if (com_speeds2->integer) Time2 = Sys_Microseconds() - Time1;
+        if ( benchStart ) {
+                benchGame = Sys_Microseconds() - benchStart;
+        }
 
         if ( com_speeds->integer ) {
                 time_game = Sys_Milliseconds () - startTime;
@@ -1375,29 +1434,20 @@ void SV_Frame( int msec ) {
 	    SV_CheckClientUserinfoTimer();
 
         // send messages back to the clients
-        SV_SendClientMessages();
+        perfStart = Perf_Begin();
+        if ( benchStart ) {
+                benchStart = Sys_Microseconds();
+                SV_SendClientMessages();
+                Com_BenchmarkFrame( benchGame, Sys_Microseconds() - benchStart );
+        } else {
+                SV_SendClientMessages();
+        }
+        Perf_End( PERF_SNAPSHOTS, perfStart );
 
         // send a heartbeat to the master if needed
         SV_MasterHeartbeat();
 
-
-
-        if (com_speeds2->integer) {
-         if (!file_speeds2) {
-          file_speeds2 = fopen("svframetimes.txt","wt");
-          lastTime1 = Time1;
-         }
-         if (file_speeds2) {
-          fprintf(file_speeds2,"%-10d %15I64u %15I64u\n",com_frameNumber,Time1-lastTime1,Time2);
-          lastTime1 = Time1;
-         }
-        } else {
-         if (file_speeds2) {
-          fclose(file_speeds2);
-          file_speeds2=NULL;
-         }
-        }
-
+        Perf_End( PERF_SV_FRAME, svPerfStart );
 }
 
 //============================================================================
@@ -0,0 +1,545 @@
+/*
+===========================================================================
+Copyright (C) 1999-2005 Id Software, Inc.
+
+This file is part of Quake III Arena source code.
+
+Quake III Arena source code is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the License,
+or (at your option) any later version.
+
+Quake III Arena source code is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Quake III Arena source code; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+===========================================================================
+*/
+// sv_metrics.c -- plain text metrics for scrapers
+
+#include "server.h"
+
+#ifdef _WIN32
+#include <winsock2.h>
+typedef int socklen_t;
+#define socketWouldBlock()	( WSAGetLastError() == WSAEWOULDBLOCK )
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/ioctl.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <errno.h>
+typedef int SOCKET;
+#define INVALID_SOCKET		-1
+#define closesocket			close
+#define ioctlsocket			ioctl
+#define socketWouldBlock()	( errno == EAGAIN || errno == EWOULDBLOCK )
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL		0
+#endif
+
+/*
+
+With sv_metrics 1 a dedicated server listens on sv_metricsAddress, either
+"host:port" for TCP or "unix:/path" for a UNIX domain stream socket, and
+answers any HTTP GET with the counters below in the Prometheus text
+format.  Try it with
+
+	curl -s http://127.0.0.1:27961/metrics
+
+Sockets are non-blocking and serviced from SV_Frame, a slow or stuck
+scraper only ever holds one of the few connection slots until
+METRICS_TIMEOUT runs out, it never stalls the frame.
+
+*/
+
+#define METRICS_CONNECTIONS		4
+#define METRICS_REQUEST			1024
+#define METRICS_RESPONSE		16384		// first allocation, doubled as needed
+#define METRICS_MAX_RESPONSE	( 1024 * 1024 )
+#define METRICS_TIMEOUT			2000		// msec
+
+typedef struct {
+	qboolean	inUse;
+	SOCKET		socket;
+	int			opened;						// Sys_Milliseconds
+	char		request[METRICS_REQUEST];
+	int			requestLength;
+	char		*response;					// Z_Malloc'd
+	int			responseSize;
+	int			responseLength;				// 0 while still reading the request
+	qboolean	overflowed;					// response would exceed METRICS_MAX_RESPONSE
+	int			sent;
+} metricsConnection_t;
+
+static struct {
+	SOCKET				listen;
+	int					modificationCount;
+	metricsConnection_t	connections[METRICS_CONNECTIONS];
+} metrics = { INVALID_SOCKET, -1 };
+
+svMetrics_t	svMetrics;
+
+/*
+================
+SV_MetricsSetNonBlocking
+================
+*/
+static qboolean SV_MetricsSetNonBlocking( SOCKET s ) {
+#ifdef _WIN32
+	u_long	one = 1;
+#else
+	int		one = 1;
+#endif
+
+	return ioctlsocket( s, FIONBIO, &one ) != -1;
+}
+
+/*
+================
+SV_MetricsDropConnection
+================
+*/
+static void SV_MetricsDropConnection( metricsConnection_t *c ) {
+	closesocket( c->socket );
+	if ( c->response ) {
+		Z_Free( c->response );
+	}
+	Com_Memset( c, 0, sizeof( *c ) );
+}
+
+/*
+================
+SV_MetricsClose
+================
+*/
+void SV_MetricsClose( void ) {
+	int		i;
+
+	for ( i = 0; i < METRICS_CONNECTIONS; i++ ) {
+		if ( metrics.connections[i].inUse ) {
+			SV_MetricsDropConnection( &metrics.connections[i] );
+		}
+	}
+	Com_Memset( metrics.connections, 0, sizeof( metrics.connections ) );
+
+	if ( metrics.listen != INVALID_SOCKET ) {
+		closesocket( metrics.listen );
+		metrics.listen = INVALID_SOCKET;
+	}
+
+	// reopened by the next SV_MetricsFrame
+	metrics.modificationCount = -1;
+}
+
+/*
+================
+SV_MetricsOpen
+================
+*/
+static void SV_MetricsOpen( void ) {
+	const char			*address;
+	struct sockaddr_in	in;
+	char				host[MAX_QPATH];
+	char				*port;
+	int					one = 1;
+
+	address = sv_metricsAddress->string;
+
+	if ( !Q_stricmpn( address, "unix:", 5 ) ) {
+#ifdef _WIN32
+		Com_Printf( "sv_metricsAddress: UNIX domain sockets are not supported on this platform\n" );
+#else
+		struct sockaddr_un	un;
+		struct stat			st;
+
+		Com_Memset( &un, 0, sizeof( un ) );
+		un.sun_family = AF_UNIX;
+		Q_strncpyz( un.sun_path, address + 5, sizeof( un.sun_path ) );
+
+		// only ever remove a stale socket, the cvar can be set over rcon
+		if ( lstat( un.sun_path, &st ) == 0 ) {
+			if ( !S_ISSOCK( st.st_mode ) ) {
+				Com_Printf( "WARNING: metrics: %s exists and is not a socket\n", un.sun_path );
+				return;
+			}
+			unlink( un.sun_path );
+		}
+
+		metrics.listen = socket( AF_UNIX, SOCK_STREAM, 0 );
+		if ( metrics.listen == INVALID_SOCKET ) {
+			Com_Printf( "WARNING: metrics socket: %s\n", strerror( errno ) );
+			return;
+		}
+		if ( bind( metrics.listen, (struct sockaddr *)&un, sizeof( un ) ) == -1 ) {
+			Com_Printf( "WARNING: metrics bind to %s: %s\n", un.sun_path, strerror( errno ) );
+			SV_MetricsClose();
+			return;
+		}
+#endif
+	} else {
+		Q_strncpyz( host, address, sizeof( host ) );
+		port = strrchr( host, ':' );
+		if ( !port ) {
+			Com_Printf( "sv_metricsAddress: expected host:port or unix:/path, got \"%s\"\n", address );
+			return;
+		}
+		*port++ = 0;
+
+		Com_Memset( &in, 0, sizeof( in ) );
+		in.sin_family = AF_INET;
+		in.sin_port = htons( (unsigned short)atoi( port ) );
+		if ( !host[0] || !strcmp( host, "*" ) ) {
+			in.sin_addr.s_addr = htonl( INADDR_ANY );
+		} else {
+			in.sin_addr.s_addr = inet_addr( host );
+		}
+
+		metrics.listen = socket( AF_INET, SOCK_STREAM, IPPROTO_TCP );
+		if ( metrics.listen == INVALID_SOCKET ) {
+			Com_Printf( "WARNING: metrics socket failed\n" );
+			return;
+		}
+		setsockopt( metrics.listen, SOL_SOCKET, SO_REUSEADDR, (const char *)&one, sizeof( one ) );
+		if ( bind( metrics.listen, (struct sockaddr *)&in, sizeof( in ) ) == -1 ) {
+			Com_Printf( "WARNING: metrics bind to %s failed\n", address );
+			SV_MetricsClose();
+			return;
+		}
+	}
+
+	if ( !SV_MetricsSetNonBlocking( metrics.listen ) || listen( metrics.listen, METRICS_CONNECTIONS ) == -1 ) {
+		Com_Printf( "WARNING: metrics listen on %s failed\n", address );
+		SV_MetricsClose();
+		return;
+	}
+
+	Com_Printf( "Serving metrics on %s\n", address );
+}
+
+/*
+================
+SV_MetricsReserve
+
+Makes room for length more bytes and a terminator, qfalse past METRICS_MAX_RESPONSE
+================
+*/
+static qboolean SV_MetricsReserve( metricsConnection_t *c, int length ) {
+	char	*grown;
+	int		size;
+
+	if ( c->responseLength + length < c->responseSize ) {
+		return qtrue;
+	}
+
+	size = c->responseSize ? c->responseSize : METRICS_RESPONSE;
+	while ( c->responseLength + length >= size ) {
+		size *= 2;
+	}
+	if ( size > METRICS_MAX_RESPONSE ) {
+		c->overflowed = qtrue;
+		return qfalse;
+	}
+
+	grown = Z_Malloc( size );
+	if ( c->response ) {
+		Com_Memcpy( grown, c->response, c->responseLength );
+		Z_Free( c->response );
+	}
+	c->response = grown;
+	c->responseSize = size;
+	return qtrue;
+}
+
+/*
+================
+SV_MetricsPrintf
+================
+*/
+static void QDECL SV_MetricsPrintf( metricsConnection_t *c, const char *fmt, ... ) {
+	va_list	argptr;
+	char	line[1024];
+	int		len;
+
+	if ( c->overflowed ) {
+		return;
+	}
+
+	va_start( argptr, fmt );
+	Q_vsnprintf( line, sizeof( line ), fmt, argptr );
+	va_end( argptr );
+	line[sizeof( line ) - 1] = 0;
+
+	len = strlen( line );
+	if ( !SV_MetricsReserve( c, len ) ) {
+		return;
+	}
+	Com_Memcpy( c->response + c->responseLength, line, len + 1 );
+	c->responseLength += len;
+}
+
+/*
+================
+SV_MetricsError
+================
+*/
+static void SV_MetricsError( metricsConnection_t *c, const char *status ) {
+	c->responseLength = 0;
+	c->overflowed = qfalse;
+	SV_MetricsPrintf( c, "HTTP/1.0 %s\r\nConnection: close\r\n\r\n", status );
+}
+
+/*
+================
+SV_MetricsCounter
+================
+*/
+static void SV_MetricsCounter( metricsConnection_t *c, const char *name, const char *type, const char *help, unsigned long long value ) {
+	SV_MetricsPrintf( c, "# HELP %s %s\n# TYPE %s %s\n%s %llu\n", name, help, name, type, name, value );
+}
+
+/*
+================
+SV_MetricsFrameTimes
+================
+*/
+static void SV_MetricsFrameTimes( metricsConnection_t *c, perfScope_t scope ) {
+	perfSummary_t	sum;
+	const char		*name;
+
+	Perf_Summary( scope, &sum );
+	name = Perf_ScopeName( scope );
+
+	SV_MetricsPrintf( c, "ioq3_frame_usec{scope=\"%s\",quantile=\"0.5\"} %u\n", name, sum.p50 );
+	SV_MetricsPrintf( c, "ioq3_frame_usec{scope=\"%s\",quantile=\"0.9\"} %u\n", name, sum.p90 );
+	SV_MetricsPrintf( c, "ioq3_frame_usec{scope=\"%s\",quantile=\"0.99\"} %u\n", name, sum.p99 );
+	SV_MetricsPrintf( c, "ioq3_frame_usec{scope=\"%s\",quantile=\"1\"} %u\n", name, sum.max );
+	SV_MetricsPrintf( c, "ioq3_frame_usec_sum{scope=\"%s\"} %llu\n", name, sum.total );
+	SV_MetricsPrintf( c, "ioq3_frame_usec_count{scope=\"%s\"} %u\n", name, sum.count );
+}
+
+/*
+================
+SV_MetricsBuild
+
+Fills in the response, headers last since they carry the body length
+================
+*/
+static void SV_MetricsBuild( metricsConnection_t *c ) {
+	client_t	*cl;
+	int			i, active, connecting, bots, downloading;
+	int			bodyLength, headerLength;
+	char		header[256];
+
+	active = connecting = bots = downloading = 0;
+	for ( i = 0, cl = svs.clients; svs.clients && i < sv_maxclients->integer; i++, cl++ ) {
+		if ( cl->state < CS_CONNECTED ) {
+			continue;
+		}
+		if ( cl->netchan.remoteAddress.type == NA_BOT ) {
+			bots++;
+		} else if ( cl->state == CS_ACTIVE ) {
+			active++;
+		} else {
+			connecting++;
+		}
+		if ( cl->download ) {
+			downloading++;
+		}
+	}
+
+	c->responseLength = 0;
+	c->overflowed = qfalse;
+
+	SV_MetricsPrintf( c, "# HELP ioq3_players Connected clients\n# TYPE ioq3_players gauge\n" );
+	SV_MetricsPrintf( c, "ioq3_players{state=\"active\"} %i\n", active );
+	SV_MetricsPrintf( c, "ioq3_players{state=\"connecting\"} %i\n", connecting );
+	SV_MetricsPrintf( c, "ioq3_players{state=\"bot\"} %i\n", bots );
+	SV_MetricsCounter( c, "ioq3_max_clients", "gauge", "sv_maxclients", sv_maxclients->integer );
+	SV_MetricsCounter( c, "ioq3_server_time_msec", "gauge", "svs.time", svs.time );
+
+	SV_MetricsCounter( c, "ioq3_frames_total", "counter", "Server frames run", svMetrics.frames );
+	SV_MetricsPrintf( c, "# HELP ioq3_frame_usec Frame time percentiles over the last com_perfWindow\n# TYPE ioq3_frame_usec summary\n" );
+	SV_MetricsFrameTimes( c, PERF_SV_FRAME );
+	SV_MetricsFrameTimes( c, PERF_GAME_FRAME );
+	SV_MetricsFrameTimes( c, PERF_SNAPSHOTS );
+	SV_MetricsFrameTimes( c, PERF_EVENT_LATENCY );
+
+	SV_MetricsCounter( c, "ioq3_packets_received_total", "counter", "Packets handed to SV_PacketEvent", svMetrics.packetsReceived );
+	SV_MetricsCounter( c, "ioq3_bytes_received_total", "counter", "Bytes handed to SV_PacketEvent", svMetrics.bytesReceived );
+	SV_MetricsCounter( c, "ioq3_connectionless_packets_total", "counter", "Out of band packets received", svMetrics.connectionless );
+	SV_MetricsCounter( c, "ioq3_messages_sent_total", "counter", "Messages sent by SV_SendMessageToClient", svMetrics.messagesSent );
+	SV_MetricsCounter( c, "ioq3_message_bytes_sent_total", "counter", "Bytes sent by SV_SendMessageToClient", svMetrics.messageBytesSent );
+	SV_MetricsCounter( c, "ioq3_server_commands_total", "counter", "Reliable server commands queued to clients", svMetrics.serverCommands );
+	SV_MetricsCounter( c, "ioq3_server_command_bytes_total", "counter", "Bytes of reliable server commands queued to clients", svMetrics.serverCommandBytes );
+	SV_MetricsCounter( c, "ioq3_packets_sent_total", "counter", "Datagrams sent, fragments and out of band included", netchanStats.packets );
+	SV_MetricsCounter( c, "ioq3_bytes_sent_total", "counter", "Datagram bytes sent", netchanStats.sentBytes );
+	SV_MetricsCounter( c, "ioq3_netchan_dropped_total", "counter", "Gaps in incoming netchan sequences", netchanStats.dropped );
+	SV_MetricsCounter( c, "ioq3_netchan_out_of_order_total", "counter", "Out of order or duplicated netchan packets", netchanStats.outOfOrder );
+
+	SV_MetricsPrintf( c, "# HELP ioq3_client_queue_delay_usec Average time from a packet's arrival to its processing\n"
+		"# TYPE ioq3_client_queue_delay_usec gauge\n" );
+	for ( i = 0, cl = svs.clients; svs.clients && i < sv_maxclients->integer; i++, cl++ ) {
+		if ( cl->state >= CS_CONNECTED && cl->netchan.remoteAddress.type != NA_BOT ) {
+			SV_MetricsPrintf( c, "ioq3_client_queue_delay_usec{client=\"%i\"} %i\n", i, cl->netchan.queueDelay );
+		}
+	}
+
+	SV_MetricsCounter( c, "ioq3_downloads_active", "gauge", "Clients downloading", downloading );
+	SV_MetricsCounter( c, "ioq3_download_bytes_total", "counter", "Download block bytes sent", svMetrics.downloadBytes );
+	SV_MetricsCounter( c, "ioq3_rate_limited_total", "counter", "Out of band requests refused by SVC_RateLimit", svMetrics.rateLimited );
+	SV_MetricsCounter( c, "ioq3_metrics_scrapes_total", "counter", "Metrics requests answered", svMetrics.scrapes );
+
+	// never send a body that doesn't match its Content-Length
+	bodyLength = c->responseLength;
+	Com_sprintf( header, sizeof( header ), "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\n"
+		"Content-Length: %i\r\nConnection: close\r\n\r\n", bodyLength );
+	headerLength = strlen( header );
+	if ( c->overflowed || !SV_MetricsReserve( c, headerLength ) ) {
+		SV_MetricsError( c, "500 Internal Server Error" );
+		return;
+	}
+
+	memmove( c->response + headerLength, c->response, bodyLength );
+	Com_Memcpy( c->response, header, headerLength );
+	c->responseLength += headerLength;
+}
+
+/*
+================
+SV_MetricsRead
+
+Returns qfalse when the connection should be dropped
+================
+*/
+static qboolean SV_MetricsRead( metricsConnection_t *c ) {
+	int		r;
+
+	r = recv( c->socket, c->request + c->requestLength, METRICS_REQUEST - 1 - c->requestLength, 0 );
+	if ( r == 0 || ( r < 0 && !socketWouldBlock() ) ) {
+		return qfalse;
+	}
+	if ( r < 0 ) {
+		return qtrue;
+	}
+	c->requestLength += r;
+	c->request[c->requestLength] = 0;
+
+	if ( !strstr( c->request, "\r\n\r\n" ) && !strstr( c->request, "\n\n" ) ) {
+		if ( c->requestLength >= METRICS_REQUEST - 1 ) {
+			return qfalse;
+		}
+		return qtrue;
+	}
+
+	if ( Q_strncmp( c->request, "GET ", 4 ) ) {
+		SV_MetricsError( c, "405 Method Not Allowed" );
+		return qtrue;
+	}
+
+	svMetrics.scrapes++;
+	SV_MetricsBuild( c );
+	return qtrue;
+}
+
+/*
+================
+SV_MetricsWrite
+
+Returns qfalse once everything is out or the peer went away
+================
+*/
+static qboolean SV_MetricsWrite( metricsConnection_t *c ) {
+	int		r;
+
+	r = send( c->socket, c->response + c->sent, c->responseLength - c->sent, MSG_NOSIGNAL );
+	if ( r < 0 ) {
+		return socketWouldBlock();
+	}
+	c->sent += r;
+	return c->sent < c->responseLength;
+}
+
+/*
+================
+SV_MetricsFrame
+
+Called every server frame, never blocks
+================
+*/
+void SV_MetricsFrame( void ) {
+	metricsConnection_t	*c;
+	SOCKET		s;
+	int			i, now;
+	qboolean	keep;
+
+	if ( !com_dedicated->integer ) {
+		return;
+	}
+
+	if ( metrics.modificationCount != sv_metrics->modificationCount + sv_metricsAddress->modificationCount ) {
+		SV_MetricsClose();
+		metrics.modificationCount = sv_metrics->modificationCount + sv_metricsAddress->modificationCount;
+		if ( sv_metrics->integer ) {
+			SV_MetricsOpen();
+		}
+	}
+	if ( metrics.listen == INVALID_SOCKET ) {
+		return;
+	}
+
+	now = Sys_Milliseconds();
+
+	// take new connections while there is room, the rest wait in the backlog
+	for ( i = 0; i < METRICS_CONNECTIONS; i++ ) {
+		c = &metrics.connections[i];
+		if ( c->inUse ) {
+			continue;
+		}
+		s = accept( metrics.listen, NULL, NULL );
+		if ( s == INVALID_SOCKET ) {
+			break;
+		}
+		if ( !SV_MetricsSetNonBlocking( s ) ) {
+			closesocket( s );
+			continue;
+		}
+		Com_Memset( c, 0, sizeof( *c ) );
+		c->inUse = qtrue;
+		c->socket = s;
+		c->opened = now;
+	}
+
+	for ( i = 0; i < METRICS_CONNECTIONS; i++ ) {
+		c = &metrics.connections[i];
+		if ( !c->inUse ) {
+			continue;
+		}
+
+		if ( !c->responseLength ) {
+			keep = SV_MetricsRead( c );
+		} else {
+			keep = qtrue;
+		}
+		if ( keep && c->responseLength ) {
+			keep = SV_MetricsWrite( c );
+		}
+		if ( keep && now - c->opened > METRICS_TIMEOUT ) {
+			keep = qfalse;
+		}
+
+		if ( !keep ) {
+			SV_MetricsDropConnection( c );
+		}
+	}
+}
@@ -135,6 +135,7 @@ SV_Netchan_TransmitNextFragment
 */
 void SV_Netchan_TransmitNextFragment( client_t *client ) {
 	Netchan_TransmitNextFragment( &client->netchan );
+	SV_PaceCharge( client, client->netchan.lastSentSize );
 	if (!client->netchan.unsentFragments)
 	{
 		// make sure the netchan queue has been properly initialized (you never know)
@@ -148,6 +149,7 @@ void SV_Netchan_TransmitNextFragment( client_t *client ) {
 			netbuf = client->netchan_start_queue;
 			SV_Netchan_Encode( client, &netbuf->msg );
 			Netchan_Transmit( &client->netchan, netbuf->msg.cursize, netbuf->msg.data );
+			SV_PaceCharge( client, client->netchan.lastSentSize );
 			// pop from queue
 			client->netchan_start_queue = netbuf->next;
 			if (!client->netchan_start_queue) {
@@ -162,6 +164,27 @@ void SV_Netchan_TransmitNextFragment( client_t *client ) {
 }
 
 
+/*
+=================
+SV_Netchan_QueuedBytes
+
+Bytes still waiting to go out: the rest of the message being
+fragmented plus whatever got stacked up behind it
+=================
+*/
+int SV_Netchan_QueuedBytes( const client_t *client ) {
+	netchan_buffer_t *netbuf;
+	int bytes = 0;
+
+	if (client->netchan.unsentFragments) {
+		bytes = client->netchan.unsentLength - client->netchan.unsentFragmentStart;
+	}
+	for (netbuf = client->netchan_start_queue; netbuf; netbuf = netbuf->next) {
+		bytes += netbuf->msg.cursize;
+	}
+	return bytes;
+}
+
 /*
 ===============
 SV_Netchan_Transmit
@@ -181,15 +204,18 @@ void SV_Netchan_Transmit( client_t *client, msg_t *msg) {	//int length, const by
 		netbuf = (netchan_buffer_t *)Z_Malloc(sizeof(netchan_buffer_t));
 		// store the msg, we can't store it encoded, as the encoding depends on stuff we still have to finish sending
 		MSG_Copy(&netbuf->msg, netbuf->msgBuffer, sizeof( netbuf->msgBuffer ), msg);
+		Netchan_CountCopy( msg->cursize );
 		netbuf->next = NULL;
 		// insert it in the queue, the message will be encoded and sent later
 		*client->netchan_end_queue = netbuf;
 		client->netchan_end_queue = &(*client->netchan_end_queue)->next;
-		// emit the next fragment of the current message for now
-		Netchan_TransmitNextFragment(&client->netchan);
+		// emit the next fragment of the current message for now, and
+		// start on the queue if that was the last one
+		SV_Netchan_TransmitNextFragment( client );
 	} else {
 		SV_Netchan_Encode( client, msg );
 		Netchan_Transmit( &client->netchan, msg->cursize, msg->data );
+		SV_PaceCharge( client, client->netchan.lastSentSize );
 	}
 }
 
@@ -147,7 +147,8 @@ static void SV_WriteSnapshotToClient( client_t *client, msg_t *msg ) {
 		// once we reach 1 full frame for every 1024 delta frames we stay there
 		// TODO: these numbers need to be tweaked properly, the current values
 		// just seem to work "fine" for all the tests we ran...
-		if (client->demo_backoff < 1024) {
+		// seekable demos keep a fixed keyframe spacing instead
+		if (!client->demo_compressed && client->demo_backoff < 1024) {
 			client->demo_backoff *= 2;
 		}
 		client->demo_deltas = client->demo_backoff;
@@ -175,6 +176,7 @@ static void SV_WriteSnapshotToClient( client_t *client, msg_t *msg ) {
 		client->demo_waiting = qfalse;
 		Com_DPrintf("Got non-delta frame, recording %s now\n", client->name);
 	}
+	client->demo_keyframe = !oldframe;
 	
     MSG_WriteByte (msg, svc_snapshot);
 
@@ -555,14 +557,9 @@ to take to clear, based on the current rate
 ====================
 */
 #define HEADER_RATE_BYTES   48      // include our header, IP header, and some overhead
-static int SV_RateMsec( client_t *client, int messageSize ) {
+static int SV_ClientRate( client_t *client ) {
     int     rate;
-    int     rateMsec;
 
-    // individual messages will never be larger than fragment size
-    if ( messageSize > 1500 ) {
-        messageSize = 1500;
-    }
     rate = client->rate;
     if ( sv_maxRate->integer ) {
         if ( sv_maxRate->integer < 1000 ) {
@@ -579,11 +576,157 @@ static int SV_RateMsec( client_t *client, int messageSize ) {
             rate = sv_minRate->integer;
     }
 
-	rateMsec = ( messageSize + HEADER_RATE_BYTES ) * 1000 / ((int) (rate * com_timescale->value));
+    return rate;
+}
+
+static int SV_RateMsec( client_t *client, int messageSize ) {
+    int     rateMsec;
+
+    // individual messages will never be larger than fragment size
+    if ( messageSize > 1500 ) {
+        messageSize = 1500;
+    }
+
+	rateMsec = ( messageSize + HEADER_RATE_BYTES ) * 1000 / ((int) (SV_ClientRate( client ) * com_timescale->value));
 
     return rateMsec;
 }
 
+/*
+====================
+SV_PaceRate
+
+Bytes per second the client is paced at.  A timescale of 0 would stop
+the bucket from ever filling, so it's kept at one byte at least.
+====================
+*/
+static int SV_PaceRate( client_t *client ) {
+    int     rate;
+
+    rate = SV_ClientRate( client ) * com_timescale->value;
+    if ( rate < 1 ) {
+        rate = 1;
+    }
+    return rate;
+}
+
+/*
+====================
+SV_PaceRefill
+
+Top up the client's token bucket for the time gone by.  It holds
+at most a server frame worth of the client's rate, and never less
+than one full fragment.
+====================
+*/
+static void SV_PaceRefill( client_t *client ) {
+    unsigned long long  now;
+    int     rate, burst;
+
+    now = Sys_Microseconds();
+    rate = SV_PaceRate( client );
+    burst = rate / sv_fps->integer;
+    if ( burst < 1500 + HEADER_RATE_BYTES ) {
+        burst = 1500 + HEADER_RATE_BYTES;
+    }
+
+    if ( now > client->pace_time ) {
+        if ( now - client->pace_time >= 1000000 ) {
+            client->pace_tokens = burst;
+        } else {
+            client->pace_tokens += (int) ( ( now - client->pace_time ) * rate / 1000000 );
+        }
+    }
+    if ( client->pace_tokens > burst ) {
+        client->pace_tokens = burst;
+    }
+    client->pace_time = now;
+}
+
+/*
+====================
+SV_PaceCharge
+
+Pay for a datagram that just went out to the client.  The netchan
+calls this for every packet it really sends, including the ones
+flushed later from the #462 queue.
+====================
+*/
+void SV_PaceCharge( client_t *client, int packetSize ) {
+    if ( !sv_pacing->integer ) {
+        return;
+    }
+    SV_PaceRefill( client );
+    client->pace_tokens -= packetSize + HEADER_RATE_BYTES;
+}
+
+/*
+====================
+SV_PaceClient
+
+Send as many pending fragments as the token bucket allows
+====================
+*/
+static void SV_PaceClient( client_t *client ) {
+    SV_PaceRefill( client );
+
+    while ( client->netchan.unsentFragments && client->pace_tokens > 0 ) {
+        SV_Netchan_TransmitNextFragment( client );
+    }
+}
+
+/*
+====================
+SV_PaceDelay
+
+Msec until the client's next fragment may go out
+====================
+*/
+int SV_PaceDelay( const client_t *client ) {
+    int     rate;
+
+    if ( !sv_pacing->integer || !client->netchan.unsentFragments || client->pace_tokens > 0 ) {
+        return 0;
+    }
+    rate = SV_PaceRate( (client_t *)client );
+    return ( -client->pace_tokens * 1000 + rate - 1 ) / rate;
+}
+
+/*
+====================
+SV_PaceClients
+
+Between server frames, hand out fragments as tokens come in and
+return how long the caller may sleep before the next one is due.
+====================
+*/
+int SV_PaceClients( int sleepMsec ) {
+    int         i, delay;
+    client_t    *c;
+
+    if ( !sv_pacing->integer ) {
+        return sleepMsec;
+    }
+
+    for ( i = 0, c = svs.clients ; i < sv_maxclients->integer ; i++, c++ ) {
+        if ( !c->state || !c->netchan.unsentFragments ) {
+            continue;
+        }
+        if ( c->gentity && c->gentity->r.svFlags & SVF_BOT ) {
+            continue;
+        }
+
+        SV_PaceClient( c );
+
+        delay = SV_PaceDelay( c );
+        if ( c->netchan.unsentFragments && delay < sleepMsec ) {
+            sleepMsec = delay > 0 ? delay : 1;
+        }
+    }
+
+    return sleepMsec;
+}
+
 /*
 =======================
 SV_SendMessageToClient
@@ -604,7 +747,11 @@ void SV_SendMessageToClient( msg_t *msg, client_t *client ) {
     client->frames[client->netchan.outgoingSequence & PACKET_MASK].messageSent = svs.time;
     client->frames[client->netchan.outgoingSequence & PACKET_MASK].messageAcked = -1;
 
-    // send the datagram
+    svMetrics.messagesSent++;
+    svMetrics.messageBytesSent += msg->cursize;
+
+    // send the datagram, the netchan charges the pacing bucket for
+    // whatever really goes out
     SV_Netchan_Transmit( client, msg ); //msg->cursize, msg->data );
 
     // set nextSnapshotTime based on rate and requested number of updates
@@ -662,7 +809,13 @@ void SV_SendClientSnapshot( client_t *client ) {
         return;
     }
 
-    MSG_Init (&msg, msg_buf, sizeof(msg_buf));
+    // encode straight into the netchan so nothing is copied on the way out,
+    // unless it is still busy with fragments and the message has to queue
+    if ( Netchan_Arena( &client->netchan ) ) {
+        MSG_Init (&msg, Netchan_Arena( &client->netchan ), MAX_MSGLEN);
+    } else {
+        MSG_Init (&msg, msg_buf, sizeof(msg_buf));
+    }
     msg.allowoverflow = qtrue;
 
     // NOTE, MRE: all server->client messages now acknowledge
@@ -708,6 +861,13 @@ void SV_SendClientMessages( void ) {
             continue;       // not connected
         }
 
+        // paced fragments go out as the client's token bucket allows,
+        // the next snapshot waits until the last of them is gone
+        if ( sv_pacing->integer && c->netchan.unsentFragments ) {
+            SV_PaceClient( c );
+            continue;
+        }
+
         if ( svs.time < c->nextSnapshotTime ) {
             continue;       // not time yet
         }
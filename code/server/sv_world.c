@@ -150,6 +150,7 @@ void SV_ClearWorld( void ) {
 
 	Com_Memset( sv_worldSectors, 0, sizeof(sv_worldSectors) );
 	sv_numworldSectors = 0;
+	SV_ClearHistory();
 
 	// get world map bounds
 	h = CM_InlineModel( 0 );
@@ -445,6 +446,112 @@ int SV_AreaEntities( const vec3_t mins, const vec3_t maxs, int *entityList, int
 
 //===========================================================================
 
+/*
+
+Lag compensation history.  After every game frame the collision box of
+each client is stored in a ring, SV_TraceAtTime clips shots against the
+boxes as they were at a past time, interpolated between the two frames
+around it, without relinking anything.
+
+*/
+
+#define MAX_HISTORY_FRAMES		64		// 3.2 seconds at sv_fps 20
+#define	HISTORY_TELEPORT_DIST	256		// don't interpolate across a jump this long
+
+typedef struct {
+	vec3_t		origin;
+	vec3_t		mins, maxs;
+	int			contents;		// 0 when not linked
+	qboolean	capsule;
+} clientHistory_t;
+
+typedef struct {
+	int				time;
+	clientHistory_t	clients[MAX_CLIENTS];
+} historyFrame_t;
+
+static historyFrame_t	historyFrames[MAX_HISTORY_FRAMES];
+static int				numHistoryFrames;		// ever recorded this level
+
+/*
+================
+SV_RecordHistory
+
+Called after every GAME_RUN_FRAME
+================
+*/
+void SV_RecordHistory( void ) {
+	historyFrame_t	*frame;
+	clientHistory_t	*h;
+	sharedEntity_t	*ent;
+	int				i;
+
+	frame = &historyFrames[numHistoryFrames % MAX_HISTORY_FRAMES];
+	frame->time = sv.time;
+	for ( i = 0 ; i < sv_maxclients->integer ; i++ ) {
+		h = &frame->clients[i];
+		ent = SV_GentityNum( i );
+		if ( svs.clients[i].state != CS_ACTIVE || !ent->r.linked || ent->r.bmodel ) {
+			h->contents = 0;
+			continue;
+		}
+		VectorCopy( ent->r.currentOrigin, h->origin );
+		VectorCopy( ent->r.mins, h->mins );
+		VectorCopy( ent->r.maxs, h->maxs );
+		h->contents = ent->r.contents;
+		h->capsule = ( ent->r.svFlags & SVF_CAPSULE ) != 0;
+	}
+	numHistoryFrames++;
+}
+
+/*
+================
+SV_ClearHistory
+================
+*/
+void SV_ClearHistory( void ) {
+	numHistoryFrames = 0;
+}
+
+/*
+================
+SV_HistoryAt
+
+Finds the recorded frames at and after time, qfalse when time
+is not older than the last frame and current positions apply
+================
+*/
+static qboolean SV_HistoryAt( int time, const historyFrame_t **older, const historyFrame_t **newer, float *frac ) {
+	const historyFrame_t	*f, *next;
+	int		i, oldest;
+
+	if ( !numHistoryFrames ) {
+		return qfalse;
+	}
+
+	next = &historyFrames[( numHistoryFrames - 1 ) % MAX_HISTORY_FRAMES];
+	if ( time >= next->time ) {
+		return qfalse;
+	}
+
+	oldest = numHistoryFrames > MAX_HISTORY_FRAMES ? numHistoryFrames - MAX_HISTORY_FRAMES : 0;
+	for ( i = numHistoryFrames - 2 ; i >= oldest ; i-- ) {
+		f = &historyFrames[i % MAX_HISTORY_FRAMES];
+		if ( f->time <= time ) {
+			*older = f;
+			*newer = next;
+			*frac = (float)( time - f->time ) / ( next->time - f->time );
+			return qtrue;
+		}
+		next = f;
+	}
+
+	// older than anything kept, use the oldest frame
+	*older = *newer = next;
+	*frac = 0;
+	return qtrue;
+}
+
 
 typedef struct {
 	vec3_t		boxmins, boxmaxs;// enclose the test object along entire move
@@ -456,6 +563,8 @@ typedef struct {
 	int			passEntityNum;
 	int			contentmask;
 	int			capsule;
+	const historyFrame_t	*older, *newer;		// clients are clipped from these when set
+	float		frac;
 } moveclip_t;
 
 
@@ -552,6 +661,11 @@ static void SV_ClipMoveToEntities( moveclip_t *clip ) {
 			continue;
 		}
 
+		// clients are clipped from the history instead
+		if ( clip->older && touchlist[i] < sv_maxclients->integer ) {
+			continue;
+		}
+
 		// might intersect, so do an exact clip
 		clipHandle = SV_ClipHandleForEntity (touch);
 
@@ -590,14 +704,99 @@ static void SV_ClipMoveToEntities( moveclip_t *clip ) {
 
 
 /*
-==================
-SV_Trace
+====================
+SV_ClipMoveToHistory
 
-Moves the given mins/maxs volume through the world from start to end.
-passEntityNum and entities owned by passEntityNum are explicitly not checked.
+The clients, from the history frames around clip->time
+====================
+*/
+static void SV_ClipMoveToHistory( moveclip_t *clip ) {
+	const clientHistory_t	*a, *b;
+	sharedEntity_t	*touch;
+	int			i, passOwnerNum;
+	vec3_t		origin;
+	trace_t		trace;
+	clipHandle_t	clipHandle;
+
+	if ( clip->passEntityNum != ENTITYNUM_NONE ) {
+		passOwnerNum = ( SV_GentityNum( clip->passEntityNum ) )->r.ownerNum;
+		if ( passOwnerNum == ENTITYNUM_NONE ) {
+			passOwnerNum = -1;
+		}
+	} else {
+		passOwnerNum = -1;
+	}
+
+	for ( i = 0 ; i < sv_maxclients->integer ; i++ ) {
+		if ( clip->trace.allsolid ) {
+			return;
+		}
+
+		a = &clip->older->clients[i];
+		b = &clip->newer->clients[i];
+		if ( ! ( clip->contentmask & a->contents ) ) {
+			continue;
+		}
+
+		// unlinked since, like railgun targets already hit
+		touch = SV_GentityNum( i );
+		if ( !touch->r.linked ) {
+			continue;
+		}
+
+		if ( clip->passEntityNum != ENTITYNUM_NONE ) {
+			if ( i == clip->passEntityNum || touch->r.ownerNum == clip->passEntityNum
+				|| touch->r.ownerNum == passOwnerNum ) {
+				continue;
+			}
+		}
+
+		if ( b->contents && DistanceSquared( a->origin, b->origin ) < Square( HISTORY_TELEPORT_DIST ) ) {
+			origin[0] = a->origin[0] + clip->frac * ( b->origin[0] - a->origin[0] );
+			origin[1] = a->origin[1] + clip->frac * ( b->origin[1] - a->origin[1] );
+			origin[2] = a->origin[2] + clip->frac * ( b->origin[2] - a->origin[2] );
+		} else {
+			VectorCopy( a->origin, origin );
+		}
+
+		if ( origin[0] + a->mins[0] > clip->boxmaxs[0] || origin[0] + a->maxs[0] < clip->boxmins[0]
+			|| origin[1] + a->mins[1] > clip->boxmaxs[1] || origin[1] + a->maxs[1] < clip->boxmins[1]
+			|| origin[2] + a->mins[2] > clip->boxmaxs[2] || origin[2] + a->maxs[2] < clip->boxmins[2] ) {
+			continue;
+		}
+
+		clipHandle = CM_TempBoxModel( a->mins, a->maxs, a->capsule );
+		CM_TransformedBoxTrace ( &trace, (float *)clip->start, (float *)clip->end,
+			(float *)clip->mins, (float *)clip->maxs, clipHandle,  clip->contentmask,
+			origin, vec3_origin, clip->capsule);
+
+		if ( trace.allsolid ) {
+			clip->trace.allsolid = qtrue;
+		} else if ( trace.startsolid ) {
+			clip->trace.startsolid = qtrue;
+		}
+
+		if ( trace.fraction < clip->trace.fraction ) {
+			qboolean	oldStart;
+
+			// make sure we keep a startsolid from a previous trace
+			oldStart = clip->trace.startsolid;
+
+			trace.entityNum = i;
+			clip->trace = trace;
+			clip->trace.startsolid |= oldStart;
+		}
+	}
+}
+
+
+/*
+==================
+SV_TraceHistory
 ==================
 */
-void SV_Trace( trace_t *results, const vec3_t start, vec3_t mins, vec3_t maxs, const vec3_t end, int passEntityNum, int contentmask, int capsule ) {
+static void SV_TraceHistory( trace_t *results, const vec3_t start, vec3_t mins, vec3_t maxs, const vec3_t end, int passEntityNum, int contentmask, int capsule,
+							 const historyFrame_t *older, const historyFrame_t *newer, float frac ) {
 	moveclip_t	clip;
 	int			i;
 
@@ -626,6 +825,9 @@ void SV_Trace( trace_t *results, const vec3_t start, vec3_t mins, vec3_t maxs, c
 	clip.maxs = maxs;
 	clip.passEntityNum = passEntityNum;
 	clip.capsule = capsule;
+	clip.older = older;
+	clip.newer = newer;
+	clip.frac = frac;
 
 	// create the bounding box of the entire move
 	// we can limit it to the part of the move not
@@ -643,11 +845,49 @@ void SV_Trace( trace_t *results, const vec3_t start, vec3_t mins, vec3_t maxs, c
 
 	// clip to other solid entities
 	SV_ClipMoveToEntities ( &clip );
+	if ( clip.older ) {
+		SV_ClipMoveToHistory( &clip );
+	}
 
 	*results = clip.trace;
 }
 
 
+/*
+==================
+SV_Trace
+
+Moves the given mins/maxs volume through the world from start to end.
+passEntityNum and entities owned by passEntityNum are explicitly not checked.
+==================
+*/
+void SV_Trace( trace_t *results, const vec3_t start, vec3_t mins, vec3_t maxs, const vec3_t end, int passEntityNum, int contentmask, int capsule ) {
+	SV_TraceHistory( results, start, mins, maxs, end, passEntityNum, contentmask, capsule, NULL, NULL, 0 );
+}
+
+
+/*
+==================
+SV_TraceAtTime
+
+Like SV_Trace, but clients are where they were at time
+==================
+*/
+void SV_TraceAtTime( trace_t *results, const vec3_t start, vec3_t mins, vec3_t maxs, const vec3_t end, int passEntityNum, int contentmask, int time ) {
+	const historyFrame_t	*older, *newer;
+	float		frac;
+	perfTime_t	perfStart;
+
+	perfStart = Perf_Begin();
+	if ( SV_HistoryAt( time, &older, &newer, &frac ) ) {
+		SV_TraceHistory( results, start, mins, maxs, end, passEntityNum, contentmask, qfalse, older, newer, frac );
+	} else {
+		SV_TraceHistory( results, start, mins, maxs, end, passEntityNum, contentmask, qfalse, NULL, NULL, 0 );
+	}
+	Perf_End( PERF_TRACE_AT_TIME, perfStart );
+}
+
+
 
 /*
 =============
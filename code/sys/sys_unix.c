@@ -37,6 +37,7 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include <libgen.h>
 #include <fcntl.h>
 #include <execinfo.h>
+#include <pthread.h>
 
 qboolean stdinIsATTY;
 
@@ -786,6 +787,209 @@ qboolean Sys_PIDIsRunning( int pid )
         return kill( pid, 0 ) == 0;
 }
 
+typedef struct {
+        pthread_t       thread;
+        threadFunc_t    function;
+        void            *arg;
+} sysThread_t;
+
+static void *Sys_ThreadMain( void *arg )
+{
+        sysThread_t *t = arg;
+
+        t->function( t->arg );
+        return NULL;
+}
+
+/*
+==============
+Sys_CreateThread
+==============
+*/
+void *Sys_CreateThread( threadFunc_t function, void *arg )
+{
+        sysThread_t *t;
+
+        t = malloc( sizeof( *t ) );
+        if( !t )
+                return NULL;
+
+        t->function = function;
+        t->arg = arg;
+        if( pthread_create( &t->thread, NULL, Sys_ThreadMain, t ) )
+        {
+                free( t );
+                return NULL;
+        }
+        return t;
+}
+
+/*
+==============
+Sys_JoinThread
+==============
+*/
+void Sys_JoinThread( void *thread )
+{
+        sysThread_t *t = thread;
+
+        pthread_join( t->thread, NULL );
+        free( t );
+}
+
+/*
+==============
+Sys_ThreadSleep
+==============
+*/
+void Sys_ThreadSleep( int msec )
+{
+        usleep( msec * 1000 );
+}
+
+typedef struct {
+        pthread_mutex_t mutex;
+        pthread_cond_t  cond;
+        int             count;
+} sysSemaphore_t;
+
+/*
+==============
+Sys_CreateSemaphore
+==============
+*/
+void *Sys_CreateSemaphore( int count )
+{
+        sysSemaphore_t *sem;
+
+        sem = malloc( sizeof( *sem ) );
+        if( !sem )
+                return NULL;
+
+        if( pthread_mutex_init( &sem->mutex, NULL ) )
+        {
+                free( sem );
+                return NULL;
+        }
+        if( pthread_cond_init( &sem->cond, NULL ) )
+        {
+                pthread_mutex_destroy( &sem->mutex );
+                free( sem );
+                return NULL;
+        }
+        sem->count = count;
+        return sem;
+}
+
+/*
+==============
+Sys_DestroySemaphore
+==============
+*/
+void Sys_DestroySemaphore( void *sem )
+{
+        sysSemaphore_t *s = sem;
+
+        pthread_cond_destroy( &s->cond );
+        pthread_mutex_destroy( &s->mutex );
+        free( s );
+}
+
+/*
+==============
+Sys_SemaphorePost
+==============
+*/
+void Sys_SemaphorePost( void *sem )
+{
+        sysSemaphore_t *s = sem;
+
+        pthread_mutex_lock( &s->mutex );
+        s->count++;
+        pthread_cond_signal( &s->cond );
+        pthread_mutex_unlock( &s->mutex );
+}
+
+/*
+==============
+Sys_SemaphoreWait
+==============
+*/
+qboolean Sys_SemaphoreWait( void *sem, int msec )
+{
+        sysSemaphore_t  *s = sem;
+        struct timeval  now;
+        struct timespec until;
+        qboolean        acquired;
+
+        if( msec >= 0 )
+        {
+                gettimeofday( &now, NULL );
+                until.tv_sec = now.tv_sec + msec / 1000;
+                until.tv_nsec = ( now.tv_usec + ( msec % 1000 ) * 1000 ) * 1000;
+                if( until.tv_nsec >= 1000000000 )
+                {
+                        until.tv_sec++;
+                        until.tv_nsec -= 1000000000;
+                }
+        }
+
+        pthread_mutex_lock( &s->mutex );
+        while( s->count <= 0 )
+        {
+                if( msec < 0 )
+                        pthread_cond_wait( &s->cond, &s->mutex );
+                else if( pthread_cond_timedwait( &s->cond, &s->mutex, &until ) == ETIMEDOUT )
+                        break;
+        }
+        acquired = s->count > 0;
+        if( acquired )
+                s->count--;
+        pthread_mutex_unlock( &s->mutex );
+
+        return acquired;
+}
+
+/*
+==============
+Sys_MapFile
+==============
+*/
+void *Sys_MapFile( const char *ospath, int *length )
+{
+        struct stat     st;
+        void            *data;
+        int             fd;
+
+        fd = open( ospath, O_RDONLY );
+        if( fd == -1 )
+                return NULL;
+
+        if( fstat( fd, &st ) == -1 || st.st_size <= 0 )
+        {
+                close( fd );
+                return NULL;
+        }
+
+        data = mmap( NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+        close( fd );
+        if( data == MAP_FAILED )
+                return NULL;
+
+        *length = st.st_size;
+        return data;
+}
+
+/*
+==============
+Sys_UnmapFile
+==============
+*/
+void Sys_UnmapFile( void *data, int length )
+{
+        munmap( data, length );
+}
+
 
 //@r00t: Crash dump backtrace
 
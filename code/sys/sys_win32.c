@@ -584,6 +584,156 @@ void Sys_Sleep( int msec )
 #endif
 }
 
+typedef struct {
+        HANDLE          thread;
+        threadFunc_t    function;
+        void            *arg;
+} sysThread_t;
+
+static DWORD WINAPI Sys_ThreadMain( LPVOID arg )
+{
+        sysThread_t *t = arg;
+
+        t->function( t->arg );
+        return 0;
+}
+
+/*
+==============
+Sys_CreateThread
+==============
+*/
+void *Sys_CreateThread( threadFunc_t function, void *arg )
+{
+        sysThread_t *t;
+
+        t = malloc( sizeof( *t ) );
+        if( !t )
+                return NULL;
+
+        t->function = function;
+        t->arg = arg;
+        t->thread = CreateThread( NULL, 0, Sys_ThreadMain, t, 0, NULL );
+        if( !t->thread )
+        {
+                free( t );
+                return NULL;
+        }
+        return t;
+}
+
+/*
+==============
+Sys_JoinThread
+==============
+*/
+void Sys_JoinThread( void *thread )
+{
+        sysThread_t *t = thread;
+
+        WaitForSingleObject( t->thread, INFINITE );
+        CloseHandle( t->thread );
+        free( t );
+}
+
+/*
+==============
+Sys_ThreadSleep
+==============
+*/
+void Sys_ThreadSleep( int msec )
+{
+        Sleep( msec );
+}
+
+/*
+==============
+Sys_CreateSemaphore
+==============
+*/
+void *Sys_CreateSemaphore( int count )
+{
+        return CreateSemaphore( NULL, count, 0x7fffffff, NULL );
+}
+
+/*
+==============
+Sys_DestroySemaphore
+==============
+*/
+void Sys_DestroySemaphore( void *sem )
+{
+        CloseHandle( sem );
+}
+
+/*
+==============
+Sys_SemaphorePost
+==============
+*/
+void Sys_SemaphorePost( void *sem )
+{
+        ReleaseSemaphore( sem, 1, NULL );
+}
+
+/*
+==============
+Sys_SemaphoreWait
+==============
+*/
+qboolean Sys_SemaphoreWait( void *sem, int msec )
+{
+        return WaitForSingleObject( sem, msec < 0 ? INFINITE : (DWORD)msec ) == WAIT_OBJECT_0;
+}
+
+/*
+==============
+Sys_MapFile
+==============
+*/
+void *Sys_MapFile( const char *ospath, int *length )
+{
+        HANDLE  file, mapping;
+        DWORD   size;
+        void    *data;
+
+        file = CreateFile( ospath, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL,
+                        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+        if( file == INVALID_HANDLE_VALUE )
+                return NULL;
+
+        size = GetFileSize( file, NULL );
+        if( size == INVALID_FILE_SIZE || !size )
+        {
+                CloseHandle( file );
+                return NULL;
+        }
+
+        mapping = CreateFileMapping( file, NULL, PAGE_READONLY, 0, 0, NULL );
+        CloseHandle( file );
+        if( !mapping )
+                return NULL;
+
+        // the view keeps the mapping alive
+        data = MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+        CloseHandle( mapping );
+        if( !data )
+                return NULL;
+
+        *length = size;
+        return data;
+}
+
+/*
+==============
+Sys_UnmapFile
+==============
+*/
+void Sys_UnmapFile( void *data, int length )
+{
+        UnmapViewOfFile( data );
+}
+
 /*
 ==============
 Sys_ErrorDialog
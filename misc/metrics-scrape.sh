@@ -0,0 +1,103 @@
+#!/bin/sh
+#
+# Local scrape test for the dedicated server metrics endpoint (sv_metrics).
+# Starts the given dedicated server with the endpoint on a local address,
+# scrapes it a number of times and checks every answer is complete and
+# well formed.  Needs curl.
+#
+# usage: misc/metrics-scrape.sh <ioq3ded> [server arguments]
+#
+#   misc/metrics-scrape.sh build/release-linux-x86_64/ioq3ded.x86_64 \
+#       +set fs_basepath /games/UrbanTerror +map ut4_abbey
+#
+# METRICS_ADDRESS  sv_metricsAddress to use, default 127.0.0.1:27961,
+#                  unix:/path scrapes over a UNIX domain socket
+# METRICS_SCRAPES  number of scrapes, default 20
+#
+
+SERVER="$1"
+if [ -z "$SERVER" ] || [ ! -x "$SERVER" ]; then
+	echo "usage: $0 <ioq3ded> [server arguments]" >&2
+	exit 2
+fi
+shift
+
+ADDRESS="${METRICS_ADDRESS:-127.0.0.1:27961}"
+SCRAPES="${METRICS_SCRAPES:-20}"
+TMP=`mktemp -d /tmp/metrics-scrape.XXXXXX` || exit 2
+
+case "$ADDRESS" in
+unix:*)
+	CURL="curl -s --max-time 5 --unix-socket ${ADDRESS#unix:}"
+	URL="http://localhost/metrics"
+	;;
+*)
+	CURL="curl -s --max-time 5"
+	URL="http://$ADDRESS/metrics"
+	;;
+esac
+
+"$SERVER" +set dedicated 1 +set sv_metrics 1 +set sv_metricsAddress "$ADDRESS" \
+	"$@" > "$TMP/server.log" 2>&1 &
+PID=$!
+trap 'kill $PID 2>/dev/null; wait $PID 2>/dev/null; rm -rf "$TMP"' EXIT INT TERM
+
+FAILED=0
+fail()
+{
+	echo "FAIL: $*"
+	FAILED=1
+}
+
+# wait for the map to load, metrics are only served while a map runs
+i=0
+until $CURL -o /dev/null "$URL"; do
+	i=`expr $i + 1`
+	if [ $i -ge 60 ] || ! kill -0 $PID 2>/dev/null; then
+		echo "FAIL: no metrics on $ADDRESS, server output:"
+		tail -20 "$TMP/server.log"
+		exit 1
+	fi
+	sleep 1
+done
+
+LAST=-1
+i=0
+while [ $i -lt "$SCRAPES" ]; do
+	i=`expr $i + 1`
+
+	TIME=`$CURL -D "$TMP/headers" -o "$TMP/body" -w '%{time_total}' "$URL"` || {
+		fail "scrape $i: curl failed"
+		continue
+	}
+
+	head -1 "$TMP/headers" | grep -q '^HTTP/1\.[01] 200' || fail "scrape $i: `head -1 "$TMP/headers"`"
+
+	LENGTH=`tr -d '\r' < "$TMP/headers" | sed -n 's/^[Cc]ontent-[Ll]ength: *//p'`
+	SIZE=`wc -c < "$TMP/body" | tr -d ' '`
+	[ "$LENGTH" = "$SIZE" ] || fail "scrape $i: Content-Length $LENGTH but $SIZE bytes of body"
+
+	for NAME in ioq3_players ioq3_max_clients ioq3_frames_total ioq3_frame_usec \
+			ioq3_packets_received_total ioq3_bytes_received_total ioq3_packets_sent_total \
+			ioq3_bytes_sent_total ioq3_netchan_dropped_total ioq3_downloads_active \
+			ioq3_rate_limited_total ioq3_metrics_scrapes_total; do
+		grep -q "^$NAME[{ ]" "$TMP/body" || fail "scrape $i: no $NAME"
+	done
+
+	BAD=`grep -v '^#' "$TMP/body" | grep -Ev '^[a-z_0-9]+(\{[^}]*\})? -?[0-9]+$' | head -1`
+	[ -z "$BAD" ] || fail "scrape $i: malformed line \"$BAD\""
+
+	COUNT=`sed -n 's/^ioq3_metrics_scrapes_total //p' "$TMP/body"`
+	[ "$LAST" -lt 0 ] || [ "$COUNT" -gt "$LAST" ] || fail "scrape $i: scrape counter went from $LAST to $COUNT"
+	LAST=$COUNT
+
+	echo "scrape $i: $SIZE bytes in ${TIME}s"
+done
+
+STATUS=`$CURL -o /dev/null -w '%{http_code}' -X POST "$URL"`
+[ "$STATUS" = "405" ] || fail "POST answered with $STATUS instead of 405"
+
+if [ $FAILED -ne 0 ]; then
+	exit 1
+fi
+echo "OK: $SCRAPES scrapes of $ADDRESS"